@@ -0,0 +1,37 @@
+// Copyright 2025 Finetoo
+// File Util Implementation
+
+#include "src/common/file_util.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "absl/strings/str_cat.h"
+
+namespace finetoo::common {
+
+absl::Status WriteFileAtomically(
+    absl::string_view path, absl::FunctionRef<bool(std::ostream&)> write) {
+  std::string temp_path = absl::StrCat(path, ".", getpid(), ".tmp");
+  std::error_code error;
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out || !write(out) || !out.flush()) {
+      std::filesystem::remove(temp_path, error);
+      return absl::InternalError(
+          absl::StrCat("Failed to write file: ", temp_path));
+    }
+  }
+  std::filesystem::rename(temp_path, std::string(path), error);
+  if (error) {
+    std::filesystem::remove(temp_path, error);
+    return absl::InternalError(absl::StrCat("Failed to write file: ", path));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace finetoo::common
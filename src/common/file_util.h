@@ -0,0 +1,20 @@
+// Copyright 2025 Finetoo
+// File Util - Replacing files whole
+
+#pragma once
+
+#include <ostream>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace finetoo::common {
+
+// Write a file through `write`, which returns false on failure. The file
+// is written aside and renamed into place, so a concurrent reader sees
+// the whole file or none of it; on failure nothing is left behind.
+absl::Status WriteFileAtomically(absl::string_view path,
+                                 absl::FunctionRef<bool(std::ostream&)> write);
+
+}  // namespace finetoo::common
@@ -0,0 +1,39 @@
+// Copyright 2025 Finetoo
+// Parallel Implementation
+
+#include "src/common/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace finetoo::common {
+
+int DefaultThreadCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(size_t n, int num_threads,
+                 const std::function<void(size_t)>& fn) {
+  if (num_threads <= 0) num_threads = DefaultThreadCount();
+  size_t workers = std::min<size_t>(num_threads, n);
+
+  if (workers <= 1) {
+    for (size_t i = 0; i < n; i++) fn(i);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  auto work = [&]() {
+    for (size_t i = next++; i < n; i = next++) fn(i);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t t = 1; t < workers; t++) threads.emplace_back(work);
+  work();
+  for (auto& thread : threads) thread.join();
+}
+
+}  // namespace finetoo::common
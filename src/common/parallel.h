@@ -0,0 +1,21 @@
+// Copyright 2025 Finetoo
+// Parallel - Minimal fork/join helpers for data-parallel passes
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace finetoo::common {
+
+// Number of hardware threads (at least 1)
+int DefaultThreadCount();
+
+// Call fn(i) for every i in [0, n) using up to `num_threads` threads, the
+// caller's included. Indices are handed out one at a time, so uneven tasks
+// balance across threads. Returns once every call has finished.
+// num_threads <= 0 means DefaultThreadCount().
+void ParallelFor(size_t n, int num_threads,
+                 const std::function<void(size_t)>& fn);
+
+}  // namespace finetoo::common
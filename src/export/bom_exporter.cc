@@ -9,6 +9,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "nlohmann/json.hpp"
+#include "src/graph/node_id.h"
 
 namespace finetoo::export_util {
 
@@ -27,9 +28,14 @@ static std::string SanitizeString(const std::string& input) {
   return output;
 }
 
-std::vector<BOMEntry> BOMExporter::ParseBOMFromResult(
+namespace {
+
+// BOM entries for `result`, reading nodes with for_each_node(type, f),
+// which calls f(drawing, node) for each node of `type`
+template <typename ForEachNode>
+std::vector<BOMEntry> ParseBOM(
     const finetoo::operations::v1::OperationResult& result,
-    const finetoo::graph::v1::PropertyGraph& graph) {
+    ForEachNode for_each_node) {
 
   std::vector<BOMEntry> bom;
 
@@ -40,41 +46,37 @@ std::vector<BOMEntry> BOMExporter::ParseBOMFromResult(
 
     // Find source drawings for this part
     // Look through Entity nodes to find INSERTs with this block name
-    if (graph.nodes_by_type().contains("Entity")) {
-      for (const auto& node : graph.nodes_by_type().at("Entity").nodes()) {
-        // Check if this is an INSERT for this block
-        auto type_it = node.string_props().find("type");
-        auto gc2_it = node.string_props().find("gc_2");
-
-        if (type_it != node.string_props().end() && type_it->second == "INSERT" &&
-            gc2_it != node.string_props().end() && gc2_it->second == part_name) {
-
-          // Get source drawing if available
-          auto source_it = node.string_props().find("source_drawing");
-          if (source_it != node.string_props().end()) {
-            std::string drawing = source_it->second;
-            if (std::find(entry.source_drawings.begin(), entry.source_drawings.end(), drawing)
-                == entry.source_drawings.end()) {
-              entry.source_drawings.push_back(drawing);
-            }
-          }
+    for_each_node("Entity", [&](const std::string& drawing,
+                                const finetoo::graph::v1::Node& node) {
+      // Check if this is an INSERT for this block
+      auto type_it = node.string_props().find("type");
+      auto gc2_it = node.string_props().find("gc_2");
+
+      if (type_it != node.string_props().end() && type_it->second == "INSERT" &&
+          gc2_it != node.string_props().end() && gc2_it->second == part_name) {
+
+        // Get source drawing if available
+        if (!drawing.empty() &&
+            std::find(entry.source_drawings.begin(), entry.source_drawings.end(), drawing)
+            == entry.source_drawings.end()) {
+          entry.source_drawings.push_back(drawing);
         }
       }
-    }
+    });
 
     // Extract any dimensional properties from the block definition
-    if (graph.nodes_by_type().contains("Block")) {
-      for (const auto& node : graph.nodes_by_type().at("Block").nodes()) {
-        auto name_it = node.string_props().find("name");
-        if (name_it != node.string_props().end() && name_it->second == part_name) {
-          // Add any numeric properties as dimensions
-          for (const auto& [key, value] : node.numeric_props()) {
-            entry.properties[key] = std::to_string(value);
-          }
-          break;
+    bool found = false;
+    for_each_node("Block", [&](const std::string& drawing,
+                               const finetoo::graph::v1::Node& node) {
+      auto name_it = node.string_props().find("name");
+      if (!found && name_it != node.string_props().end() && name_it->second == part_name) {
+        // Add any numeric properties as dimensions
+        for (const auto& [key, value] : node.numeric_props()) {
+          entry.properties[key] = std::to_string(value);
         }
+        found = true;
       }
-    }
+    });
 
     bom.push_back(entry);
   }
@@ -88,24 +90,22 @@ std::vector<BOMEntry> BOMExporter::ParseBOMFromResult(
   return bom;
 }
 
-std::vector<Dimension> BOMExporter::ExtractDimensions(
-    const finetoo::graph::v1::PropertyGraph& graph) {
+// Dimensions among the nodes for_each_node reads, as for ParseBOM()
+template <typename ForEachNode>
+std::vector<Dimension> FindDimensions(ForEachNode for_each_node) {
 
   std::vector<Dimension> dimensions;
 
-  if (!graph.nodes_by_type().contains("Entity")) {
-    return dimensions;
-  }
-
-  for (const auto& node : graph.nodes_by_type().at("Entity").nodes()) {
+  for_each_node("Entity", [&](const std::string& drawing,
+                              const finetoo::graph::v1::Node& node) {
     // Check if this is a DIMENSION entity
     auto type_it = node.string_props().find("type");
     if (type_it == node.string_props().end() || type_it->second != "DIMENSION") {
-      continue;
+      return;
     }
 
     Dimension dim;
-    dim.entity_handle = node.id();
+    dim.entity_handle = graph::NodeId(node);
 
     // Get dimension type (group code 70)
     auto gc70_it = node.string_props().find("gc_70");
@@ -140,17 +140,61 @@ std::vector<Dimension> BOMExporter::ExtractDimensions(
     }
 
     // Get source drawing
-    auto source_it = node.string_props().find("source_drawing");
-    if (source_it != node.string_props().end()) {
-      dim.source_drawing = source_it->second;
-    }
+    dim.source_drawing = drawing;
 
     dimensions.push_back(dim);
-  }
+  });
 
   return dimensions;
 }
 
+// Reads the nodes of one graph, with the drawing their source_drawing
+// property names, if any
+auto NodesOf(const finetoo::graph::v1::PropertyGraph& graph) {
+  return [&graph](const std::string& type, auto f) {
+    auto it = graph.nodes_by_type().find(type);
+    if (it == graph.nodes_by_type().end()) return;
+    const std::string property(graph::GraphSet::kDrawingProperty);
+    const std::string none;
+    for (const auto& node : it->second.nodes()) {
+      auto source_it = node.string_props().find(property);
+      f(source_it != node.string_props().end() ? source_it->second : none,
+        node);
+    }
+  };
+}
+
+// Reads the nodes of a set's members, with the member's drawing
+auto NodesOf(const graph::GraphSet& graphs) {
+  return [&graphs](const std::string& type, auto f) {
+    graphs.ForEachNode(type, f);
+  };
+}
+
+}  // namespace
+
+std::vector<BOMEntry> BOMExporter::ParseBOMFromResult(
+    const finetoo::operations::v1::OperationResult& result,
+    const finetoo::graph::v1::PropertyGraph& graph) {
+  return ParseBOM(result, NodesOf(graph));
+}
+
+std::vector<BOMEntry> BOMExporter::ParseBOMFromResult(
+    const finetoo::operations::v1::OperationResult& result,
+    const graph::GraphSet& graphs) {
+  return ParseBOM(result, NodesOf(graphs));
+}
+
+std::vector<Dimension> BOMExporter::ExtractDimensions(
+    const finetoo::graph::v1::PropertyGraph& graph) {
+  return FindDimensions(NodesOf(graph));
+}
+
+std::vector<Dimension> BOMExporter::ExtractDimensions(
+    const graph::GraphSet& graphs) {
+  return FindDimensions(NodesOf(graphs));
+}
+
 absl::Status BOMExporter::ExportToJSON(
     const std::string& filename,
     const std::vector<BOMEntry>& bom,
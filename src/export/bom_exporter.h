@@ -9,6 +9,7 @@
 #include "absl/status/statusor.h"
 #include "proto/graph.pb.h"
 #include "proto/operations.pb.h"
+#include "src/graph/graph_set.h"
 
 namespace finetoo::export_util {
 
@@ -59,6 +60,14 @@ class BOMExporter {
   // Extract all dimensions from property graph
   static std::vector<Dimension> ExtractDimensions(
       const finetoo::graph::v1::PropertyGraph& graph);
+
+  // As above, across several drawings' graphs; each part and dimension
+  // gets the drawings it was found in
+  static std::vector<BOMEntry> ParseBOMFromResult(
+      const finetoo::operations::v1::OperationResult& result,
+      const graph::GraphSet& graphs);
+  static std::vector<Dimension> ExtractDimensions(
+      const graph::GraphSet& graphs);
 };
 
 }  // namespace finetoo::export_util
@@ -0,0 +1,165 @@
+// Copyright 2025 Finetoo
+// Adjacency Index Implementation
+
+#include "src/graph/adjacency_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "src/parser/dxf_handle.h"
+
+namespace finetoo::graph {
+
+AdjacencyIndex AdjacencyIndex::Build(
+    const finetoo::graph::v1::PropertyGraph& graph) {
+  std::vector<const std::string*> types;
+  for (const auto& [type, collection] : graph.nodes_by_type()) {
+    types.push_back(&type);
+  }
+  std::sort(types.begin(), types.end(),
+            [](const std::string* a, const std::string* b) { return *a < *b; });
+
+  AdjacencyIndex index;
+  for (const std::string* type : types) {
+    for (const auto& node : graph.nodes_by_type().at(*type).nodes()) {
+      index.AddNode(node.id(), node.handle());
+    }
+  }
+  index.IndexEdges(graph.edges());
+  return index;
+}
+
+NodeIndex AdjacencyIndex::AddNode(absl::string_view id, uint64_t handle) {
+  NodeIndex next = static_cast<NodeIndex>(node_count_);
+  std::pair<NodeIndex, bool> added;
+  if (!id.empty()) {
+    auto [it, inserted] = nodes_by_id_.try_emplace(id, next);
+    added = {it->second, inserted};
+  } else if (handle != parser::kNoHandle) {
+    auto [it, inserted] = nodes_by_handle_.try_emplace(handle, next);
+    added = {it->second, inserted};
+  } else {
+    // Nothing can name it, but it still has a number
+    added = {next, true};
+  }
+  if (added.second) node_count_++;
+  return added.first;
+}
+
+NodeIndex AdjacencyIndex::Endpoint(const std::string& id, uint64_t handle) {
+  if (id.empty() && handle == parser::kNoHandle) return kNoNode;
+  return AddNode(id, handle);
+}
+
+void AdjacencyIndex::IndexEdges(
+    const google::protobuf::RepeatedPtrField<finetoo::graph::v1::Edge>&
+        edges) {
+  sources_.resize(edges.size());
+  targets_.resize(edges.size());
+  NodeIndex* sources = sources_.mutable_data();
+  NodeIndex* targets = targets_.mutable_data();
+  for (int i = 0; i < edges.size(); i++) {
+    const auto& edge = edges[i];
+    sources[i] = Endpoint(edge.source_node_id(), edge.source_handle());
+    targets[i] = Endpoint(edge.target_node_id(), edge.target_handle());
+    types_[edge.type()].edges.push_back(i);
+  }
+
+  for (auto& [name, type] : types_) {
+    Link(sources_, &type.out_offsets, &type.out_edges, type);
+    Link(targets_, &type.in_offsets, &type.in_edges, type);
+  }
+}
+
+void AdjacencyIndex::Link(const Array<NodeIndex>& ends,
+                          Array<uint32_t>* offsets, Array<uint32_t>* lists,
+                          const TypeIndex& type) const {
+  // Count edges per node, sum into offsets, then place edges in order
+  offsets->assign(node_count_ + 1, 0);
+  uint32_t* counts = offsets->mutable_data();
+  for (uint32_t edge : type.edges) {
+    if (ends[edge] != kNoNode) counts[ends[edge] + 1]++;
+  }
+  for (size_t node = 0; node < node_count_; node++) {
+    counts[node + 1] += counts[node];
+  }
+
+  lists->resize(offsets->back());
+  uint32_t* list = lists->mutable_data();
+  std::vector<uint32_t> next(offsets->begin(), offsets->end() - 1);
+  for (uint32_t edge : type.edges) {
+    if (ends[edge] != kNoNode) list[next[ends[edge]]++] = edge;
+  }
+}
+
+std::optional<NodeIndex> AdjacencyIndex::FindNode(absl::string_view id) const {
+  if (!id_keys_.empty()) {
+    auto key = [&](const IdKey& key) {
+      return key_heap_.substr(key.offset, key.size);
+    };
+    const IdKey* it = std::lower_bound(
+        id_keys_.begin(), id_keys_.end(), id,
+        [&](const IdKey& a, absl::string_view b) { return key(a) < b; });
+    if (it == id_keys_.end() || key(*it) != id) return std::nullopt;
+    return it->node;
+  }
+  auto it = nodes_by_id_.find(id);
+  if (it == nodes_by_id_.end()) return std::nullopt;
+  return it->second;
+}
+
+std::optional<NodeIndex> AdjacencyIndex::FindNode(uint64_t handle) const {
+  if (!handle_keys_.empty()) {
+    const HandleKey* it = std::lower_bound(
+        handle_keys_.begin(), handle_keys_.end(), handle,
+        [](const HandleKey& a, uint64_t b) { return a.handle < b; });
+    if (it == handle_keys_.end() || it->handle != handle) return std::nullopt;
+    return it->node;
+  }
+  auto it = nodes_by_handle_.find(handle);
+  if (it == nodes_by_handle_.end()) return std::nullopt;
+  return it->second;
+}
+
+absl::Span<const uint32_t> AdjacencyIndex::Edges(
+    absl::string_view type) const {
+  auto it = types_.find(type);
+  if (it == types_.end()) return {};
+  return it->second.edges;
+}
+
+absl::Span<const uint32_t> AdjacencyIndex::OutEdges(absl::string_view type,
+                                                    NodeIndex node) const {
+  auto it = types_.find(type);
+  if (it == types_.end() || node >= node_count_) return {};
+  const auto& offsets = it->second.out_offsets;
+  return absl::Span<const uint32_t>(it->second.out_edges)
+      .subspan(offsets[node], offsets[node + 1] - offsets[node]);
+}
+
+absl::Span<const uint32_t> AdjacencyIndex::InEdges(absl::string_view type,
+                                                   NodeIndex node) const {
+  auto it = types_.find(type);
+  if (it == types_.end() || node >= node_count_) return {};
+  const auto& offsets = it->second.in_offsets;
+  return absl::Span<const uint32_t>(it->second.in_edges)
+      .subspan(offsets[node], offsets[node + 1] - offsets[node]);
+}
+
+size_t AdjacencyIndex::SpaceUsed() const {
+  size_t bytes = sources_.SpaceUsed() + targets_.SpaceUsed() +
+                 id_keys_.SpaceUsed() + handle_keys_.SpaceUsed() +
+                 nodes_by_id_.capacity() *
+                     (sizeof(std::string) + sizeof(NodeIndex)) +
+                 nodes_by_handle_.capacity() *
+                     (sizeof(uint64_t) + sizeof(NodeIndex));
+  for (const auto& [id, node] : nodes_by_id_) bytes += id.capacity();
+  for (const auto& [name, type] : types_) {
+    bytes += type.edges.SpaceUsed() + type.out_offsets.SpaceUsed() +
+             type.out_edges.SpaceUsed() + type.in_offsets.SpaceUsed() +
+             type.in_edges.SpaceUsed();
+  }
+  return bytes;
+}
+
+}  // namespace finetoo::graph
@@ -0,0 +1,120 @@
+// Copyright 2025 Finetoo
+// Adjacency Index - Compressed sparse row edge lists by node
+//
+// Edges are a flat list in the PropertyGraph, naming their ends by string
+// ID or handle, so following the edges of a node means scanning them all.
+// AdjacencyIndex numbers the nodes densely and, per edge type, keeps each
+// node's outgoing and incoming edges in CSR form: an offsets array with
+// one slot per node, into an array of edge indices. A node's edges of one
+// type are then a span, found in O(1). The arrays can also be viewed in a
+// mapped GraphSnapshot.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/repeated_ptr_field.h"
+#include "proto/graph.pb.h"
+#include "src/graph/array.h"
+
+namespace finetoo::graph {
+
+// Dense node number
+using NodeIndex = uint32_t;
+
+// Edge lists of a graph by type and node. Edges are numbered by position in
+// the graph's edges, and listed in that order. The index is a snapshot:
+// edges added to the graph later are not in it.
+class AdjacencyIndex {
+ public:
+  static constexpr NodeIndex kNoNode = ~NodeIndex{0};
+
+  AdjacencyIndex() = default;
+
+  // Index of a graph's nodes, types in name order, and edges
+  static AdjacencyIndex Build(const finetoo::graph::v1::PropertyGraph& graph);
+
+  // Number the next node. Nodes are keyed as NodeId() names them: by ID,
+  // or by handle if they have none.
+  NodeIndex AddNode(absl::string_view id, uint64_t handle);
+
+  // Index `edges`, once, after the nodes. Ends naming no node added are
+  // numbered after them; ends with neither ID nor handle get kNoNode.
+  void IndexEdges(
+      const google::protobuf::RepeatedPtrField<finetoo::graph::v1::Edge>&
+          edges);
+
+  bool empty() const { return sources_.empty() && node_count_ == 0; }
+  size_t node_count() const { return node_count_; }
+  size_t edge_count() const { return sources_.size(); }
+
+  // Node keyed by `id`, or by `handle`
+  std::optional<NodeIndex> FindNode(absl::string_view id) const;
+  std::optional<NodeIndex> FindNode(uint64_t handle) const;
+
+  // Ends of an edge
+  NodeIndex source(uint32_t edge) const { return sources_[edge]; }
+  NodeIndex target(uint32_t edge) const { return targets_[edge]; }
+
+  // Edges of a type, all of them or from / to a node
+  absl::Span<const uint32_t> Edges(absl::string_view type) const;
+  absl::Span<const uint32_t> OutEdges(absl::string_view type,
+                                      NodeIndex node) const;
+  absl::Span<const uint32_t> InEdges(absl::string_view type,
+                                     NodeIndex node) const;
+
+  // Bytes held
+  size_t SpaceUsed() const;
+
+ private:
+  friend class GraphSnapshot;
+
+  struct TypeIndex {
+    Array<uint32_t> edges;
+    Array<uint32_t> out_offsets;  // Node count + 1
+    Array<uint32_t> out_edges;
+    Array<uint32_t> in_offsets;
+    Array<uint32_t> in_edges;
+  };
+
+  // Node keys in key order, searched instead of the maps when those are
+  // empty, as in a snapshot. An ID key is `size` bytes at `offset` in
+  // key_heap_.
+  struct IdKey {
+    uint64_t offset;
+    uint32_t size;
+    NodeIndex node;
+  };
+  struct HandleKey {
+    uint64_t handle;
+    NodeIndex node;
+    uint32_t reserved;
+  };
+
+  // Index of an edge end, numbered if new
+  NodeIndex Endpoint(const std::string& id, uint64_t handle);
+
+  // Fill offsets and lists from the ends of `type.edges`
+  void Link(const Array<NodeIndex>& ends, Array<uint32_t>* offsets,
+            Array<uint32_t>* lists, const TypeIndex& type) const;
+
+  size_t node_count_ = 0;
+  absl::flat_hash_map<std::string, NodeIndex> nodes_by_id_;
+  absl::flat_hash_map<uint64_t, NodeIndex> nodes_by_handle_;
+  Array<IdKey> id_keys_;
+  Array<HandleKey> handle_keys_;
+  absl::string_view key_heap_;
+
+  Array<NodeIndex> sources_;
+  Array<NodeIndex> targets_;
+  absl::flat_hash_map<std::string, TypeIndex> types_;
+};
+
+}  // namespace finetoo::graph
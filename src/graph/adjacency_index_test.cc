@@ -0,0 +1,56 @@
+// Copyright 2025 Finetoo
+// AdjacencyIndex Tests
+
+#include "src/graph/adjacency_index.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace finetoo::graph {
+namespace {
+
+void AddEdge(finetoo::graph::v1::PropertyGraph* graph, const char* type,
+             uint64_t source_handle, const char* target_id) {
+  auto* edge = graph->add_edges();
+  edge->set_type(type);
+  edge->set_source_handle(source_handle);
+  edge->set_target_node_id(target_id);
+}
+
+TEST(AdjacencyIndexTest, ListsEdgesByNodeInGraphOrder) {
+  finetoo::graph::v1::PropertyGraph graph;
+  auto& layers = (*graph.mutable_nodes_by_type())["Layer"];
+  layers.add_nodes()->set_id("layer_0");
+  auto& entities = (*graph.mutable_nodes_by_type())["Entity"];
+  entities.add_nodes()->set_handle(0x1A);
+  entities.add_nodes()->set_handle(0x1B);
+  AddEdge(&graph, "BELONGS_TO", 0x1A, "layer_0");
+  AddEdge(&graph, "REFERENCES", 0x1A, "block_X");
+  AddEdge(&graph, "BELONGS_TO", 0x1B, "layer_0");
+  graph.add_edges()->set_type("BELONGS_TO");  // No ends
+
+  auto index = AdjacencyIndex::Build(graph);
+
+  // Types in name order, then the ends no node has
+  EXPECT_EQ(index.FindNode(0x1A), 0);
+  EXPECT_EQ(index.FindNode(0x1B), 1);
+  EXPECT_EQ(index.FindNode("layer_0"), 2);
+  EXPECT_EQ(index.FindNode("block_X"), 3);
+  EXPECT_EQ(index.FindNode(""), std::nullopt);
+  EXPECT_EQ(index.node_count(), 4);
+
+  auto on_layer = index.InEdges("BELONGS_TO", 2);
+  EXPECT_EQ(std::vector<uint32_t>(on_layer.begin(), on_layer.end()),
+            std::vector<uint32_t>({0, 2}));
+  auto belongs = index.OutEdges("BELONGS_TO", 0);
+  EXPECT_EQ(std::vector<uint32_t>(belongs.begin(), belongs.end()),
+            std::vector<uint32_t>({0}));
+  EXPECT_EQ(index.OutEdges("REFERENCES", 1).size(), 0);
+  EXPECT_EQ(index.OutEdges("CONTAINS", 0).size(), 0);
+  EXPECT_EQ(index.Edges("BELONGS_TO").size(), 3);
+  EXPECT_EQ(index.source(3), AdjacencyIndex::kNoNode);
+}
+
+}  // namespace
+}  // namespace finetoo::graph
@@ -0,0 +1,136 @@
+// Copyright 2025 Finetoo
+// Array - Values owned, or viewed in place
+//
+// Columns and edge indexes are flat arrays of plain values. An Array holds
+// them in a buffer of its own, as a vector would, or views them in memory
+// that outlives it, such as a mapped graph snapshot, so a graph can be
+// used without copying its arrays in. Writing to a view copies it first.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "absl/types/span.h"
+
+namespace finetoo::graph {
+
+template <typename T>
+class Array {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  using value_type = T;
+  using iterator = const T*;
+  using const_iterator = const T*;
+
+  Array() = default;
+
+  // Copies own their values, unless copied from a view
+  Array(const Array& other) { *this = other; }
+  Array& operator=(const Array& other) {
+    if (this == &other) return *this;
+    if (other.is_view()) {
+      *this = View(other.data_, other.size_);
+    } else {
+      size_ = 0;
+      Reserve(other.size_, /*keep=*/false);
+      std::copy(other.begin(), other.end(), data_);
+      size_ = other.size_;
+    }
+    return *this;
+  }
+  Array(Array&& other) noexcept { *this = std::move(other); }
+  Array& operator=(Array&& other) noexcept {
+    owned_ = std::move(other.owned_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    return *this;
+  }
+
+  // View of `size` values at `data`, which must outlive the array
+  static Array View(const T* data, size_t size) {
+    Array array;
+    array.data_ = const_cast<T*>(data);
+    array.size_ = size;
+    return array;
+  }
+
+  bool is_view() const { return owned_ == nullptr && data_ != nullptr; }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const T* data() const { return data_; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+  const T& operator[](size_t i) const { return data_[i]; }
+  const T& back() const { return data_[size_ - 1]; }
+  operator absl::Span<const T>() const {
+    return absl::Span<const T>(data_, size_);
+  }
+
+  // Values to write in place
+  T* mutable_data() {
+    if (is_view()) Reserve(size_, /*keep=*/true);
+    return data_;
+  }
+
+  void reserve(size_t capacity) {
+    if (capacity > capacity_ || is_view()) {
+      Reserve(std::max(capacity, size_), /*keep=*/true);
+    }
+  }
+
+  // New values are zero
+  void resize(size_t size) {
+    if (size > capacity_ || is_view()) Grow(size);
+    if (size > size_) std::fill(data_ + size_, data_ + size, T());
+    size_ = size;
+  }
+
+  void assign(size_t size, T value) {
+    size_ = 0;
+    if (size > capacity_ || is_view()) Reserve(size, /*keep=*/false);
+    std::fill(data_, data_ + size, value);
+    size_ = size;
+  }
+
+  void push_back(T value) {
+    if (size_ == capacity_ || is_view()) Grow(size_ + 1);
+    data_[size_++] = value;
+  }
+
+  friend bool operator==(const Array& a, const Array& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+  // Bytes held, views aside
+  size_t SpaceUsed() const { return capacity_ * sizeof(T); }
+
+ private:
+  // Room for `size` values, doubling as a vector does
+  void Grow(size_t size) {
+    Reserve(std::max(size, is_view() ? size : capacity_ * 2), /*keep=*/true);
+  }
+
+  // Own a buffer of `capacity` values, keeping the current ones if asked
+  void Reserve(size_t capacity, bool keep) {
+    auto owned = std::make_unique_for_overwrite<T[]>(capacity);
+    if (keep && size_ > 0) std::memcpy(owned.get(), data_, size_ * sizeof(T));
+    owned_ = std::move(owned);
+    data_ = owned_.get();
+    capacity_ = capacity;
+  }
+
+  std::unique_ptr<T[]> owned_;  // Null for a view
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+}  // namespace finetoo::graph
@@ -0,0 +1,340 @@
+// Copyright 2025 Finetoo
+// Columnar Graph Implementation
+
+#include "src/graph/columnar_graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/arena.h"
+#include "src/common/parallel.h"
+#include "src/graph/node_id.h"
+
+namespace finetoo::graph {
+
+namespace {
+
+// Rows per thread when exporting a table in parallel
+constexpr size_t kMinExportRowsPerThread = 4096;
+
+}  // namespace
+
+size_t NodeTable::AddRow(absl::string_view id, uint64_t handle) {
+  size_t row = handles_.size();
+  handles_.push_back(handle);
+  if (!id.empty()) ids_.Set(row, id);
+  return row;
+}
+
+std::string NodeTable::NodeId(size_t row) const {
+  return graph::NodeId(id(row), handle(row));
+}
+
+void NodeTable::SetString(absl::string_view name, size_t row,
+                          absl::string_view value) {
+  strings_.try_emplace(name, symbols_).first->second.Set(row, value);
+}
+
+void NodeTable::SetDouble(absl::string_view name, size_t row, double value) {
+  doubles_[name].Set(row, value);
+}
+
+void NodeTable::SetInt(absl::string_view name, size_t row, int64_t value) {
+  ints_[name].Set(row, value);
+}
+
+void NodeTable::SetBool(absl::string_view name, size_t row, bool value) {
+  bools_[name].Set(row, value);
+}
+
+namespace {
+
+template <typename Map>
+const typename Map::mapped_type* FindColumn(const Map& columns,
+                                            absl::string_view name) {
+  auto it = columns.find(name);
+  return it == columns.end() ? nullptr : &it->second;
+}
+
+}  // namespace
+
+const StringColumn* NodeTable::strings(absl::string_view name) const {
+  return FindColumn(strings_, name);
+}
+
+const Column<double>* NodeTable::doubles(absl::string_view name) const {
+  return FindColumn(doubles_, name);
+}
+
+const Column<int64_t>* NodeTable::ints(absl::string_view name) const {
+  return FindColumn(ints_, name);
+}
+
+const Column<bool>* NodeTable::bools(absl::string_view name) const {
+  return FindColumn(bools_, name);
+}
+
+void NodeTable::Export(
+    size_t begin, size_t end,
+    google::protobuf::RepeatedPtrField<finetoo::graph::v1::Node>* nodes)
+    const {
+  size_t first = nodes->size();
+  nodes->Reserve(first + end - begin);
+  for (size_t row = begin; row < end; row++) {
+    auto* node = nodes->Add();
+    if (ids_.Has(row)) node->set_id(std::string(ids_.Get(row)));
+    node->set_type(type_);
+    node->set_handle(handles_[row]);
+  }
+
+  // Column by column, so each is read front to back
+  auto node = [&](size_t row) { return nodes->Mutable(first + row - begin); };
+  for (const auto& [name, column] : strings_) {
+    column.ForEach(begin, end, [&](size_t row) {
+      (*node(row)->mutable_string_props())[name] =
+          std::string(column.Get(row));
+    });
+  }
+  for (const auto& [name, column] : doubles_) {
+    column.ForEach(begin, end, [&](size_t row) {
+      (*node(row)->mutable_numeric_props())[name] = column.values[row];
+    });
+  }
+  for (const auto& [name, column] : ints_) {
+    column.ForEach(begin, end, [&](size_t row) {
+      (*node(row)->mutable_int_props())[name] = column.values[row];
+    });
+  }
+  for (const auto& [name, column] : bools_) {
+    column.ForEach(begin, end, [&](size_t row) {
+      (*node(row)->mutable_bool_props())[name] = column.values[row];
+    });
+  }
+}
+
+void NodeTable::Append(const finetoo::graph::v1::Node& node) {
+  size_t row = AddRow(node.id(), node.handle());
+  for (const auto& [name, value] : node.string_props()) {
+    SetString(name, row, value);
+  }
+  for (const auto& [name, value] : node.numeric_props()) {
+    SetDouble(name, row, value);
+  }
+  for (const auto& [name, value] : node.int_props()) {
+    SetInt(name, row, value);
+  }
+  for (const auto& [name, value] : node.bool_props()) {
+    SetBool(name, row, value);
+  }
+}
+
+void NodeTable::AppendTables(absl::Span<const NodeTable* const> tables,
+                             int num_threads) {
+  // Where each table's rows go, and its Symbols' in this table's SymbolTable
+  std::vector<size_t> offsets;
+  std::vector<std::vector<Symbol>> remaps;
+  for (const NodeTable* table : tables) {
+    offsets.push_back(handles_.size());
+    handles_.resize(handles_.size() + table->size());
+    std::copy(table->handles_.begin(), table->handles_.end(),
+              handles_.mutable_data() + offsets.back());
+    auto& remap = remaps.emplace_back();
+    if (table->symbols_ != symbols_) {
+      remap.resize(table->symbols_->size());
+      for (Symbol symbol = 0; symbol < remap.size(); symbol++) {
+        remap[symbol] = symbols_->Intern(table->symbols_->Get(symbol));
+      }
+    }
+  }
+  auto same = [](auto value) { return value; };
+  auto remapped = [&](size_t t) {
+    return [&remap = remaps[t]](Symbol symbol) {
+      return remap.empty() ? symbol : remap[symbol];
+    };
+  };
+
+  // Create every column first, so none moves while others are merged
+  for (const NodeTable* table : tables) {
+    for (const auto& [name, column] : table->strings_) {
+      strings_.try_emplace(name, symbols_);
+    }
+    for (const auto& [name, column] : table->doubles_) doubles_[name];
+    for (const auto& [name, column] : table->ints_) ints_[name];
+    for (const auto& [name, column] : table->bools_) bools_[name];
+  }
+
+  // Then merge them a column per thread
+  std::vector<std::function<void()>> merges;
+  merges.push_back([&] {
+    for (size_t t = 0; t < tables.size(); t++) {
+      ids_.Append(tables[t]->ids_, offsets[t], remapped(t));
+    }
+  });
+  for (auto& [name, column] : strings_) {
+    merges.push_back([&, &name = name, &column = column] {
+      for (size_t t = 0; t < tables.size(); t++) {
+        const auto* from = tables[t]->strings(name);
+        if (from != nullptr) column.Append(*from, offsets[t], remapped(t));
+      }
+    });
+  }
+  auto merge_all = [&](auto& columns, auto find) {
+    for (auto& [name, column] : columns) {
+      merges.push_back([&, find, &name = name, &column = column] {
+        for (size_t t = 0; t < tables.size(); t++) {
+          const auto* from = find(tables[t], name);
+          if (from != nullptr) column.Append(*from, offsets[t], same);
+        }
+      });
+    }
+  };
+  merge_all(doubles_, [](const NodeTable* table, absl::string_view name) {
+    return table->doubles(name);
+  });
+  merge_all(ints_, [](const NodeTable* table, absl::string_view name) {
+    return table->ints(name);
+  });
+  merge_all(bools_, [](const NodeTable* table, absl::string_view name) {
+    return table->bools(name);
+  });
+  common::ParallelFor(merges.size(), num_threads,
+                      [&](size_t i) { merges[i](); });
+}
+
+std::string EdgeTable::SourceNodeId(size_t edge) const {
+  return graph::NodeId(source_id(edge), source_handle(edge));
+}
+
+std::string EdgeTable::TargetNodeId(size_t edge) const {
+  return graph::NodeId(target_id(edge), target_handle(edge));
+}
+
+void EdgeTable::Append(const finetoo::graph::v1::Edge& edge) {
+  size_t row = size();
+  types_.Set(row, edge.type());
+  if (!edge.id().empty()) ids_.Set(row, edge.id());
+  if (!edge.source_node_id().empty()) {
+    source_ids_.Set(row, edge.source_node_id());
+  }
+  if (!edge.target_node_id().empty()) {
+    target_ids_.Set(row, edge.target_node_id());
+  }
+  source_handles_.push_back(edge.source_handle());
+  target_handles_.push_back(edge.target_handle());
+  if (edge.weight() != 0) weights_.Set(row, edge.weight());
+  for (const auto& [name, value] : edge.properties()) {
+    properties_.try_emplace(name, types_.symbols).first->second.Set(row, value);
+  }
+}
+
+void EdgeTable::Export(
+    google::protobuf::RepeatedPtrField<finetoo::graph::v1::Edge>* edges)
+    const {
+  edges->Reserve(edges->size() + size());
+  for (size_t row = 0; row < size(); row++) {
+    auto* edge = edges->Add();
+    edge->set_id(std::string(id(row)));
+    edge->set_type(std::string(type(row)));
+    edge->set_source_node_id(std::string(source_id(row)));
+    edge->set_target_node_id(std::string(target_id(row)));
+    edge->set_source_handle(source_handle(row));
+    edge->set_target_handle(target_handle(row));
+    edge->set_weight(weight(row));
+    ForEachProperty(row, [&](absl::string_view name, absl::string_view value) {
+      (*edge->mutable_properties())[std::string(name)] = std::string(value);
+    });
+  }
+}
+
+ColumnarGraph ColumnarGraph::FromProto(
+    const finetoo::graph::v1::PropertyGraph& graph,
+    std::shared_ptr<SymbolTable> symbols) {
+  ColumnarGraph columnar(std::move(symbols));
+
+  // Every field but nodes_by_type
+  auto* copy = columnar.mutable_graph();
+  if (graph.has_schema()) *copy->mutable_schema() = graph.schema();
+  *copy->mutable_edges() = graph.edges();
+  *copy->mutable_metadata() = graph.metadata();
+  if (graph.has_stats()) *copy->mutable_stats() = graph.stats();
+  copy->set_source_file_path(graph.source_file_path());
+  copy->set_source_file_hash(graph.source_file_hash());
+  copy->set_parse_timestamp_ms(graph.parse_timestamp_ms());
+
+  for (const auto& [type, collection] : graph.nodes_by_type()) {
+    NodeTable* table = columnar.mutable_table(type);
+    for (const auto& node : collection.nodes()) table->Append(node);
+  }
+  columnar.IndexEdges();
+  return columnar;
+}
+
+void ColumnarGraph::IndexEdges() {
+  adjacency_ = AdjacencyIndex();
+  for (const auto& table : tables_) {
+    for (size_t row = 0; row < table->size(); row++) {
+      adjacency_.AddNode(table->id(row), table->handle(row));
+    }
+  }
+  adjacency_.IndexEdges(graph_->edges());
+  for (const auto& edge : graph_->edges()) edges_.Append(edge);
+  graph_->clear_edges();
+}
+
+const NodeTable* ColumnarGraph::table(absl::string_view type) const {
+  auto it = tables_by_type_.find(type);
+  return it == tables_by_type_.end() ? nullptr : it->second;
+}
+
+NodeTable* ColumnarGraph::mutable_table(absl::string_view type) {
+  auto it = tables_by_type_.find(type);
+  if (it != tables_by_type_.end()) return it->second;
+
+  NodeTable* table =
+      tables_.emplace_back(std::make_unique<NodeTable>(type, symbols_.get()))
+          .get();
+  tables_by_type_.emplace(type, table);
+  return table;
+}
+
+GraphHandle ColumnarGraph::Export(int num_threads) && {
+  if (num_threads <= 0) num_threads = common::DefaultThreadCount();
+  GraphHandle graph = std::move(graph_);
+  google::protobuf::Arena* arena = graph->GetArena();
+  edges_.Export(graph->mutable_edges());
+  for (const auto& table : tables_) {
+    auto& collection = (*graph->mutable_nodes_by_type())[table->type()];
+    auto* nodes = collection.mutable_nodes();
+    size_t ranges = std::clamp<size_t>(table->size() / kMinExportRowsPerThread,
+                                       1, num_threads);
+    if (ranges == 1) {
+      table->Export(0, table->size(), nodes);
+    } else {
+      // Each range into a collection of its own on the arena, whose nodes
+      // are then moved over in order
+      std::vector<finetoo::graph::v1::NodeCollection*> parts(ranges);
+      common::ParallelFor(ranges, num_threads, [&](size_t i) {
+        parts[i] = google::protobuf::Arena::Create<
+            finetoo::graph::v1::NodeCollection>(arena);
+        table->Export(table->size() * i / ranges,
+                      table->size() * (i + 1) / ranges,
+                      parts[i]->mutable_nodes());
+      });
+      nodes->Reserve(table->size());
+      std::vector<finetoo::graph::v1::Node*> moved;
+      for (auto* part : parts) {
+        moved.resize(part->nodes_size());
+        part->mutable_nodes()->UnsafeArenaExtractSubrange(0, moved.size(),
+                                                          moved.data());
+        for (auto* node : moved) nodes->UnsafeArenaAddAllocated(node);
+        if (arena == nullptr) delete part;
+      }
+    }
+    collection.set_count(collection.nodes_size());
+  }
+  return graph;
+}
+
+}  // namespace finetoo::graph
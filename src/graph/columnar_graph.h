@@ -0,0 +1,293 @@
+// Copyright 2025 Finetoo
+// Columnar Graph - Column-wise node storage for property graphs
+//
+// A Node message keeps its properties in four string-keyed maps, so every
+// property of every node is a map entry with a key string of its own. Here
+// the nodes of one type form a NodeTable with one typed column per
+// property: contiguous values, a bitmap of the rows that have one and, for
+// strings, Symbols of a SymbolTable the graph's columns share. Scans
+// (filters, aggregates) walk arrays instead of maps. Indexed edges are an
+// EdgeTable of the same kind. Schema and metadata stay in a PropertyGraph
+// without nodes; Export() fills those in when the proto form is needed.
+// Columns are Arrays, so a graph can also view them in a mapped
+// GraphSnapshot.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/repeated_ptr_field.h"
+#include "proto/graph.pb.h"
+#include "src/graph/adjacency_index.h"
+#include "src/graph/array.h"
+#include "src/graph/graph_handle.h"
+#include "src/graph/symbol_table.h"
+
+namespace finetoo::graph {
+
+// Values of type T, one slot per row. A row past the end of `values`, or
+// with its bit clear in `present`, has no value.
+template <typename T>
+struct Column {
+  Array<T> values;
+  Array<uint64_t> present;  // Bit per row
+
+  size_t size() const { return values.size(); }
+
+  bool Has(size_t row) const {
+    return row < values.size() && (present[row / 64] >> (row % 64) & 1);
+  }
+
+  void Set(size_t row, T value) {
+    if (row >= values.size()) {
+      values.resize(row + 1);
+      present.resize(row / 64 + 1);
+    }
+    values.mutable_data()[row] = value;
+    present.mutable_data()[row / 64] |= uint64_t{1} << (row % 64);
+  }
+
+  // Call f(row) for each row in [begin, end) with a value, in order
+  template <typename F>
+  void ForEach(size_t begin, size_t end, F f) const {
+    if (end > values.size()) end = values.size();
+    for (size_t word = begin / 64; word * 64 < end; word++) {
+      uint64_t bits = present[word];
+      if (word == begin / 64) bits &= ~uint64_t{0} << (begin % 64);
+      for (; bits != 0; bits &= bits - 1) {
+        size_t row = word * 64 + absl::countr_zero(bits);
+        if (row >= end) break;
+        f(row);
+      }
+    }
+  }
+  template <typename F>
+  void ForEach(F f) const {
+    ForEach(0, values.size(), f);
+  }
+
+  // Set `other`'s rows from `offset` on, values passed through `map`
+  template <typename F>
+  void Append(const Column& other, size_t offset, F map) {
+    values.reserve(offset + other.size());
+    other.ForEach(
+        [&](size_t row) { Set(offset + row, map(other.values[row])); });
+  }
+};
+
+// Interned strings: rows hold Symbols of `symbols`
+struct StringColumn : Column<Symbol> {
+  explicit StringColumn(SymbolTable* symbols) : symbols(symbols) {}
+
+  SymbolTable* symbols;
+
+  void Set(size_t row, absl::string_view value) {
+    Column::Set(row, symbols->Intern(value));
+  }
+  absl::string_view Get(size_t row) const { return symbols->Get(values[row]); }
+
+  // Symbol of `value`, if interned. Rows need not have it.
+  std::optional<Symbol> Find(absl::string_view value) const {
+    return symbols->Find(value);
+  }
+};
+
+// The nodes of one type, interning their strings in `symbols`
+class NodeTable {
+ public:
+  NodeTable(absl::string_view type, SymbolTable* symbols)
+      : type_(type), symbols_(symbols), ids_(symbols) {}
+
+  const std::string& type() const { return type_; }
+  SymbolTable* symbols() const { return symbols_; }
+  size_t size() const { return handles_.size(); }
+
+  // Add a node (empty `id` for none), returning its row
+  size_t AddRow(absl::string_view id, uint64_t handle);
+
+  absl::string_view id(size_t row) const {
+    return ids_.Has(row) ? ids_.Get(row) : absl::string_view();
+  }
+  uint64_t handle(size_t row) const { return handles_[row]; }
+  void set_handle(size_t row, uint64_t handle) {
+    handles_.mutable_data()[row] = handle;
+  }
+
+  // The row's printable ID, as NodeId() gives for its Node
+  std::string NodeId(size_t row) const;
+
+  // Set a property of a row, creating its column
+  void SetString(absl::string_view name, size_t row, absl::string_view value);
+  void SetDouble(absl::string_view name, size_t row, double value);
+  void SetInt(absl::string_view name, size_t row, int64_t value);
+  void SetBool(absl::string_view name, size_t row, bool value);
+
+  // Column of a property, or null. As with Node's maps, each value type
+  // has its own namespace: "gc_10" can have both a string and a double
+  // column, with each row in at most one of them.
+  const StringColumn* strings(absl::string_view name) const;
+  const Column<double>* doubles(absl::string_view name) const;
+  const Column<int64_t>* ints(absl::string_view name) const;
+  const Column<bool>* bools(absl::string_view name) const;
+
+  // Append rows [begin, end) to `nodes`
+  void Export(size_t begin, size_t end,
+              google::protobuf::RepeatedPtrField<finetoo::graph::v1::Node>*
+                  nodes) const;
+
+  // Add a row from a Node message (raw_data and timestamps are dropped)
+  void Append(const finetoo::graph::v1::Node& node);
+
+  // Append the rows of `tables`, in order, merging columns on up to
+  // `num_threads` threads. Strings of tables with a SymbolTable of their
+  // own are re-interned table by table, so symbols are numbered as if the
+  // rows had been added here one by one.
+  void AppendTables(absl::Span<const NodeTable* const> tables,
+                    int num_threads);
+
+ private:
+  friend class GraphSnapshot;
+
+  std::string type_;
+  SymbolTable* symbols_;
+  Array<uint64_t> handles_;
+  StringColumn ids_;
+
+  // Columns by property name
+  absl::flat_hash_map<std::string, StringColumn> strings_;
+  absl::flat_hash_map<std::string, Column<double>> doubles_;
+  absl::flat_hash_map<std::string, Column<int64_t>> ints_;
+  absl::flat_hash_map<std::string, Column<bool>> bools_;
+};
+
+// Edges in graph order, interning their strings in `symbols`: type, ID and
+// ends in columns of their own, properties in a column per name
+class EdgeTable {
+ public:
+  explicit EdgeTable(SymbolTable* symbols)
+      : types_(symbols),
+        ids_(symbols),
+        source_ids_(symbols),
+        target_ids_(symbols) {}
+
+  size_t size() const { return types_.size(); }
+
+  absl::string_view type(size_t edge) const { return types_.Get(edge); }
+  absl::string_view id(size_t edge) const {
+    return ids_.Has(edge) ? ids_.Get(edge) : absl::string_view();
+  }
+  absl::string_view source_id(size_t edge) const {
+    return source_ids_.Has(edge) ? source_ids_.Get(edge) : absl::string_view();
+  }
+  absl::string_view target_id(size_t edge) const {
+    return target_ids_.Has(edge) ? target_ids_.Get(edge) : absl::string_view();
+  }
+  uint64_t source_handle(size_t edge) const { return source_handles_[edge]; }
+  uint64_t target_handle(size_t edge) const { return target_handles_[edge]; }
+  double weight(size_t edge) const {
+    return weights_.Has(edge) ? weights_.values[edge] : 0.0;
+  }
+
+  // Printable IDs of the ends, as SourceNodeId() and TargetNodeId() give
+  std::string SourceNodeId(size_t edge) const;
+  std::string TargetNodeId(size_t edge) const;
+
+  // Call f(name, value) for each property of an edge
+  template <typename F>
+  void ForEachProperty(size_t edge, F f) const {
+    for (const auto& [name, column] : properties_) {
+      if (column.Has(edge)) f(name, column.Get(edge));
+    }
+  }
+
+  // Add an edge from an Edge message
+  void Append(const finetoo::graph::v1::Edge& edge);
+
+  // Append every edge to `edges`
+  void Export(google::protobuf::RepeatedPtrField<finetoo::graph::v1::Edge>*
+                  edges) const;
+
+ private:
+  friend class GraphSnapshot;
+
+  StringColumn types_;
+  StringColumn ids_;
+  StringColumn source_ids_;
+  StringColumn target_ids_;
+  Array<uint64_t> source_handles_;
+  Array<uint64_t> target_handles_;
+  Column<double> weights_;  // Rows with a weight set
+  absl::flat_hash_map<std::string, StringColumn> properties_;
+};
+
+// Property graph with nodes in NodeTables. Graphs of a batch can share a
+// SymbolTable, which outlives them all. Movable, not copyable.
+class ColumnarGraph {
+ public:
+  explicit ColumnarGraph(
+      std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>())
+      : symbols_(std::move(symbols)), edges_(symbols_.get()) {}
+  ColumnarGraph(ColumnarGraph&&) = default;
+  ColumnarGraph& operator=(ColumnarGraph&&) = default;
+
+  // Convert a graph's nodes to tables; the rest is copied
+  static ColumnarGraph FromProto(
+      const finetoo::graph::v1::PropertyGraph& graph,
+      std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>());
+
+  // Strings of every table
+  const std::shared_ptr<SymbolTable>& symbols() const { return symbols_; }
+
+  // Schema, metadata and stats, and edges until IndexEdges(). Its
+  // nodes_by_type is empty.
+  const finetoo::graph::v1::PropertyGraph& graph() const { return *graph_; }
+  finetoo::graph::v1::PropertyGraph* mutable_graph() { return graph_.get(); }
+
+  // Tables in order of creation
+  const std::vector<std::unique_ptr<NodeTable>>& tables() const {
+    return tables_;
+  }
+
+  // Table of a node type: null if there is none, or created
+  const NodeTable* table(absl::string_view type) const;
+  NodeTable* mutable_table(absl::string_view type);
+
+  // Edges moved out of graph() by IndexEdges(), and their index by node;
+  // empty before it
+  const EdgeTable& edges() const { return edges_; }
+  const AdjacencyIndex& adjacency() const { return adjacency_; }
+
+  // Move graph()'s edges into edges() and index them over the tables'
+  // rows, in table order. Once, when the graph is complete.
+  void IndexEdges();
+
+  // The graph as a PropertyGraph, nodes and all. Edges and the rest are
+  // moved rather than copied. Large tables are exported in row ranges on up
+  // to `num_threads` threads (0 = one per hardware thread), in row order.
+  GraphHandle Export(int num_threads = 1) &&;
+
+ private:
+  friend class GraphSnapshot;
+
+  std::shared_ptr<SymbolTable> symbols_;
+  GraphHandle graph_;
+  std::vector<std::unique_ptr<NodeTable>> tables_;
+  absl::flat_hash_map<std::string, NodeTable*> tables_by_type_;
+  EdgeTable edges_;
+  AdjacencyIndex adjacency_;
+
+  // What the arrays of a graph opened from a snapshot view, kept mapped
+  std::shared_ptr<const void> mapping_;
+};
+
+}  // namespace finetoo::graph
@@ -0,0 +1,93 @@
+// Copyright 2025 Finetoo
+// ColumnarGraph Tests
+
+#include "src/graph/columnar_graph.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "google/protobuf/util/message_differencer.h"
+
+namespace finetoo::graph {
+namespace {
+
+TEST(ColumnarGraphTest, ColumnsTrackPresentRows) {
+  SymbolTable symbols;
+  NodeTable table("Entity", &symbols);
+  for (int i = 0; i < 200; i++) table.AddRow("", 0x100 + i);
+  table.SetDouble("gc_10", 3, 1.5);
+  table.SetDouble("gc_10", 70, 2.5);
+  table.SetDouble("gc_10", 130, 3.5);
+  table.SetString("layer", 0, "WALLS");
+  table.SetString("layer", 199, "WALLS");
+  table.SetString("layer", 64, "DOORS");
+
+  const auto* doubles = table.doubles("gc_10");
+  ASSERT_NE(doubles, nullptr);
+  EXPECT_TRUE(doubles->Has(70));
+  EXPECT_FALSE(doubles->Has(71));
+  EXPECT_FALSE(doubles->Has(150));  // Past the column's end
+  std::vector<size_t> rows;
+  doubles->ForEach(4, 131, [&](size_t row) { rows.push_back(row); });
+  EXPECT_EQ(rows, (std::vector<size_t>{70, 130}));
+
+  // Strings share one symbol per distinct value
+  const auto* layers = table.strings("layer");
+  ASSERT_NE(layers, nullptr);
+  EXPECT_EQ(symbols.size(), 2);
+  EXPECT_EQ(layers->values[199], layers->values[0]);
+  EXPECT_EQ(layers->Get(64), "DOORS");
+  EXPECT_EQ(layers->Find("WALLS"), layers->values[0]);
+  EXPECT_FALSE(layers->Find("ROOF").has_value());
+
+  // Value types are separate namespaces
+  EXPECT_EQ(table.strings("gc_10"), nullptr);
+  EXPECT_EQ(table.NodeId(1), "101");
+}
+
+TEST(ColumnarGraphTest, ExportRoundTripsProto) {
+  v1::PropertyGraph graph;
+  (*graph.mutable_metadata())["dxf_version"] = "AC1027";
+  auto& entities = (*graph.mutable_nodes_by_type())["Entity"];
+  for (int i = 0; i < 100; i++) {
+    auto* node = entities.add_nodes();
+    node->set_type("Entity");
+    node->set_handle(0x20 + i);
+    (*node->mutable_string_props())["layer"] = i % 2 ? "A" : "B";
+    if (i % 3 == 0) (*node->mutable_numeric_props())["gc_10"] = i;
+    if (i % 5 == 0) (*node->mutable_string_props())["gc_10"] = "x";
+  }
+  entities.set_count(entities.nodes_size());
+  auto& layers = (*graph.mutable_nodes_by_type())["Layer"];
+  auto* layer = layers.add_nodes();
+  layer->set_id("layer_A");
+  layer->set_type("Layer");
+  (*layer->mutable_int_props())["color"] = 7;
+  (*layer->mutable_bool_props())["off"] = false;
+  layers.set_count(1);
+  auto* edge = graph.add_edges();
+  edge->set_type("BELONGS_TO");
+  edge->set_source_handle(0x21);
+  edge->set_target_node_id("layer_A");
+
+  auto columnar = ColumnarGraph::FromProto(graph);
+  ASSERT_NE(columnar.table("Entity"), nullptr);
+  EXPECT_EQ(columnar.table("Entity")->size(), 100);
+  EXPECT_EQ(columnar.table("Layer")->NodeId(0), "layer_A");
+  EXPECT_EQ(columnar.table("Block"), nullptr);
+  EXPECT_EQ(columnar.graph().nodes_by_type_size(), 0);
+  EXPECT_EQ(columnar.graph().edges_size(), 0);  // Moved into the table
+  EXPECT_EQ(columnar.edges().SourceNodeId(0), "21");
+  EXPECT_EQ(columnar.edges().target_id(0), "layer_A");
+
+  GraphHandle exported = std::move(columnar).Export();
+  std::string differences;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&differences);
+  EXPECT_TRUE(differencer.Compare(*exported, graph)) << differences;
+}
+
+}  // namespace
+}  // namespace finetoo::graph
@@ -0,0 +1,155 @@
+// Copyright 2025 Finetoo
+// Content Hash Implementation
+
+#include "src/graph/content_hash.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <system_error>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
+#include "src/parser/dxf_binary.h"
+
+namespace finetoo::graph {
+
+namespace {
+
+uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+uint64_t Fmix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+void AppendInt(uint64_t value, std::string* out) {
+  for (int i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+// Handles and pointers name objects of one drawing: the 5 and 105 handles,
+// 320-369 and 390-399 references, and the 480-481 and 1005 handles
+bool IsHandleCode(int group_code) {
+  return group_code == 5 || group_code == 105 ||
+         (group_code >= 320 && group_code <= 369) ||
+         (group_code >= 390 && group_code <= 399) || group_code == 480 ||
+         group_code == 481 || group_code == 1005;
+}
+
+template <typename T>
+bool ParseNumber(absl::string_view value, T* out) {
+  value = absl::StripAsciiWhitespace(value);
+  if (!value.empty() && value[0] == '+') value.remove_prefix(1);
+  const char* end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, *out);
+  return ec == std::errc() && ptr == end;
+}
+
+}  // namespace
+
+absl::uint128 MurmurHash3(absl::string_view data, uint64_t seed) {
+  constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+  constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+  const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+  const size_t blocks = data.size() / 16;
+  uint64_t h1 = seed;
+  uint64_t h2 = seed;
+
+  for (size_t i = 0; i < blocks; i++) {
+    uint64_t k1, k2;
+    std::memcpy(&k1, bytes + i * 16, 8);
+    std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+    h1 ^= Rotl(k1 * c1, 31) * c2;
+    h1 = (Rotl(h1, 27) + h2) * 5 + 0x52dce729;
+    h2 ^= Rotl(k2 * c2, 33) * c1;
+    h2 = (Rotl(h2, 31) + h1) * 5 + 0x38495ab5;
+  }
+
+  const unsigned char* tail = bytes + blocks * 16;
+  const size_t rest = data.size() % 16;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  for (size_t i = rest; i > 8; i--) {
+    k2 |= uint64_t{tail[i - 1]} << (8 * (i - 9));
+  }
+  for (size_t i = std::min<size_t>(rest, 8); i > 0; i--) {
+    k1 |= uint64_t{tail[i - 1]} << (8 * (i - 1));
+  }
+  if (rest > 8) h2 ^= Rotl(k2 * c2, 33) * c1;
+  if (rest > 0) h1 ^= Rotl(k1 * c1, 31) * c2;
+
+  h1 ^= data.size();
+  h2 ^= data.size();
+  h1 += h2;
+  h2 += h1;
+  h1 = Fmix(h1);
+  h2 = Fmix(h2);
+  h1 += h2;
+  h2 += h1;
+  return absl::MakeUint128(h2, h1);
+}
+
+void ContentHasher::Add(const parser::DXFEntityView& entity) {
+  record_.clear();
+  AppendInt(entity.type.size(), &record_);
+  record_.append(entity.type.data(), entity.type.size());
+
+  for (const auto& pair : entity.data) {
+    if (IsHandleCode(pair.group_code)) continue;
+    AppendInt(pair.group_code, &record_);
+
+    // Tag, then a number or the string's length and bytes
+    double real;
+    int64_t integer;
+    switch (parser::BinaryValueType(pair.group_code)) {
+      case parser::DXFBinaryValue::kDouble:
+        if (ParseNumber(pair.value, &real)) {
+          double steps = std::round(real / tolerance_);
+          if (std::fabs(steps) < 9e18) {
+            record_.push_back('r');
+            AppendInt(static_cast<int64_t>(steps), &record_);
+            continue;
+          }
+        }
+        break;
+      case parser::DXFBinaryValue::kInt16:
+      case parser::DXFBinaryValue::kInt32:
+      case parser::DXFBinaryValue::kInt64:
+      case parser::DXFBinaryValue::kBool:
+        if (ParseNumber(pair.value, &integer)) {
+          record_.push_back('i');
+          AppendInt(integer, &record_);
+          continue;
+        }
+        break;
+      default:
+        break;
+    }
+    record_.push_back('s');
+    AppendInt(pair.value.size(), &record_);
+    record_.append(pair.value.data(), pair.value.size());
+  }
+
+  sum_ += MurmurHash3(record_);
+  count_++;
+}
+
+std::string ContentHasher::Finish() const {
+  std::string totals;
+  AppendInt(absl::Uint128Low64(sum_), &totals);
+  AppendInt(absl::Uint128High64(sum_), &totals);
+  AppendInt(count_, &totals);
+  absl::uint128 hash = MurmurHash3(totals);
+  return absl::StrFormat("%016x%016x", absl::Uint128High64(hash),
+                         absl::Uint128Low64(hash));
+}
+
+}  // namespace finetoo::graph
@@ -0,0 +1,49 @@
+// Copyright 2025 Finetoo
+// Content Hash - Canonical 128-bit hashes of block contents
+//
+// Two drawings define a block alike if its entities match, whatever their
+// handles, owners or order. ContentHasher hashes each entity in canonical
+// form: handle and pointer codes, which differ between drawings, are
+// skipped; reals are rounded to a tolerance and integers compared by value.
+// Entity hashes are summed, so their order does not matter but duplicates
+// do. The hash is MurmurHash3 (x64, 128-bit): fast and the same on every
+// build, but not cryptographic.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+#include "src/parser/dxf_text_parser.h"
+
+namespace finetoo::graph {
+
+// MurmurHash3_x64_128 of `data`
+absl::uint128 MurmurHash3(absl::string_view data, uint64_t seed = 0);
+
+class ContentHasher {
+ public:
+  // Reals that round to the same multiple of `tolerance` hash alike.
+  // Values either side of a rounding boundary still differ.
+  static constexpr double kDefaultTolerance = 1e-6;
+  explicit ContentHasher(double tolerance = kDefaultTolerance)
+      : tolerance_(tolerance) {}
+
+  void Add(const parser::DXFEntityView& entity);
+
+  // Hash of the entities added so far, as 32 hex digits
+  std::string Finish() const;
+
+  size_t count() const { return count_; }
+
+ private:
+  double tolerance_;
+  absl::uint128 sum_ = 0;
+  uint64_t count_ = 0;
+  std::string record_;  // Canonical bytes of the entity being added
+};
+
+}  // namespace finetoo::graph
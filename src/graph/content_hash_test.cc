@@ -0,0 +1,64 @@
+// Copyright 2025 Finetoo
+// ContentHasher Tests
+
+#include "src/graph/content_hash.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+
+namespace finetoo::graph {
+namespace {
+
+TEST(ContentHashTest, MatchesReferenceMurmurHash3) {
+  EXPECT_EQ(MurmurHash3(""), 0);
+  EXPECT_EQ(MurmurHash3("hello"),
+            absl::MakeUint128(0x5b1e906a48ae1d19, 0xcbd8a7b341bd9b02));
+  EXPECT_EQ(MurmurHash3("The quick brown fox jumps over the lazy dog"),
+            absl::MakeUint128(0x7a433ca9c49a9347, 0xe34bbc7bbc071b6c));
+}
+
+parser::DXFEntityView Entity(absl::string_view type,
+                             const std::vector<parser::DXFPair>& data) {
+  parser::DXFEntityView entity;
+  entity.type = type;
+  entity.data = data;
+  return entity;
+}
+
+std::string Hash(const std::vector<parser::DXFEntityView>& entities) {
+  ContentHasher hasher;
+  for (const auto& entity : entities) hasher.Add(entity);
+  return hasher.Finish();
+}
+
+TEST(ContentHashTest, HashesCanonicalContent) {
+  std::vector<parser::DXFPair> line = {
+      {5, "1A"}, {330, "1F"}, {8, "0"}, {10, "1.0"}, {20, "2.5"}, {62, "1"}};
+  std::vector<parser::DXFPair> circle = {{8, "0"}, {10, "0"}, {40, "3"}};
+  auto a = Entity("LINE", line);
+  auto b = Entity("CIRCLE", circle);
+  std::string hash = Hash({a, b});
+  EXPECT_EQ(hash.size(), 32);
+
+  // Handles, order, number formatting and sub-tolerance noise don't count
+  std::vector<parser::DXFPair> same_line = {
+      {5, "2B"}, {330, "9"}, {8, "0"}, {10, "1.0000000001"},
+      {20, "+2.50"}, {62, "     1"}};
+  EXPECT_EQ(Hash({b, Entity("LINE", same_line)}), hash);
+
+  // Content, duplicates and entity types do
+  std::vector<parser::DXFPair> moved = line;
+  moved[3].value = "1.001";
+  EXPECT_NE(Hash({Entity("LINE", moved), b}), hash);
+  EXPECT_NE(Hash({a, b, b}), hash);
+  EXPECT_NE(Hash({Entity("XLINE", line), b}), hash);
+  EXPECT_NE(Hash({}), hash);
+}
+
+}  // namespace
+}  // namespace finetoo::graph
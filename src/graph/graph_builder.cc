@@ -3,170 +3,825 @@
 
 #include "src/graph/graph_builder.h"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <memory>
 #include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "google/protobuf/arena.h"
+#include "src/common/parallel.h"
+#include "src/graph/content_hash.h"
 #include "src/schema/schema_analyzer.h"
 
 namespace finetoo::graph {
 
-GraphBuilder::GraphBuilder()
-    : arena_(std::make_unique<google::protobuf::Arena>()) {}
+namespace {
 
-GraphBuilder::~GraphBuilder() = default;
+bool HasLayerEdge(const parser::DXFEntityView& entity) {
+  return !entity.layer.empty();
+}
 
-absl::StatusOr<finetoo::graph::v1::PropertyGraph> GraphBuilder::Build(
-    const parser::DXFFile& dxf_file) {
-  finetoo::graph::v1::PropertyGraph graph;
+// Block an INSERT entity places (group code 2), or empty
+absl::string_view ReferencedBlock(const parser::DXFEntityView& entity) {
+  if (entity.type != "INSERT") return {};
+  auto block_name_or = entity.GetString(2);
+  return block_name_or.ok() ? *block_name_or : absl::string_view();
+}
+
+bool HasReferenceEdge(const parser::DXFEntityView& entity) {
+  return !ReferencedBlock(entity).empty();
+}
 
-  // Create schema with operational metadata
-  *graph.mutable_schema() = CreateSchema(dxf_file);
+// CONTAINS edges of a block: one per INSERT among its entities
+size_t CountContainsEdges(const parser::DXFBlock& block) {
+  size_t count = 0;
+  for (const auto& entity : block.entities) count += HasReferenceEdge(entity);
+  return count;
+}
 
-  // Add metadata
-  (*graph.mutable_metadata())["dxf_version"] = dxf_file.version;
-  (*graph.mutable_metadata())["entity_count"] = std::to_string(dxf_file.entities.size());
-  (*graph.mutable_metadata())["block_count"] = std::to_string(dxf_file.blocks.size());
+// Position of an edge type's run in a graph's edges
+int EdgeRun(absl::string_view type) {
+  if (type == "BELONGS_TO") return 0;
+  if (type == "REFERENCES") return 1;
+  return 2;
+}
 
-  // Add entities to graph as nodes
-  for (const auto& entity : dxf_file.entities) {
-    AddEntity(entity, &graph);
+// True if `text` is well-formed UTF-8
+bool IsUtf8(absl::string_view text) {
+  size_t i = 0;
+  while (i < text.size()) {
+    unsigned char c = text[i];
+    if (c < 0x80) {
+      i++;
+      continue;
+    }
+    size_t length = c >= 0xC2 && c <= 0xDF   ? 2
+                    : c >= 0xE0 && c <= 0xEF ? 3
+                    : c >= 0xF0 && c <= 0xF4 ? 4
+                                             : 0;
+    if (length == 0 || i + length > text.size()) return false;
+    for (size_t k = 1; k < length; k++) {
+      if ((text[i + k] & 0xC0) != 0x80) return false;
+    }
+    // Overlong forms, surrogates and code points past U+10FFFF
+    unsigned char next = text[i + 1];
+    if ((c == 0xE0 && next < 0xA0) || (c == 0xED && next >= 0xA0) ||
+        (c == 0xF0 && next < 0x90) || (c == 0xF4 && next >= 0x90)) {
+      return false;
+    }
+    i += length;
   }
+  return true;
+}
 
-  // Add blocks to graph as nodes
-  for (const auto& block : dxf_file.blocks) {
-    AddBlock(block, &graph);
+// DXF text is UTF-8 from AutoCAD 2007 (AC1021) on, and in the drawing's
+// code page before, ANSI_1252 by default. Protobuf strings must be UTF-8,
+// so text that isn't is read as Windows-1252 into `scratch`.
+absl::string_view Utf8Text(absl::string_view text, std::string* scratch) {
+  if (IsUtf8(text)) return text;
+
+  // Windows-1252 is Latin-1 but for 0x80-0x9F
+  static constexpr uint16_t kC1[32] = {
+      0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+      0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+      0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+      0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178};
+  scratch->clear();
+  for (unsigned char c : text) {
+    uint32_t code_point = c >= 0x80 && c < 0xA0 ? kC1[c - 0x80] : c;
+    if (code_point < 0x80) {
+      scratch->push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+      scratch->push_back(static_cast<char>(0xC0 | code_point >> 6));
+      scratch->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+      scratch->push_back(static_cast<char>(0xE0 | code_point >> 12));
+      scratch->push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+      scratch->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
   }
+  return *scratch;
+}
 
-  // Build REFERENCES edges: INSERT entities → Block nodes
-  // For INSERT entities, group code 2 contains the block name
-  for (const auto& entity : dxf_file.entities) {
-    if (entity.type == "INSERT") {
-      // Get block name from group code 2
-      auto block_name_or = entity.GetString(2);
-      if (block_name_or.ok() && !block_name_or->empty()) {
-        const std::string& block_name = *block_name_or;
+// Group codes the DXF reference defines run from 0 to 1071
+constexpr int kMaxGroupCode = 1071;
 
-        auto& edges = *graph.mutable_edges();
-        auto* edge = edges.Add();
+// Property key of a group code's values ("gc_10"). Keys of the defined
+// codes are built once; others are formatted into `scratch`.
+absl::string_view GroupCodeKey(int group_code, std::string* scratch) {
+  static const auto* const kKeys = [] {
+    auto* keys = new std::array<std::string, kMaxGroupCode + 1>;
+    for (int code = 0; code <= kMaxGroupCode; code++) {
+      (*keys)[code] = absl::StrCat("gc_", code);
+    }
+    return keys;
+  }();
+  if (group_code >= 0 && group_code <= kMaxGroupCode) {
+    return (*kKeys)[group_code];
+  }
+  *scratch = absl::StrCat("gc_", group_code);
+  return *scratch;
+}
+
+// Leading number of `value`, read as std::stod reads it (after leading
+// whitespace and a sign) but failing instead of throwing. Hexadecimal
+// values, which stod also accepts, are left to be stored as strings.
+bool ParseLeadingDouble(absl::string_view value, double* out) {
+  const char* begin = value.data();
+  const char* end = begin + value.size();
+  while (begin != end && absl::ascii_isspace(*begin)) begin++;
+  bool negative = begin != end && *begin == '-';
+  if (begin != end && (*begin == '+' || *begin == '-')) begin++;
+  if (begin == end || *begin == '+' || *begin == '-') return false;
+  if (end - begin > 1 && begin[0] == '0' &&
+      absl::ascii_tolower(begin[1]) == 'x') {
+    return false;
+  }
 
-        edge->set_id("edge_" + entity.handle + "_ref_" + block_name);
-        edge->set_type("REFERENCES");
-        edge->set_source_node_id(entity.handle);
-        edge->set_target_node_id("block_" + block_name);
+  auto [ptr, ec] = std::from_chars(begin, end, *out);
+  if (ec != std::errc()) return false;
+  if (negative) *out = -*out;
+  return true;
+}
+
+// Block entities per thread when hashing blocks in parallel
+constexpr size_t kMinHashEntitiesPerThread = 4096;
+
+// Content hashes of blocks [begin, end), computed on up to `max_threads`
+// threads
+std::vector<std::string> HashBlocks(const parser::DXFFile& dxf_file,
+                                    size_t begin, size_t end,
+                                    int max_threads) {
+  size_t entities = 0;
+  for (size_t i = begin; i < end; i++) {
+    entities += dxf_file.blocks[i].entities.size();
+  }
+  int num_threads = std::clamp<size_t>(entities / kMinHashEntitiesPerThread,
+                                       1, max_threads);
+
+  std::vector<std::string> hashes(end - begin);
+  common::ParallelFor(hashes.size(), num_threads, [&](size_t i) {
+    ContentHasher hasher;
+    for (const auto& entity : dxf_file.blocks[begin + i].entities) {
+      hasher.Add(entity);
+    }
+    hashes[i] = hasher.Finish();
+  });
+  return hashes;
+}
 
-        (*edge->mutable_properties())["block_name"] = block_name;
+// Drawing entities per range when building them in parallel
+constexpr size_t kMinEntitiesPerThread = 4096;
+
+// Nodes, edges and layers of a range of a drawing's entities, built on a
+// thread of its own. Edges are on the graph's arena.
+struct EntityRange {
+  std::unique_ptr<ColumnarGraph> nodes;  // Null if built into the graph
+  finetoo::graph::v1::PropertyGraph* layer_edges = nullptr;
+  finetoo::graph::v1::PropertyGraph* reference_edges = nullptr;
+  std::vector<absl::string_view> layers;  // In order of first use
+};
+
+// Move `from`'s edges to the end of `to`, on the same arena
+void MoveEdges(finetoo::graph::v1::PropertyGraph* from,
+               google::protobuf::RepeatedPtrField<finetoo::graph::v1::Edge>*
+                   to) {
+  std::vector<finetoo::graph::v1::Edge*> edges(from->edges_size());
+  from->mutable_edges()->UnsafeArenaExtractSubrange(0, edges.size(),
+                                                    edges.data());
+  for (auto* edge : edges) to->UnsafeArenaAddAllocated(edge);
+}
+
+// Replace `count` elements of `field` from `start` with the ones `add`
+// appends to it
+template <typename T>
+void ReplaceRange(google::protobuf::RepeatedPtrField<T>* field, size_t start,
+                  size_t count, absl::FunctionRef<void()> add) {
+  field->DeleteSubrange(start, count);
+  size_t end = field->size();
+  add();
+  std::rotate(field->pointer_begin() + start, field->pointer_begin() + end,
+              field->pointer_end());
+}
+
+}  // namespace
+
+// Adds a drawing's records to a graph as the parser streams them, in the
+// order Build() adds them. Edges are added as entities arrive and sorted
+// into Build()'s runs (all BELONGS_TO, then REFERENCES, then CONTAINS) by
+// Finish().
+// Layers that only entities name are held back until then, since they
+// follow the LAYER table's, which may come later.
+class GraphBuilder::GraphVisitor : public parser::DXFVisitor {
+ public:
+  GraphVisitor(GraphBuilder* builder, ColumnarGraph* graph)
+      : builder_(builder), graph_(graph), edges_(graph->mutable_graph()) {}
+
+  absl::Status OnVersion(absl::string_view version) override {
+    version_ = std::string(version);
+    return absl::OkStatus();
+  }
+
+  absl::Status OnTableRecord(absl::string_view table,
+                             const parser::DXFEntityView& record) override {
+    if (table == "LAYER") builder_->AddLayer(record, graph_);
+    return absl::OkStatus();
+  }
+
+  absl::Status OnBlockBegin(const parser::DXFBlockView& block) override {
+    in_block_ = true;
+    block_name_ = std::string(block.name);
+    block_hasher_ = ContentHasher();
+    return absl::OkStatus();
+  }
+
+  absl::Status OnEntity(const parser::DXFEntityView& entity) override {
+    // Block entities are counted and hashed, and give only CONTAINS edges
+    if (in_block_) {
+      block_hasher_.Add(entity);
+      builder_->AddContainsEdge(block_name_, entity, edges_);
+      return absl::OkStatus();
+    }
+
+    entity_count_++;
+    builder_->AddEntity(entity, graph_);
+    builder_->AddLayerEdge(entity, edges_);
+    builder_->AddReferenceEdge(entity, edges_);
+    if (HasLayerEdge(entity) && !entity_layers_.contains(entity.layer)) {
+      entity_layers_.emplace(entity.layer);
+      entity_layer_order_.emplace_back(entity.layer);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status OnBlockEnd(const parser::DXFBlockView& block) override {
+    in_block_ = false;
+    block_count_++;
+    builder_->AddBlock(block, block_hasher_.count(), block_hasher_.Finish(),
+                       graph_);
+    return absl::OkStatus();
+  }
+
+  // Add what was held back, order edges, and add metadata and stats
+  void Finish() {
+    for (const auto& name : entity_layer_order_) {
+      builder_->GetOrAddLayer(name, graph_);
+    }
+
+    auto* edges = edges_->mutable_edges();
+    std::stable_sort(edges->pointer_begin(), edges->pointer_end(),
+                     [](const finetoo::graph::v1::Edge* a,
+                        const finetoo::graph::v1::Edge* b) {
+                       return EdgeRun(a->type()) < EdgeRun(b->type());
+                     });
+
+    builder_->SetMetadata(version_, entity_count_, block_count_, edges_);
+    builder_->ComputeStats(graph_);
+  }
+
+ private:
+  GraphBuilder* builder_;
+  ColumnarGraph* graph_;
+  finetoo::graph::v1::PropertyGraph* edges_;  // graph_'s, with its metadata
+
+  std::string version_;
+  size_t entity_count_ = 0;
+  size_t block_count_ = 0;
+
+  // Entities of the block being streamed
+  bool in_block_ = false;
+  std::string block_name_;
+  ContentHasher block_hasher_;
+
+  // Layers entities name, in order of first use
+  absl::flat_hash_set<std::string> entity_layers_;
+  std::vector<std::string> entity_layer_order_;
+};
+
+GraphBuilder::GraphBuilder() : GraphBuilder(GraphBuildOptions()) {}
+
+GraphBuilder::GraphBuilder(std::shared_ptr<SymbolTable> symbols)
+    : GraphBuilder(GraphBuildOptions(), std::move(symbols)) {}
+
+GraphBuilder::GraphBuilder(GraphBuildOptions options,
+                           std::shared_ptr<SymbolTable> symbols)
+    : options_(options), symbols_(std::move(symbols)) {}
+
+GraphBuilder::~GraphBuilder() = default;
+
+absl::StatusOr<GraphHandle> GraphBuilder::Build(
+    const parser::DXFFile& dxf_file) {
+  // Exported graphs copy their strings into the protos, so their columns
+  // intern into a SymbolTable of their own, freed with them
+  ColumnarGraph columnar;
+  AddDrawing(dxf_file, &columnar);
+  return std::move(columnar).Export(NumThreads());
+}
+
+absl::StatusOr<ColumnarGraph> GraphBuilder::BuildColumnar(
+    const parser::DXFFile& dxf_file) {
+  ColumnarGraph columnar(symbols_);
+  AddDrawing(dxf_file, &columnar);
+  columnar.IndexEdges();
+  return columnar;
+}
+
+void GraphBuilder::AddDrawing(const parser::DXFFile& dxf_file,
+                              ColumnarGraph* columnar) {
+  auto* graph = columnar->mutable_graph();
+  Reset();
+
+  // Schema with operational metadata, and drawing metadata
+  SetMetadata(dxf_file.version, dxf_file.entities.size(),
+              dxf_file.blocks.size(), graph);
+
+  // Entities are split into ranges, each built on a thread into nodes and
+  // edges of its own: entity nodes, BELONGS_TO edges (entities → Layer
+  // nodes) and REFERENCES edges (INSERT entities → Block nodes). Ranges
+  // intern their strings apart, then are joined in file order.
+  const auto& entities = dxf_file.entities;
+  int num_threads = NumThreads();
+  size_t range_count = std::clamp<size_t>(
+      entities.size() / kMinEntitiesPerThread, 1, num_threads);
+  std::vector<EntityRange> ranges(range_count);
+  google::protobuf::Arena* arena = graph->GetArena();
+  common::ParallelFor(range_count, num_threads, [&](size_t i) {
+    EntityRange& range = ranges[i];
+    ColumnarGraph* nodes = columnar;
+    if (range_count > 1) {
+      range.nodes = std::make_unique<ColumnarGraph>();
+      nodes = range.nodes.get();
+    }
+    range.layer_edges = google::protobuf::Arena::Create<
+        finetoo::graph::v1::PropertyGraph>(arena);
+    range.reference_edges = google::protobuf::Arena::Create<
+        finetoo::graph::v1::PropertyGraph>(arena);
+
+    absl::flat_hash_set<absl::string_view> layers;
+    size_t end = entities.size() * (i + 1) / range_count;
+    for (size_t e = entities.size() * i / range_count; e < end; e++) {
+      const auto& entity = entities[e];
+      AddEntity(entity, nodes);
+      AddLayerEdge(entity, range.layer_edges);
+      AddReferenceEdge(entity, range.reference_edges);
+      if (HasLayerEdge(entity) && layers.insert(entity.layer).second) {
+        range.layers.push_back(entity.layer);
       }
     }
+  });
+  if (range_count > 1) {
+    std::vector<const NodeTable*> tables;
+    for (const auto& range : ranges) {
+      tables.push_back(range.nodes->table("Entity"));
+    }
+    columnar->mutable_table("Entity")->AppendTables(tables, num_threads);
   }
 
-  // Compute statistics
-  auto* stats = graph.mutable_stats();
-  stats->set_node_count(0);
-  stats->set_edge_count(graph.edges_size());
+  // Add blocks to graph as nodes
+  std::vector<std::string> hashes =
+      HashBlocks(dxf_file, 0, dxf_file.blocks.size(), num_threads);
+  for (size_t i = 0; i < dxf_file.blocks.size(); i++) {
+    const auto& block = dxf_file.blocks[i];
+    AddBlock({block.name, block.handle}, block.entities.size(), hashes[i],
+             columnar);
+  }
 
-  for (const auto& [type, collection] : graph.nodes_by_type()) {
-    int64_t count = collection.nodes_size();
-    stats->set_node_count(stats->node_count() + count);
-    (*stats->mutable_nodes_per_type())[type] = count;
+  // Add layers to graph as nodes: LAYER table records, then layers only
+  // entities name
+  AddLayerTable(dxf_file, columnar);
+  for (const auto& range : ranges) {
+    for (absl::string_view name : range.layers) GetOrAddLayer(name, columnar);
+  }
+
+  // Edges in runs by type, each in file order
+  auto* edges = graph->mutable_edges();
+  for (auto& range : ranges) MoveEdges(range.layer_edges, edges);
+  for (auto& range : ranges) MoveEdges(range.reference_edges, edges);
+  if (arena == nullptr) {
+    for (auto& range : ranges) {
+      delete range.layer_edges;
+      delete range.reference_edges;
+    }
+  }
+
+  // Build CONTAINS edges: Block nodes → the blocks their INSERTs place
+  for (const auto& block : dxf_file.blocks) {
+    for (const auto& entity : block.entities) {
+      AddContainsEdge(block.name, entity, graph);
+    }
   }
 
-  (*stats->mutable_edges_per_type())["REFERENCES"] = graph.edges_size();
+  ComputeStats(columnar);
+}
+
+absl::Status GraphBuilder::Update(const parser::DXFFile& dxf_file,
+                                  const parser::DXFChanges& changes,
+                                  finetoo::graph::v1::PropertyGraph* graph) {
+  Reset();
+
+  // Runs of kept records must fit the graph's
+  const auto& stats = graph->stats();
+  auto stat = [](const auto& counts, absl::string_view type) -> size_t {
+    auto it = counts.find(std::string(type));
+    return it == counts.end() ? 0 : it->second;
+  };
+  const auto& entities = dxf_file.entities;
+  size_t entity_prefix = changes.entities.prefix;
+  size_t entity_suffix = changes.entities.suffix;
+  size_t block_prefix = changes.blocks.prefix;
+  size_t block_suffix = changes.blocks.suffix;
+  size_t old_entities = stat(stats.nodes_per_type(), "Entity");
+  size_t old_blocks = stat(stats.nodes_per_type(), "Block");
+  if (entity_prefix + entity_suffix > std::min(old_entities, entities.size()) ||
+      block_prefix + block_suffix >
+          std::min(old_blocks, dxf_file.blocks.size()) ||
+      stats.edge_count() != graph->edges_size()) {
+    return absl::FailedPreconditionError(
+        "Graph was not built from the drawing's previous version");
+  }
+
+  // Edges come in runs by type and, within those, in entity order: kept
+  // entities at either end keep theirs
+  auto count_edges = [&](size_t begin, size_t end, auto has_edge) {
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) count += has_edge(entities[i]);
+    return count;
+  };
+  size_t new_entities_end = entities.size() - entity_suffix;
+  size_t layer_edges = stat(stats.edges_per_type(), "BELONGS_TO");
+  size_t layer_before = count_edges(0, entity_prefix, HasLayerEdge);
+  size_t layer_after =
+      count_edges(new_entities_end, entities.size(), HasLayerEdge);
+  size_t reference_edges = stat(stats.edges_per_type(), "REFERENCES");
+  size_t reference_before = count_edges(0, entity_prefix, HasReferenceEdge);
+  size_t reference_after =
+      count_edges(new_entities_end, entities.size(), HasReferenceEdge);
+  size_t new_blocks_end = dxf_file.blocks.size() - block_suffix;
+  size_t contains_edges = stat(stats.edges_per_type(), "CONTAINS");
+  size_t contains_before = 0;
+  size_t contains_after = 0;
+  for (size_t i = 0; i < block_prefix; i++) {
+    contains_before += CountContainsEdges(dxf_file.blocks[i]);
+  }
+  for (size_t i = new_blocks_end; i < dxf_file.blocks.size(); i++) {
+    contains_after += CountContainsEdges(dxf_file.blocks[i]);
+  }
+  if (layer_before + layer_after > layer_edges ||
+      reference_before + reference_after > reference_edges ||
+      contains_before + contains_after > contains_edges) {
+    return absl::FailedPreconditionError(
+        "Graph was not built from the drawing's previous version");
+  }
+
+  // Later runs first, so earlier positions stay put
+  auto* edges = graph->mutable_edges();
+  ReplaceRange(edges, layer_edges + reference_edges + contains_before,
+               contains_edges - contains_before - contains_after, [&] {
+                 for (size_t i = block_prefix; i < new_blocks_end; i++) {
+                   const auto& block = dxf_file.blocks[i];
+                   for (const auto& entity : block.entities) {
+                     AddContainsEdge(block.name, entity, graph);
+                   }
+                 }
+               });
+  ReplaceRange(edges, layer_edges + reference_before,
+               reference_edges - reference_before - reference_after, [&] {
+                 for (size_t i = entity_prefix; i < new_entities_end; i++) {
+                   AddReferenceEdge(entities[i], graph);
+                 }
+               });
+  ReplaceRange(edges, layer_before, layer_edges - layer_before - layer_after,
+               [&] {
+                 for (size_t i = entity_prefix; i < new_entities_end; i++) {
+                   AddLayerEdge(entities[i], graph);
+                 }
+               });
+
+  // New nodes are built in a ColumnarGraph of their own, then exported in
+  // place of the replaced ones. Layers are few, but depend on TABLES and on
+  // every entity: they are all rebuilt.
+  ColumnarGraph added;
+  for (size_t i = entity_prefix; i < new_entities_end; i++) {
+    AddEntity(entities[i], &added);
+  }
+  std::vector<std::string> hashes =
+      HashBlocks(dxf_file, block_prefix, new_blocks_end, NumThreads());
+  for (size_t i = block_prefix; i < new_blocks_end; i++) {
+    const auto& block = dxf_file.blocks[i];
+    AddBlock({block.name, block.handle}, block.entities.size(),
+             hashes[i - block_prefix], &added);
+  }
+  AddLayers(dxf_file, &added);
+
+  auto& nodes_by_type = *graph->mutable_nodes_by_type();
+  auto replace_nodes = [&](absl::string_view type, size_t prefix,
+                           size_t removed) {
+    auto& collection = nodes_by_type[std::string(type)];
+    const NodeTable* table = added.table(type);
+    ReplaceRange(collection.mutable_nodes(), prefix, removed, [&] {
+      if (table != nullptr) {
+        table->Export(0, table->size(), collection.mutable_nodes());
+      }
+    });
+    collection.set_count(collection.nodes_size());
+    if (collection.nodes_size() == 0) nodes_by_type.erase(std::string(type));
+  };
+  replace_nodes("Entity", entity_prefix,
+                old_entities - entity_prefix - entity_suffix);
+  replace_nodes("Block", block_prefix,
+                old_blocks - block_prefix - block_suffix);
+  auto layers = nodes_by_type.find("Layer");
+  replace_nodes("Layer", 0,
+                layers == nodes_by_type.end() ? 0 : layers->second.nodes_size());
+
+  SetMetadata(dxf_file.version, entities.size(), dxf_file.blocks.size(),
+              graph);
+  ComputeStats(graph);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<GraphHandle> GraphBuilder::BuildFromFile(
+    absl::string_view file_path) {
+  ColumnarGraph columnar;
+  auto status = Stream(
+      [&](parser::DXFVisitor& visitor) {
+        return parser::DXFTextParser().Parse(file_path, visitor);
+      },
+      &columnar);
+  if (!status.ok()) return status;
+
+  return std::move(columnar).Export(NumThreads());
+}
 
-  return graph;
+absl::StatusOr<GraphHandle> GraphBuilder::BuildFromStream(
+    std::istream& input) {
+  ColumnarGraph columnar;
+  auto status = Stream(
+      [&](parser::DXFVisitor& visitor) {
+        return parser::DXFTextParser().Parse(input, visitor);
+      },
+      &columnar);
+  if (!status.ok()) return status;
+
+  return std::move(columnar).Export(NumThreads());
 }
 
-absl::StatusOr<finetoo::graph::v1::PropertyGraph> GraphBuilder::BuildFromFile(
+absl::StatusOr<ColumnarGraph> GraphBuilder::BuildColumnarFromFile(
     absl::string_view file_path) {
-  parser::DXFTextParser parser;
-  auto dxf_or = parser.Parse(file_path);
-  if (!dxf_or.ok()) return dxf_or.status();
+  ColumnarGraph columnar(symbols_);
+  auto status = Stream(
+      [&](parser::DXFVisitor& visitor) {
+        return parser::DXFTextParser().Parse(file_path, visitor);
+      },
+      &columnar);
+  if (!status.ok()) return status;
+
+  columnar.IndexEdges();
+  return columnar;
+}
+
+absl::Status GraphBuilder::Stream(
+    absl::FunctionRef<absl::Status(parser::DXFVisitor&)> parse,
+    ColumnarGraph* graph) {
+  Reset();
+
+  GraphVisitor visitor(this, graph);
+  auto status = parse(visitor);
+  if (!status.ok()) return status;
+
+  visitor.Finish();
+  return absl::OkStatus();
+}
+
+void GraphBuilder::Reset() { layers_by_name_.clear(); }
 
-  return Build(*dxf_or);
+int GraphBuilder::NumThreads() const {
+  return options_.num_threads > 0 ? options_.num_threads
+                                  : common::DefaultThreadCount();
+}
+
+void GraphBuilder::SetMetadata(absl::string_view version, size_t entity_count,
+                               size_t block_count,
+                               finetoo::graph::v1::PropertyGraph* graph) {
+  auto& metadata = *graph->mutable_metadata();
+  if (!graph->has_schema() || metadata["dxf_version"] != version) {
+    *graph->mutable_schema() = CreateSchema(version);
+  }
+  metadata["dxf_version"] = std::string(version);
+  metadata["entity_count"] = std::to_string(entity_count);
+  metadata["block_count"] = std::to_string(block_count);
 }
 
 finetoo::graph::v1::Schema GraphBuilder::CreateSchema(
-    const parser::DXFFile& dxf_file) {
+    absl::string_view version) {
   // Use SchemaAnalyzer to create DXF schema
-  auto schema_or = schema::SchemaAnalyzer::CreateDXFSchema(dxf_file.version);
+  auto schema_or = schema::SchemaAnalyzer::CreateDXFSchema(version);
   if (schema_or.ok()) {
     return *schema_or;
   }
   return finetoo::graph::v1::Schema();  // Fallback
 }
 
-absl::string_view GraphBuilder::InternString(absl::string_view str) {
-  auto [it, inserted] = string_pool_.insert({std::string(str), str});
-  return it->second;
+void GraphBuilder::AddLayerTable(const parser::DXFFile& dxf_file,
+                                 ColumnarGraph* graph) {
+  auto layer_table = dxf_file.table_by_name.find("LAYER");
+  if (layer_table != dxf_file.table_by_name.end()) {
+    for (const auto& record : layer_table->second->records) {
+      AddLayer(record, graph);
+    }
+  }
 }
 
-void GraphBuilder::AddEntity(const parser::DXFEntity& entity,
-                              finetoo::graph::v1::PropertyGraph* graph) {
-  // Get or create Entity node collection
-  auto& entity_collection = (*graph->mutable_nodes_by_type())["Entity"];
-  auto* node = entity_collection.mutable_nodes()->Add();
+void GraphBuilder::AddLayers(const parser::DXFFile& dxf_file,
+                             ColumnarGraph* graph) {
+  AddLayerTable(dxf_file, graph);
+
+  // Layers an entity names but the LAYER table lacks (e.g. no TABLES
+  // section) get a bare node
+  for (const auto& entity : dxf_file.entities) {
+    if (HasLayerEdge(entity)) GetOrAddLayer(entity.layer, graph);
+  }
+}
+
+void GraphBuilder::AddLayerEdge(const parser::DXFEntityView& entity,
+                                finetoo::graph::v1::PropertyGraph* graph) {
+  if (!HasLayerEdge(entity)) return;
+
+  std::string scratch;
+  absl::string_view layer = Utf8Text(entity.layer, &scratch);
+  auto* edge = graph->mutable_edges()->Add();
+  edge->set_id(absl::StrCat("edge_", parser::FormatHandle(entity.handle),
+                            "_layer_", layer));
+  edge->set_type("BELONGS_TO");
+  edge->set_source_handle(entity.handle);
+  edge->set_target_node_id(absl::StrCat("layer_", layer));
+}
 
-  // Set node ID and type
-  node->set_id(entity.handle);
-  node->set_type("Entity");
+void GraphBuilder::AddReferenceEdge(const parser::DXFEntityView& entity,
+                                    finetoo::graph::v1::PropertyGraph* graph) {
+  std::string scratch;
+  absl::string_view block_name = Utf8Text(ReferencedBlock(entity), &scratch);
+  if (block_name.empty()) return;
+
+  auto* edge = graph->mutable_edges()->Add();
+  edge->set_id(absl::StrCat("edge_", parser::FormatHandle(entity.handle),
+                            "_ref_", block_name));
+  edge->set_type("REFERENCES");
+  edge->set_source_handle(entity.handle);
+  edge->set_target_node_id(absl::StrCat("block_", block_name));
+
+  (*edge->mutable_properties())["block_name"] = std::string(block_name);
+}
+
+void GraphBuilder::AddContainsEdge(absl::string_view block_name,
+                                   const parser::DXFEntityView& entity,
+                                   finetoo::graph::v1::PropertyGraph* graph) {
+  std::string scratch, nested_scratch;
+  absl::string_view nested_name =
+      Utf8Text(ReferencedBlock(entity), &nested_scratch);
+  if (nested_name.empty()) return;
+  block_name = Utf8Text(block_name, &scratch);
+
+  // Block entities stay out of the node set, so the edge links the blocks;
+  // the INSERT is named by handle
+  std::string insert_handle = parser::FormatHandle(entity.handle);
+  auto* edge = graph->mutable_edges()->Add();
+  edge->set_id(absl::StrCat("edge_", insert_handle, "_in_", block_name));
+  edge->set_type("CONTAINS");
+  edge->set_source_node_id(absl::StrCat("block_", block_name));
+  edge->set_target_node_id(absl::StrCat("block_", nested_name));
+
+  auto& properties = *edge->mutable_properties();
+  properties["block_name"] = std::string(nested_name);
+  properties["insert_handle"] = std::move(insert_handle);
+}
+
+void GraphBuilder::ComputeStats(finetoo::graph::v1::PropertyGraph* graph) {
+  auto* stats = graph->mutable_stats();
+  stats->Clear();
+  stats->set_edge_count(graph->edges_size());
+
+  for (const auto& [type, collection] : graph->nodes_by_type()) {
+    int64_t count = collection.nodes_size();
+    stats->set_node_count(stats->node_count() + count);
+    (*stats->mutable_nodes_per_type())[type] = count;
+  }
+
+  for (const auto& edge : graph->edges()) {
+    (*stats->mutable_edges_per_type())[edge.type()]++;
+  }
+}
+
+void GraphBuilder::ComputeStats(ColumnarGraph* graph) {
+  ComputeStats(graph->mutable_graph());
+
+  auto* stats = graph->mutable_graph()->mutable_stats();
+  for (const auto& table : graph->tables()) {
+    int64_t count = table->size();
+    stats->set_node_count(stats->node_count() + count);
+    (*stats->mutable_nodes_per_type())[table->type()] = count;
+  }
+}
+
+void GraphBuilder::AddLayer(const parser::DXFEntityView& record,
+                            ColumnarGraph* graph) {
+  auto name_or = record.GetString(2);
+  if (!name_or.ok() || name_or->empty()) return;
+
+  size_t row = GetOrAddLayer(*name_or, graph);
+  NodeTable* layers = graph->mutable_table("Layer");
+  layers->set_handle(row, record.handle);
+
+  // Negative color means the layer is off; flag 1 = frozen, 4 = locked
+  auto linetype_or = record.GetString(6);
+  if (linetype_or.ok()) {
+    std::string scratch;
+    layers->SetString("linetype", row, Utf8Text(*linetype_or, &scratch));
+  }
+  auto color_or = record.GetInt(62);
+  if (color_or.ok()) {
+    layers->SetInt("color", row, std::abs(*color_or));
+    layers->SetBool("off", row, *color_or < 0);
+  }
+  auto flags_or = record.GetInt(70);
+  if (flags_or.ok()) {
+    layers->SetInt("flags", row, *flags_or);
+    layers->SetBool("frozen", row, (*flags_or & 1) != 0);
+    layers->SetBool("locked", row, (*flags_or & 4) != 0);
+  }
+}
+
+size_t GraphBuilder::GetOrAddLayer(absl::string_view name,
+                                   ColumnarGraph* graph) {
+  auto it = layers_by_name_.find(name);
+  if (it != layers_by_name_.end()) return it->second;
+
+  std::string scratch;
+  absl::string_view text = Utf8Text(name, &scratch);
+  NodeTable* layers = graph->mutable_table("Layer");
+  size_t row = layers->AddRow(absl::StrCat("layer_", text), parser::kNoHandle);
+  layers->SetString("name", row, text);
+
+  layers_by_name_.emplace(std::string(name), row);
+  return row;
+}
+
+void GraphBuilder::AddEntity(const parser::DXFEntityView& entity,
+                             ColumnarGraph* graph) {
+  // Entities are identified by handle alone
+  NodeTable* entities = graph->mutable_table("Entity");
+  size_t row = entities->AddRow("", entity.handle);
 
   // Add basic properties
-  (*node->mutable_string_props())["handle"] = InternString(entity.handle);
-  (*node->mutable_string_props())["type"] = InternString(entity.type);
-  (*node->mutable_string_props())["layer"] = InternString(entity.layer);
+  std::string scratch, text;
+  entities->SetString("type", row, entity.type);
+  entities->SetString("layer", row, Utf8Text(entity.layer, &text));
 
   // Store all DXF group codes as properties
   // This is generic - operations will extract semantics later
   for (const auto& pair : entity.data) {
-    std::string prop_key = "gc_" + std::to_string(pair.group_code);
+    absl::string_view prop_key = GroupCodeKey(pair.group_code, &scratch);
 
     // Try to parse as double for numeric group codes
-    if (pair.group_code >= 10 && pair.group_code <= 59) {
-      try {
-        double numeric_value = std::stod(pair.value);
-        (*node->mutable_numeric_props())[prop_key] = numeric_value;
-      } catch (...) {
-        (*node->mutable_string_props())[prop_key] = InternString(pair.value);
-      }
+    double numeric_value;
+    if (pair.group_code >= 10 && pair.group_code <= 59 &&
+        ParseLeadingDouble(pair.value, &numeric_value)) {
+      entities->SetDouble(prop_key, row, numeric_value);
     } else {
       // String property
-      (*node->mutable_string_props())[prop_key] = InternString(pair.value);
+      entities->SetString(prop_key, row, Utf8Text(pair.value, &text));
     }
   }
-
-  // Store reference to node for lookups
-  nodes_by_handle_[entity.handle] = node;
-
-  // Update collection count
-  entity_collection.set_count(entity_collection.nodes_size());
 }
 
-void GraphBuilder::AddBlock(const parser::DXFBlock& block,
-                             finetoo::graph::v1::PropertyGraph* graph) {
-  // Get or create Block node collection
-  auto& block_collection = (*graph->mutable_nodes_by_type())["Block"];
-  auto* node = block_collection.mutable_nodes()->Add();
-
-  // Set node ID and type
-  node->set_id("block_" + block.name);
-  node->set_type("Block");
+void GraphBuilder::AddBlock(const parser::DXFBlockView& block,
+                            int64_t entity_count,
+                            absl::string_view content_hash,
+                            ColumnarGraph* graph) {
+  std::string scratch;
+  absl::string_view name = Utf8Text(block.name, &scratch);
+  NodeTable* blocks = graph->mutable_table("Block");
+  size_t row = blocks->AddRow(absl::StrCat("block_", name), block.handle);
 
   // Add basic properties
-  (*node->mutable_string_props())["name"] = InternString(block.name);
-  (*node->mutable_string_props())["handle"] = InternString(block.handle);
+  blocks->SetString("name", row, name);
 
   // Add entity count - this is computed, not from DXF
-  (*node->mutable_int_props())["entity_count"] = block.entities.size();
-
-  // TODO: Compute content_hash for divergence detection
-  // For now, use a placeholder
-  (*node->mutable_string_props())["content_hash"] = "HASH_PLACEHOLDER";
-
-  // Store reference to node for lookups
-  nodes_by_handle_["block_" + block.name] = node;
+  blocks->SetInt("entity_count", row, entity_count);
 
-  // Update collection count
-  block_collection.set_count(block_collection.nodes_size());
+  // Hash of the block's entities, for divergence detection
+  blocks->SetString("content_hash", row, content_hash);
 }
 
 }  // namespace finetoo::graph
@@ -3,21 +3,42 @@
 
 #pragma once
 
+#include <cstdint>
+#include <istream>
 #include <memory>
+#include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
-#include "google/protobuf/arena.h"
 #include "proto/graph.pb.h"
+#include "src/graph/columnar_graph.h"
+#include "src/graph/graph_handle.h"
+#include "src/graph/symbol_table.h"
 #include "src/parser/dxf_text_parser.h"
 
 namespace finetoo::graph {
 
+struct GraphBuildOptions {
+  // Threads used to build nodes and edges from a parsed drawing, and to
+  // export nodes to protos: 0 = one per hardware thread, 1 = build on the
+  // calling thread. Graphs are identical (file order) for any thread count.
+  int num_threads = 0;
+};
+
 // GraphBuilder converts DXF files to property graphs with operational metadata
-// Uses Protocol Buffer arena allocation for memory efficiency
+// Nodes are built in a ColumnarGraph; the PropertyGraph is exported from it
+// onto an arena
 class GraphBuilder {
  public:
   GraphBuilder();
+
+  // Builder whose ColumnarGraphs intern their strings in `symbols`, e.g. a
+  // table shared by the builders of a batch of drawings
+  explicit GraphBuilder(std::shared_ptr<SymbolTable> symbols);
+  explicit GraphBuilder(
+      GraphBuildOptions options,
+      std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>());
   ~GraphBuilder();
 
   // Non-copyable, movable
@@ -26,37 +47,99 @@ class GraphBuilder {
   GraphBuilder(GraphBuilder&&) = default;
   GraphBuilder& operator=(GraphBuilder&&) = default;
 
-  // Build property graph from parsed DXF file
-  absl::StatusOr<finetoo::graph::v1::PropertyGraph> Build(
-      const parser::DXFFile& dxf_file);
-
-  // Build property graph directly from DXF file path
-  absl::StatusOr<finetoo::graph::v1::PropertyGraph> BuildFromFile(
+  // Build property graph from parsed DXF file. Entities are built in
+  // ranges on separate threads, then joined in file order.
+  absl::StatusOr<GraphHandle> Build(const parser::DXFFile& dxf_file);
+
+  // Build property graph directly from a DXF file path or stream. Records
+  // are turned into nodes as they are tokenized, without a DXFFile in
+  // between; the result equals Build() of the parsed drawing.
+  absl::StatusOr<GraphHandle> BuildFromFile(absl::string_view file_path);
+  absl::StatusOr<GraphHandle> BuildFromStream(std::istream& input);
+
+  // Same, stopping short of exporting the nodes to protos, and with the
+  // edges indexed (ColumnarGraph::adjacency()). All graphs a builder
+  // returns share its SymbolTable.
+  absl::StatusOr<ColumnarGraph> BuildColumnar(const parser::DXFFile& dxf_file);
+  absl::StatusOr<ColumnarGraph> BuildColumnarFromFile(
       absl::string_view file_path);
 
+  // Bring `graph`, built from the drawing that DXFTextParser::Reparse()
+  // turned into `dxf_file`, up to date with it. Only the nodes and edges of
+  // the entities and blocks in `changes`' replaced runs are rebuilt (and
+  // the few Layer nodes); the result equals Build(dxf_file).
+  absl::Status Update(const parser::DXFFile& dxf_file,
+                      const parser::DXFChanges& changes,
+                      finetoo::graph::v1::PropertyGraph* graph);
+
  private:
-  // Arena for efficient protobuf allocation
-  std::unique_ptr<google::protobuf::Arena> arena_;
+  GraphBuildOptions options_;
+
+  // Layer node row by layer name
+  absl::flat_hash_map<std::string, size_t> layers_by_name_;
+
+  // Strings of the ColumnarGraphs returned
+  std::shared_ptr<SymbolTable> symbols_;
+
+  // DXFVisitor behind BuildFromFile() and BuildFromStream()
+  class GraphVisitor;
 
-  // String interning for deduplication
-  absl::flat_hash_map<std::string, absl::string_view> string_pool_;
+  // Clear the lookup above for a new graph
+  void Reset();
 
-  // Node lookup by handle
-  absl::flat_hash_map<std::string, finetoo::graph::v1::Node*> nodes_by_handle_;
+  // options_.num_threads, or the default
+  int NumThreads() const;
+
+  // Stream a drawing into `graph` with a GraphVisitor
+  absl::Status Stream(
+      absl::FunctionRef<absl::Status(parser::DXFVisitor&)> parse,
+      ColumnarGraph* graph);
+
+  // Add a drawing's nodes, edges, stats and metadata to an empty graph
+  void AddDrawing(const parser::DXFFile& dxf_file, ColumnarGraph* graph);
 
   // Add entity to graph
-  void AddEntity(const parser::DXFEntity& entity,
-                 finetoo::graph::v1::PropertyGraph* graph);
+  void AddEntity(const parser::DXFEntityView& entity, ColumnarGraph* graph);
+
+  // Add block to graph, with its ContentHasher hash
+  void AddBlock(const parser::DXFBlockView& block, int64_t entity_count,
+                absl::string_view content_hash, ColumnarGraph* graph);
+
+  // Add Layer node from a LAYER table record
+  void AddLayer(const parser::DXFEntityView& record, ColumnarGraph* graph);
+
+  // Add Layer nodes: LAYER table records, then layers only entities name
+  void AddLayerTable(const parser::DXFFile& dxf_file, ColumnarGraph* graph);
+  void AddLayers(const parser::DXFFile& dxf_file, ColumnarGraph* graph);
+
+  // Row of the Layer node for `name`, created bare if the LAYER table
+  // lacks it
+  size_t GetOrAddLayer(absl::string_view name, ColumnarGraph* graph);
+
+  // Add an entity's BELONGS_TO edge to its layer, and its REFERENCES edge
+  // to the block an INSERT names, if it has them
+  void AddLayerEdge(const parser::DXFEntityView& entity,
+                    finetoo::graph::v1::PropertyGraph* graph);
+  void AddReferenceEdge(const parser::DXFEntityView& entity,
+                        finetoo::graph::v1::PropertyGraph* graph);
+
+  // Add the CONTAINS edge from block `block_name` to the block an INSERT
+  // among its entities places, if `entity` is one
+  void AddContainsEdge(absl::string_view block_name,
+                       const parser::DXFEntityView& entity,
+                       finetoo::graph::v1::PropertyGraph* graph);
 
-  // Add block to graph
-  void AddBlock(const parser::DXFBlock& block,
-                finetoo::graph::v1::PropertyGraph* graph);
+  // Fill in graph.stats from its nodes and edges
+  void ComputeStats(finetoo::graph::v1::PropertyGraph* graph);
+  void ComputeStats(ColumnarGraph* graph);
 
-  // Intern string (deduplicate)
-  absl::string_view InternString(absl::string_view str);
+  // Set the schema and metadata of a graph of a drawing
+  void SetMetadata(absl::string_view version, size_t entity_count,
+                   size_t block_count,
+                   finetoo::graph::v1::PropertyGraph* graph);
 
   // Create schema for DXF graph
-  finetoo::graph::v1::Schema CreateSchema(const parser::DXFFile& dxf_file);
+  finetoo::graph::v1::Schema CreateSchema(absl::string_view version);
 };
 
 }  // namespace finetoo::graph
@@ -0,0 +1,243 @@
+// Copyright 2025 Finetoo
+// GraphBuilder Tests
+
+#include "src/graph/graph_builder.h"
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "google/protobuf/util/message_differencer.h"
+
+namespace finetoo::graph {
+namespace {
+
+// Drawing with a LAYER table, `count` / 10 blocks, each after the first
+// nesting the one before, and `count` entities, every tenth an INSERT of
+// one of the blocks
+std::string MakeDXF(int count) {
+  std::string dxf =
+      "  0\nSECTION\n  2\nHEADER\n  9\n$ACADVER\n  1\nAC1009\n  0\nENDSEC\n"
+      "  0\nSECTION\n  2\nTABLES\n  0\nTABLE\n  2\nLAYER\n 70\n     1\n"
+      "  0\nLAYER\n  5\nA\n  2\nWALLS\n 70\n     4\n 62\n    -3\n"
+      "  0\nENDTAB\n  0\nENDSEC\n  0\nSECTION\n  2\nBLOCKS\n";
+  for (int i = 0; i < count / 10; i++) {
+    absl::StrAppend(&dxf, "  0\nBLOCK\n  5\nB", i, "\n  8\n0\n  2\nPART", i,
+                    "\n  0\nCIRCLE\n  8\n0\n 40\n1.0\n");
+    if (i > 0) {
+      absl::StrAppend(&dxf, "  0\nINSERT\n  5\nC", i, "\n  8\n0\n  2\nPART",
+                      i - 1, "\n");
+    }
+    absl::StrAppend(&dxf, "  0\nENDBLK\n");
+  }
+  absl::StrAppend(&dxf, "  0\nENDSEC\n  0\nSECTION\n  2\nENTITIES\n");
+  for (int i = 0; i < count; i++) {
+    if (i % 10 == 0) {
+      absl::StrAppend(&dxf, "  0\nINSERT\n  5\n", 1000 + i, "\n  8\nWALLS\n",
+                      "  2\nPART", i / 10, "\n 10\n", i, "\n 20\n0\n");
+    } else {
+      absl::StrAppend(&dxf, "  0\nLINE\n  5\n", 1000 + i, "\n  8\n",
+                      i % 3 == 0 ? "WALLS" : "GEOMETRY", "\n 10\n", i,
+                      "\n 20\n0\n 11\n", i + 1, "\n 21\n1\n");
+    }
+  }
+  absl::StrAppend(&dxf, "  0\nENDSEC\n  0\nEOF\n");
+  return dxf;
+}
+
+parser::DXFParseOptions TrackChanges() {
+  parser::DXFParseOptions options;
+  options.track_changes = true;
+  return options;
+}
+
+class GraphBuilderTest : public ::testing::Test {
+ protected:
+  parser::DXFTextParser parser_{TrackChanges()};
+  GraphBuilder builder_;
+};
+
+TEST_F(GraphBuilderTest, BuildsLayersAndEdges) {
+  auto file_or = parser_.Parse(parser::DXFBuffer::FromString(MakeDXF(100)));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  auto graph_or = builder_.Build(*file_or);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+
+  const auto& stats = (*graph_or)->stats();
+  EXPECT_EQ(stats.nodes_per_type().at("Entity"), 100);
+  EXPECT_EQ(stats.nodes_per_type().at("Block"), 10);
+  EXPECT_EQ(stats.nodes_per_type().at("Layer"), 2);
+  EXPECT_EQ(stats.edges_per_type().at("BELONGS_TO"), 100);
+  EXPECT_EQ(stats.edges_per_type().at("REFERENCES"), 10);
+  EXPECT_EQ(stats.edges_per_type().at("CONTAINS"), 9);
+
+  const auto& walls = (*graph_or)->nodes_by_type().at("Layer").nodes(0);
+  EXPECT_EQ(walls.id(), "layer_WALLS");
+  EXPECT_EQ(walls.handle(), 0xA);
+  EXPECT_EQ(walls.int_props().at("color"), 3);
+  EXPECT_TRUE(walls.bool_props().at("off"));
+  EXPECT_TRUE(walls.bool_props().at("locked"));
+
+  const auto& contains = (*graph_or)->edges(110);
+  EXPECT_EQ(contains.type(), "CONTAINS");
+  EXPECT_EQ(contains.source_node_id(), "block_PART1");
+  EXPECT_EQ(contains.target_node_id(), "block_PART0");
+  EXPECT_EQ(contains.properties().at("insert_handle"), "C1");
+}
+
+TEST_F(GraphBuilderTest, IndexesColumnarEdges) {
+  auto file_or = parser_.Parse(parser::DXFBuffer::FromString(MakeDXF(100)));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  auto graph_or = builder_.BuildColumnar(*file_or);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+
+  // Nested blocks expand through CONTAINS, INSERTs lead in by REFERENCES
+  const AdjacencyIndex& adjacency = graph_or->adjacency();
+  auto part5 = adjacency.FindNode("block_PART5");
+  ASSERT_TRUE(part5.has_value());
+  auto nested = adjacency.OutEdges("CONTAINS", *part5);
+  ASSERT_EQ(nested.size(), 1);
+  EXPECT_EQ(adjacency.target(nested[0]), adjacency.FindNode("block_PART4"));
+  auto inserts = adjacency.InEdges("REFERENCES", *part5);
+  ASSERT_EQ(inserts.size(), 1);
+  EXPECT_EQ(adjacency.source(inserts[0]), adjacency.FindNode(0x1050));
+  EXPECT_EQ(adjacency.Edges("BELONGS_TO").size(), 100);
+}
+
+TEST_F(GraphBuilderTest, ParsesNumericGroupCodesLikeStod) {
+  std::string dxf =
+      "  0\nSECTION\n  2\nENTITIES\n  0\nLINE\n  5\n10\n  8\n0\n"
+      " 10\n+2.5\n 20\n-1e2\n 30\n7.5mm\n 11\nabc\n 21\n1e999\n"
+      " 31\n-+1\n 39\n0x10\n 40\n.25\n 62\n256\n1001\nAPP\n"
+      "  0\nENDSEC\n  0\nEOF\n";
+  auto file_or = parser_.Parse(parser::DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  auto graph_or = builder_.Build(*file_or);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+
+  const auto& line = (*graph_or)->nodes_by_type().at("Entity").nodes(0);
+  EXPECT_EQ(line.numeric_props().at("gc_10"), 2.5);
+  EXPECT_EQ(line.numeric_props().at("gc_20"), -100);
+  EXPECT_EQ(line.numeric_props().at("gc_30"), 7.5);  // Leading number
+  EXPECT_EQ(line.numeric_props().at("gc_40"), 0.25);
+  EXPECT_EQ(line.string_props().at("gc_11"), "abc");
+  EXPECT_EQ(line.string_props().at("gc_21"), "1e999");  // Out of range
+  EXPECT_EQ(line.string_props().at("gc_31"), "-+1");
+  EXPECT_EQ(line.string_props().at("gc_39"), "0x10");
+  EXPECT_EQ(line.string_props().at("gc_62"), "256");
+  EXPECT_EQ(line.string_props().at("gc_1001"), "APP");
+}
+
+TEST_F(GraphBuilderTest, ReadsNonUtf8TextAsWindows1252) {
+  std::string dxf =
+      "  0\nSECTION\n  2\nENTITIES\n  0\nTEXT\n  5\n10\n  8\nM\xfc"
+      "ller\n  1\n\xb1\x31/8\x94\n  3\nd\xc3\xa9j\xc3\xa0\n"
+      "  0\nENDSEC\n  0\nEOF\n";
+  auto file_or = parser_.Parse(parser::DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  auto graph_or = builder_.Build(*file_or);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+
+  const auto& text = (*graph_or)->nodes_by_type().at("Entity").nodes(0);
+  EXPECT_EQ(text.string_props().at("layer"), "Müller");
+  EXPECT_EQ(text.string_props().at("gc_1"), "±1/8”");
+  EXPECT_EQ(text.string_props().at("gc_3"), "déjà");  // UTF-8
+  EXPECT_EQ((*graph_or)->edges(0).target_node_id(), "layer_Müller");
+}
+
+TEST_F(GraphBuilderTest, StreamedBuildMatchesBuild) {
+  std::string dxf = MakeDXF(1000);
+  auto file_or = parser_.Parse(parser::DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  auto expected_or = builder_.Build(*file_or);
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+
+  std::istringstream input(dxf);
+  auto graph_or = builder_.BuildFromStream(input);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+
+  std::string differences;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&differences);
+  EXPECT_TRUE(differencer.Compare(**graph_or, **expected_or)) << differences;
+}
+
+TEST_F(GraphBuilderTest, BuildsTheSameGraphOnAnyThreadCount) {
+  auto file_or = parser_.Parse(parser::DXFBuffer::FromString(MakeDXF(20000)));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  GraphBuilder sequential(GraphBuildOptions{.num_threads = 1});
+  GraphBuilder parallel(GraphBuildOptions{.num_threads = 8});
+
+  auto expected_or = sequential.Build(*file_or);
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+  auto graph_or = parallel.Build(*file_or);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+  std::string differences;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&differences);
+  EXPECT_TRUE(differencer.Compare(**graph_or, **expected_or)) << differences;
+
+  // Strings are interned in the same order too
+  auto expected_columns_or = sequential.BuildColumnar(*file_or);
+  ASSERT_TRUE(expected_columns_or.ok()) << expected_columns_or.status();
+  auto columns_or = parallel.BuildColumnar(*file_or);
+  ASSERT_TRUE(columns_or.ok()) << columns_or.status();
+  const NodeTable* expected = expected_columns_or->table("Entity");
+  const NodeTable* entities = columns_or->table("Entity");
+  ASSERT_EQ(entities->size(), 20000);
+  EXPECT_EQ(entities->strings("gc_5")->values,
+            expected->strings("gc_5")->values);
+  EXPECT_EQ(entities->doubles("gc_10")->values,
+            expected->doubles("gc_10")->values);
+}
+
+TEST_F(GraphBuilderTest, UpdateMatchesRebuild) {
+  std::string dxf = MakeDXF(1000);
+  auto previous_or = parser_.Parse(parser::DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(previous_or.ok()) << previous_or.status();
+  auto graph_or = builder_.Build(*previous_or);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+
+  // Retarget an INSERT, move a LINE to a layer without a table entry, drop
+  // a LINE and rename a block
+  std::string edited = absl::StrReplaceAll(
+      dxf, {{"  2\nPART50\n 10\n500\n", "  2\nPART7\n 10\n500\n"},
+            {"  5\n1502\n  8\nGEOMETRY\n", "  5\n1502\n  8\nNEW\n"},
+            {"  0\nLINE\n  5\n1503\n  8\nGEOMETRY\n 10\n503\n 20\n0\n"
+             " 11\n504\n 21\n1\n",
+             ""},
+            {"PART60\n  0\nCIRCLE", "PART60X\n  0\nCIRCLE"}});
+  ASSERT_NE(edited.size(), dxf.size());
+
+  parser::DXFChanges changes;
+  auto file_or = parser_.Reparse(
+      *previous_or, parser::DXFBuffer::FromString(edited), &changes);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  EXPECT_EQ(changes.entities.prefix, 500);
+  EXPECT_EQ(changes.entities.suffix, 496);
+  EXPECT_EQ(changes.blocks.prefix + changes.blocks.suffix, 99);
+
+  auto& graph = **graph_or;
+  auto status = builder_.Update(*file_or, changes, &graph);
+  ASSERT_TRUE(status.ok()) << status;
+
+  auto expected_or = GraphBuilder().Build(*file_or);
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+  std::string differences;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&differences);
+  EXPECT_TRUE(differencer.Compare(graph, **expected_or)) << differences;
+  EXPECT_EQ(graph.nodes_by_type().at("Layer").nodes_size(), 3);
+
+  // A graph of some other drawing is refused
+  auto other_or = builder_.Build(parser::DXFFile());
+  ASSERT_TRUE(other_or.ok()) << other_or.status();
+  status = builder_.Update(*file_or, changes, other_or->get());
+  EXPECT_TRUE(absl::IsFailedPrecondition(status)) << status;
+}
+
+}  // namespace
+}  // namespace finetoo::graph
@@ -0,0 +1,155 @@
+// Copyright 2025 Finetoo
+// Graph Cache Implementation
+
+#include "src/graph/graph_cache.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <ostream>
+#include <system_error>
+#include <utility>
+
+#include "absl/numeric/int128.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "src/common/file_util.h"
+#include "src/graph/content_hash.h"
+#include "src/graph/graph_snapshot.h"
+#include "src/parser/dxf_buffer.h"
+#include "src/parser/dxf_text_parser.h"
+
+namespace finetoo::graph {
+
+namespace {
+
+// Record which file, with which bytes, a graph was built from, and when
+void SetSource(absl::string_view file_path, absl::string_view file_hash,
+               finetoo::graph::v1::PropertyGraph* graph) {
+  graph->set_source_file_path(std::string(file_path));
+  graph->set_source_file_hash(std::string(file_hash));
+  graph->set_parse_timestamp_ms(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+}  // namespace
+
+GraphCache::GraphCache(std::string directory)
+    : directory_(std::move(directory)) {}
+
+std::string GraphCache::DefaultDirectory() {
+  if (const char* directory = std::getenv("FINETOO_GRAPH_CACHE")) {
+    return directory;
+  }
+  const char* home = std::getenv("HOME");
+  if (home == nullptr || *home == '\0') return "";
+  return absl::StrCat(home, "/.cache/finetoo/graphs");
+}
+
+std::string GraphCache::HashContents(absl::string_view contents) {
+  absl::uint128 hash = MurmurHash3(contents);
+  return absl::StrFormat("%016x%016x", absl::Uint128High64(hash),
+                         absl::Uint128Low64(hash));
+}
+
+std::string GraphCache::EntryPath(absl::string_view file_hash) const {
+  return absl::StrCat(directory_, "/", file_hash, "-v", kFormatVersion,
+                      ".pb");
+}
+
+std::string GraphCache::SnapshotPath(absl::string_view file_hash) const {
+  return absl::StrCat(directory_, "/", file_hash, "-v", kFormatVersion,
+                      ".graph");
+}
+
+absl::StatusOr<GraphHandle> GraphCache::Load(absl::string_view file_path,
+                                             GraphBuilder* builder) {
+  // The drawing is mapped once, for its hash and for the parse if needed
+  auto buffer_or = parser::DXFBuffer::Map(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
+  std::string file_hash = HashContents((*buffer_or)->contents());
+
+  if (!directory_.empty()) {
+    // An entry that doesn't parse, or holds another file's graph, is
+    // rebuilt and replaced
+    auto entry_or = parser::DXFBuffer::Map(EntryPath(file_hash));
+    if (entry_or.ok()) {
+      GraphHandle graph;
+      absl::string_view entry = (*entry_or)->contents();
+      if (graph->ParseFromArray(entry.data(), entry.size()) &&
+          graph->source_file_hash() == file_hash) {
+        graph->set_source_file_path(std::string(file_path));
+        hits_++;
+        return graph;
+      }
+    }
+  }
+
+  misses_++;
+  auto dxf_file_or = parser::DXFTextParser().Parse(*std::move(buffer_or));
+  if (!dxf_file_or.ok()) return dxf_file_or.status();
+  auto graph_or = builder->Build(*dxf_file_or);
+  if (!graph_or.ok()) return graph_or.status();
+
+  SetSource(file_path, file_hash, graph_or->get());
+  if (!directory_.empty()) Store(file_hash, **graph_or).IgnoreError();
+  return graph_or;
+}
+
+absl::StatusOr<ColumnarGraph> GraphCache::LoadColumnar(
+    absl::string_view file_path, GraphBuilder* builder) {
+  auto buffer_or = parser::DXFBuffer::Map(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
+  std::string file_hash = HashContents((*buffer_or)->contents());
+
+  if (!directory_.empty()) {
+    // As in Load(), a snapshot that doesn't open, or holds another file's
+    // graph, is rebuilt and replaced
+    auto graph_or = GraphSnapshot::Open(SnapshotPath(file_hash));
+    if (graph_or.ok() && graph_or->graph().source_file_hash() == file_hash) {
+      graph_or->mutable_graph()->set_source_file_path(std::string(file_path));
+      hits_++;
+      return graph_or;
+    }
+  }
+
+  misses_++;
+  auto dxf_file_or = parser::DXFTextParser().Parse(*std::move(buffer_or));
+  if (!dxf_file_or.ok()) return dxf_file_or.status();
+  auto graph_or = builder->BuildColumnar(*dxf_file_or);
+  if (!graph_or.ok()) return graph_or.status();
+
+  SetSource(file_path, file_hash, graph_or->mutable_graph());
+  if (!directory_.empty()) StoreSnapshot(file_hash, *graph_or).IgnoreError();
+  return graph_or;
+}
+
+absl::Status GraphCache::Store(absl::string_view file_hash,
+                               const finetoo::graph::v1::PropertyGraph& graph) {
+  absl::Status status = CreateDirectory();
+  if (!status.ok()) return status;
+  return common::WriteFileAtomically(
+      EntryPath(file_hash),
+      [&](std::ostream& out) { return graph.SerializeToOstream(&out); });
+}
+
+absl::Status GraphCache::StoreSnapshot(absl::string_view file_hash,
+                                       const ColumnarGraph& graph) {
+  absl::Status status = CreateDirectory();
+  if (!status.ok()) return status;
+  return GraphSnapshot::Write(graph, SnapshotPath(file_hash));
+}
+
+absl::Status GraphCache::CreateDirectory() const {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to create directory: ", directory_, ": ", error.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace finetoo::graph
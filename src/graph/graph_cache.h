@@ -0,0 +1,84 @@
+// Copyright 2025 Finetoo
+// Graph Cache - Built graphs saved on disk, keyed by drawing contents
+//
+// Building a graph means parsing the whole drawing. A GraphCache keeps
+// each graph it builds as a serialized PropertyGraph in a directory, named
+// by a hash of the drawing's bytes and kFormatVersion. Loading a drawing
+// whose bytes were seen before reads that file instead of parsing. An
+// edited drawing hashes differently and a new format version names entries
+// differently, so stale entries are never read; they are only left behind.
+//
+// LoadColumnar() keeps a GraphSnapshot of the graph instead, and opens a
+// cached one in place: its arrays view the mapped entry, so a warm load
+// reads only the pages that operations on the graph touch.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "src/graph/columnar_graph.h"
+#include "src/graph/graph_builder.h"
+#include "src/graph/graph_handle.h"
+
+namespace finetoo::graph {
+
+class GraphCache {
+ public:
+  // Bump whenever the graphs GraphBuilder builds for a drawing change
+  // (parser, builder or schema), so entries of earlier builds go unused
+  static constexpr int kFormatVersion = 1;
+
+  // Cache in `directory`, created on first store. An empty directory
+  // disables caching: every Load() builds.
+  explicit GraphCache(std::string directory);
+
+  // $FINETOO_GRAPH_CACHE if set (empty to disable), else
+  // $HOME/.cache/finetoo/graphs
+  static std::string DefaultDirectory();
+
+  // Graph of the drawing at `file_path`: read from the cache if it holds
+  // one for the file's current bytes, else parsed, built with `builder`
+  // and stored. Built graphs get source_file_path, source_file_hash and
+  // parse_timestamp_ms. A cache that can't be written to still builds.
+  absl::StatusOr<GraphHandle> Load(absl::string_view file_path,
+                                   GraphBuilder* builder);
+
+  // As Load(), as columns: a cached snapshot is opened mapped, for as
+  // long as the graph lives, else the graph is built with
+  // GraphBuilder::BuildColumnar() and stored as a snapshot
+  absl::StatusOr<ColumnarGraph> LoadColumnar(absl::string_view file_path,
+                                             GraphBuilder* builder);
+
+  // Save a graph of a file whose bytes hash to `file_hash`
+  absl::Status Store(absl::string_view file_hash,
+                     const finetoo::graph::v1::PropertyGraph& graph);
+  absl::Status StoreSnapshot(absl::string_view file_hash,
+                             const ColumnarGraph& graph);
+
+  // Hash of a drawing's bytes (MurmurHash3 x64-128, 32 hex digits), as
+  // source_file_hash holds it
+  static std::string HashContents(absl::string_view contents);
+
+  // File an entry is kept in, and a snapshot entry
+  std::string EntryPath(absl::string_view file_hash) const;
+  std::string SnapshotPath(absl::string_view file_hash) const;
+
+  const std::string& directory() const { return directory_; }
+
+  // Loads served from the cache, and built
+  size_t hits() const { return hits_; }
+  size_t misses() const { return misses_; }
+
+ private:
+  absl::Status CreateDirectory() const;
+
+  std::string directory_;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+};
+
+}  // namespace finetoo::graph
@@ -0,0 +1,101 @@
+// Copyright 2025 Finetoo
+// GraphCache Tests
+
+#include "src/graph/graph_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "google/protobuf/util/message_differencer.h"
+#include "src/graph/test_drawings.h"
+
+namespace finetoo::graph {
+namespace {
+
+void WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+TEST(GraphCacheTest, LoadsUnchangedDrawingsFromCache) {
+  std::string directory = ::testing::TempDir() + "/graph_cache_test";
+  std::filesystem::remove_all(directory);
+  std::string path = ::testing::TempDir() + "/graph_cache_test.dxf";
+  WriteFile(path, kPartDrawing);
+
+  GraphCache cache(directory + "/graphs");
+  GraphBuilder builder;
+  auto built_or = cache.Load(path, &builder);
+  ASSERT_TRUE(built_or.ok()) << built_or.status();
+  EXPECT_EQ((*built_or)->source_file_path(), path);
+  EXPECT_EQ((*built_or)->source_file_hash(),
+            GraphCache::HashContents(kPartDrawing));
+  EXPECT_GT((*built_or)->parse_timestamp_ms(), 0);
+
+  auto cached_or = cache.Load(path, &builder);
+  ASSERT_TRUE(cached_or.ok()) << cached_or.status();
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+      **cached_or, **built_or));
+
+  // An edited drawing is rebuilt; a damaged entry is replaced
+  std::string edited = kPartDrawing;
+  edited.replace(edited.find("WALLS"), 5, "DOORS");
+  WriteFile(path, edited);
+  auto edited_or = cache.Load(path, &builder);
+  ASSERT_TRUE(edited_or.ok()) << edited_or.status();
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_NE((*edited_or)->source_file_hash(), (*built_or)->source_file_hash());
+
+  WriteFile(cache.EntryPath((*edited_or)->source_file_hash()), "damaged");
+  ASSERT_TRUE(cache.Load(path, &builder).ok());
+  ASSERT_TRUE(cache.Load(path, &builder).ok());
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 3);
+
+  // With no directory every load builds
+  GraphCache disabled("");
+  ASSERT_TRUE(disabled.Load(path, &builder).ok());
+  ASSERT_TRUE(disabled.Load(path, &builder).ok());
+  EXPECT_EQ(disabled.misses(), 2);
+  EXPECT_FALSE(std::filesystem::exists(disabled.EntryPath("x")));
+}
+
+TEST(GraphCacheTest, OpensCachedSnapshotsInPlace) {
+  std::string directory = ::testing::TempDir() + "/graph_cache_test";
+  std::filesystem::remove_all(directory);
+  std::string path = ::testing::TempDir() + "/graph_cache_test.dxf";
+  WriteFile(path, kPartDrawing);
+
+  GraphCache cache(directory + "/graphs");
+  GraphBuilder builder;
+  auto built_or = cache.LoadColumnar(path, &builder);
+  ASSERT_TRUE(built_or.ok()) << built_or.status();
+  std::string file_hash = GraphCache::HashContents(kPartDrawing);
+  EXPECT_EQ(built_or->graph().source_file_hash(), file_hash);
+  EXPECT_TRUE(std::filesystem::exists(cache.SnapshotPath(file_hash)));
+
+  auto opened_or = cache.LoadColumnar(path, &builder);
+  ASSERT_TRUE(opened_or.ok()) << opened_or.status();
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(opened_or->graph().source_file_path(), path);
+  EXPECT_EQ(opened_or->table("Entity")->size(), 1);
+  EXPECT_EQ(opened_or->table("Entity")->NodeId(0), "1A");
+  EXPECT_EQ(opened_or->edges().size(), built_or->edges().size());
+  EXPECT_EQ(opened_or->adjacency().node_count(),
+            built_or->adjacency().node_count());
+
+  // A damaged snapshot is rebuilt and replaced
+  WriteFile(cache.SnapshotPath(file_hash), "damaged");
+  ASSERT_TRUE(cache.LoadColumnar(path, &builder).ok());
+  ASSERT_TRUE(cache.LoadColumnar(path, &builder).ok());
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 2);
+}
+
+}  // namespace
+}  // namespace finetoo::graph
@@ -0,0 +1,18 @@
+// Copyright 2025 Finetoo
+// Graph Handle Implementation
+
+#include "src/graph/graph_handle.h"
+
+namespace finetoo::graph {
+
+GraphHandle::GraphHandle() {
+  // Large graphs take hundreds of megabytes: grow to bigger blocks than
+  // the default
+  google::protobuf::ArenaOptions options;
+  options.max_block_size = 1 << 20;
+  arena_ = std::make_unique<google::protobuf::Arena>(options);
+  graph_ = google::protobuf::Arena::Create<finetoo::graph::v1::PropertyGraph>(
+      arena_.get());
+}
+
+}  // namespace finetoo::graph
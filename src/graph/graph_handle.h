@@ -0,0 +1,42 @@
+// Copyright 2025 Finetoo
+// Graph Handle - A PropertyGraph that owns the arena it lives on
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "google/protobuf/arena.h"
+#include "proto/graph.pb.h"
+
+namespace finetoo::graph {
+
+// A PropertyGraph on a protobuf arena of its own. Its nodes, edges and
+// their maps are bump-allocated there and all freed at once with the
+// handle. Movable, not copyable; dereferences to the graph.
+class GraphHandle {
+ public:
+  GraphHandle();
+  GraphHandle(GraphHandle&& other) noexcept
+      : arena_(std::move(other.arena_)),
+        graph_(std::exchange(other.graph_, nullptr)) {}
+  GraphHandle& operator=(GraphHandle&& other) noexcept {
+    arena_ = std::move(other.arena_);
+    graph_ = std::exchange(other.graph_, nullptr);
+    return *this;
+  }
+
+  finetoo::graph::v1::PropertyGraph* get() const { return graph_; }
+  finetoo::graph::v1::PropertyGraph& operator*() const { return *graph_; }
+  finetoo::graph::v1::PropertyGraph* operator->() const { return graph_; }
+
+  // Bytes the arena holds
+  uint64_t SpaceAllocated() const { return arena_->SpaceAllocated(); }
+
+ private:
+  std::unique_ptr<google::protobuf::Arena> arena_;
+  finetoo::graph::v1::PropertyGraph* graph_;  // Owned by arena_
+};
+
+}  // namespace finetoo::graph
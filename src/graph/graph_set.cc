@@ -0,0 +1,88 @@
+// Copyright 2025 Finetoo
+// Graph Set Implementation
+
+#include "src/graph/graph_set.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace finetoo::graph {
+
+using ::finetoo::graph::v1::PropertyMetadata;
+
+finetoo::graph::v1::Schema GraphSet::Schema() const {
+  finetoo::graph::v1::Schema schema;
+  if (members_.empty()) return schema;
+
+  // Types and properties in order of first appearance, described as the
+  // first member describing them does
+  schema = members_[0].graph->schema();
+  schema.clear_node_types();
+  schema.clear_edge_types();
+  absl::flat_hash_map<std::string, int> node_types;
+  absl::flat_hash_set<std::pair<std::string, std::string>> properties;
+  absl::flat_hash_set<std::pair<std::string, std::string>> unique_properties;
+  absl::flat_hash_set<std::string> edge_types;
+  for (const Member& member : members_) {
+    const auto& member_schema = member.graph->schema();
+    if (member_schema.format_version() != schema.format_version()) {
+      schema.clear_format_version();  // Drawings of several versions
+    }
+    for (const auto& node_type : member_schema.node_types()) {
+      auto [it, inserted] =
+          node_types.emplace(node_type.name(), schema.node_types_size());
+      auto* merged = inserted ? schema.add_node_types()
+                              : schema.mutable_node_types(it->second);
+      if (inserted) merged->set_name(node_type.name());
+      for (const auto& property : node_type.properties()) {
+        if (properties.emplace(node_type.name(), property.name()).second) {
+          *merged->add_properties() = property;
+        }
+      }
+      for (const auto& unique : node_type.unique_properties()) {
+        if (unique_properties.emplace(node_type.name(), unique).second) {
+          merged->add_unique_properties(unique);
+        }
+      }
+    }
+    for (const auto& edge_type : member_schema.edge_types()) {
+      if (edge_types.insert(edge_type.name()).second) {
+        *schema.add_edge_types() = edge_type;
+      }
+    }
+  }
+
+  for (auto& node_type : *schema.mutable_node_types()) {
+    std::pair<std::string, std::string> key(node_type.name(),
+                                            kDrawingProperty);
+    if (properties.contains(key)) continue;
+    auto* drawing = node_type.add_properties();
+    drawing->set_name(std::string(kDrawingProperty));
+    drawing->set_type(PropertyMetadata::STRING);
+    drawing->set_indexed(true);
+  }
+  return schema;
+}
+
+finetoo::graph::v1::GraphStats GraphSet::Stats() const {
+  finetoo::graph::v1::GraphStats stats;
+  for (const Member& member : members_) {
+    const auto& member_stats = member.graph->stats();
+    stats.set_node_count(stats.node_count() + member_stats.node_count());
+    stats.set_edge_count(stats.edge_count() + member_stats.edge_count());
+    stats.set_estimated_memory_bytes(stats.estimated_memory_bytes() +
+                                     member_stats.estimated_memory_bytes());
+    for (const auto& [type, count] : member_stats.nodes_per_type()) {
+      (*stats.mutable_nodes_per_type())[type] += count;
+    }
+    for (const auto& [type, count] : member_stats.edges_per_type()) {
+      (*stats.mutable_edges_per_type())[type] += count;
+    }
+  }
+  return stats;
+}
+
+}  // namespace finetoo::graph
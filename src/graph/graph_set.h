@@ -0,0 +1,71 @@
+// Copyright 2025 Finetoo
+// Graph Set - Graphs of several drawings, used as one
+//
+// Analyzing many drawings together needn't merge them into one graph:
+// merging copies every node and stamps each with the drawing it came
+// from. A GraphSet keeps each drawing's graph as it was built or loaded,
+// moved in rather than copied, and names it by its drawing. The drawing
+// is a virtual column, kDrawingProperty, that every node of a member
+// reads as the member's name without storing it. Schema() and Stats()
+// describe the members as one graph; OperationExecutor runs operations
+// on each member and combines the results.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "proto/graph.pb.h"
+#include "src/graph/graph_handle.h"
+
+namespace finetoo::graph {
+
+class GraphSet {
+ public:
+  // Virtual property holding each node's drawing
+  static constexpr absl::string_view kDrawingProperty = "source_drawing";
+
+  struct Member {
+    std::string drawing;
+    GraphHandle graph;
+  };
+
+  GraphSet() = default;
+  GraphSet(GraphSet&&) = default;
+  GraphSet& operator=(GraphSet&&) = default;
+
+  // Add the graph of `drawing`, after those added before
+  void Add(std::string drawing, GraphHandle graph) {
+    members_.push_back({std::move(drawing), std::move(graph)});
+  }
+
+  size_t size() const { return members_.size(); }
+  bool empty() const { return members_.empty(); }
+  const Member& member(size_t index) const { return members_[index]; }
+  const std::vector<Member>& members() const { return members_; }
+
+  // Node and edge types of all members, merged by name, properties
+  // merged by name; each node type has kDrawingProperty too
+  finetoo::graph::v1::Schema Schema() const;
+
+  // Counts summed over members
+  finetoo::graph::v1::GraphStats Stats() const;
+
+  // Call f(drawing, node) for each node of `type`, member by member
+  template <typename F>
+  void ForEachNode(absl::string_view type, F f) const {
+    for (const Member& member : members_) {
+      auto it = member.graph->nodes_by_type().find(std::string(type));
+      if (it == member.graph->nodes_by_type().end()) continue;
+      for (const auto& node : it->second.nodes()) f(member.drawing, node);
+    }
+  }
+
+ private:
+  std::vector<Member> members_;
+};
+
+}  // namespace finetoo::graph
@@ -0,0 +1,67 @@
+// Copyright 2025 Finetoo
+// GraphSet Tests
+
+#include "src/graph/graph_set.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/graph/test_drawings.h"
+
+namespace finetoo::graph {
+namespace {
+
+TEST(GraphSetTest, DescribesMembersAsOneGraph) {
+  GraphSet graphs;
+  auto first_or = BuildGraph(kPartDrawing);
+  ASSERT_TRUE(first_or.ok()) << first_or.status();
+  const v1::PropertyGraph* first_graph = first_or->get();
+  graphs.Add("A.dxf", *std::move(first_or));
+  std::string second = kPartDrawing;
+  second.replace(second.find("  0\nENDSEC\n  0\nEOF"), 0,
+                 "  0\nINSERT\n  5\n1B\n  8\nWALLS\n  2\nPART\n");
+  auto second_or = BuildGraph(second);
+  ASSERT_TRUE(second_or.ok()) << second_or.status();
+  graphs.Add("B.dxf", *std::move(second_or));
+
+  // Members are held as added
+  ASSERT_EQ(graphs.size(), 2);
+  EXPECT_EQ(graphs.member(0).graph.get(), first_graph);
+  EXPECT_EQ(graphs.member(1).drawing, "B.dxf");
+
+  v1::GraphStats stats = graphs.Stats();
+  EXPECT_EQ(stats.node_count(),
+            graphs.member(0).graph->stats().node_count() +
+                graphs.member(1).graph->stats().node_count());
+  EXPECT_EQ(stats.nodes_per_type().at("Entity"), 3);
+
+  // Types appear once, each with the drawing column
+  v1::Schema schema = graphs.Schema();
+  int entity_types = 0;
+  for (const auto& node_type : schema.node_types()) {
+    if (node_type.name() != "Entity") continue;
+    entity_types++;
+    int drawing = 0, handle = 0;
+    for (const auto& property : node_type.properties()) {
+      drawing += property.name() == GraphSet::kDrawingProperty;
+      handle += property.name() == "handle";
+    }
+    EXPECT_EQ(drawing, 1);
+    EXPECT_EQ(handle, 1);
+  }
+  EXPECT_EQ(entity_types, 1);
+
+  std::vector<std::string> drawings;
+  graphs.ForEachNode("Entity", [&](const std::string& drawing,
+                                   const v1::Node& node) {
+    drawings.push_back(drawing + ":" + node.string_props().at("type"));
+  });
+  EXPECT_EQ(drawings, (std::vector<std::string>{
+                          "A.dxf:INSERT", "B.dxf:INSERT", "B.dxf:INSERT"}));
+}
+
+}  // namespace
+}  // namespace finetoo::graph
@@ -0,0 +1,571 @@
+// Copyright 2025 Finetoo
+// Graph Snapshot Implementation
+
+#include "src/graph/graph_snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "src/common/file_util.h"
+#include "src/parser/dxf_buffer.h"
+
+namespace finetoo::graph {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'T', 'G', 'R', 'A', 'P', 'H', '\0'};
+
+// Reads back as another value on a host of the other byte order
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+constexpr uint32_t kNoSymbol = ~uint32_t{0};
+
+// An array: offset in the file, and number of values
+struct Block {
+  uint64_t offset;
+  uint64_t count;
+};
+
+enum ColumnKind : uint32_t {
+  kStrings = 0,
+  kDoubles = 1,
+  kInts = 2,
+  kBools = 3,
+};
+
+struct ColumnRecord {
+  uint32_t name;  // Symbol; unset for an ID or edge column
+  uint32_t kind;
+  Block values;
+  Block present;
+};
+
+struct TableRecord {
+  uint32_t type;  // Symbol
+  uint32_t reserved;
+  Block handles;
+  ColumnRecord ids;
+  Block columns;  // ColumnRecords
+};
+
+struct EdgeTableRecord {
+  ColumnRecord types;
+  ColumnRecord ids;
+  ColumnRecord source_ids;
+  ColumnRecord target_ids;
+  Block source_handles;
+  Block target_handles;
+  ColumnRecord weights;
+  Block properties;  // ColumnRecords
+};
+
+struct TypeIndexRecord {
+  uint32_t type;  // Symbol
+  uint32_t reserved;
+  Block edges;
+  Block out_offsets;
+  Block out_edges;
+  Block in_offsets;
+  Block in_edges;
+};
+
+struct AdjacencyRecord {
+  uint64_t node_count;
+  Block sources;
+  Block targets;
+  Block id_keys;      // In ID order, keys in the string heap
+  Block handle_keys;  // In handle order
+  Block types;        // TypeIndexRecords
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t size;         // Of the file
+  Block graph;           // PropertyGraph: schema, metadata and stats
+  Block symbol_offsets;  // Symbol count + 1, into symbol_heap
+  Block symbol_heap;
+  Block tables;  // TableRecords
+  EdgeTableRecord edges;
+  AdjacencyRecord adjacency;
+};
+
+// Names of a map's entries, sorted, so snapshots of a graph are the same
+// whatever order its maps iterate in
+template <typename Map>
+std::vector<const std::string*> SortedNames(const Map& map) {
+  std::vector<const std::string*> names;
+  for (const auto& [name, value] : map) names.push_back(&name);
+  std::sort(names.begin(), names.end(),
+            [](const std::string* a, const std::string* b) { return *a < *b; });
+  return names;
+}
+
+}  // namespace
+
+class GraphSnapshot::Writer {
+ public:
+  explicit Writer(const ColumnarGraph& graph)
+      : graph_(graph), remap_(graph.symbols()->size(), kNoSymbol) {
+    out_.resize(sizeof(Header));
+  }
+
+  std::string Write() && {
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.byte_order = kByteOrderMark;
+
+    // Maps in a stable order, as for the rest
+    std::string graph;
+    {
+      google::protobuf::io::StringOutputStream stream(&graph);
+      google::protobuf::io::CodedOutputStream coded(&stream);
+      coded.SetSerializationDeterministic(true);
+      graph_.graph().SerializeToCodedStream(&coded);
+    }
+    header.graph = Append(absl::Span<const char>(graph));
+
+    std::vector<TableRecord> tables;
+    for (const auto& table : graph_.tables()) {
+      tables.push_back(WriteTable(*table));
+    }
+    header.tables = Append(absl::Span<const TableRecord>(tables));
+    header.edges = WriteEdges(graph_.edges());
+    header.adjacency = WriteAdjacency(graph_.adjacency());
+
+    // Strings last, once all are numbered
+    std::vector<uint64_t> offsets = {0};
+    std::string heap;
+    for (Symbol symbol = 0; symbol < strings_.size(); symbol++) {
+      absl::StrAppend(&heap, strings_.Get(symbol));
+      offsets.push_back(heap.size());
+    }
+    header.symbol_offsets = Append(absl::Span<const uint64_t>(offsets));
+    header.symbol_heap = Append(absl::Span<const char>(heap));
+    WriteIdKeys(offsets, &header.adjacency);
+
+    header.size = out_.size();
+    std::memcpy(out_.data(), &header, sizeof(header));
+    return std::move(out_);
+  }
+
+ private:
+  // Add an array at the next 8-byte boundary
+  template <typename T>
+  Block Append(absl::Span<const T> values) {
+    out_.resize((out_.size() + 7) / 8 * 8);
+    Block block = {out_.size(), values.size()};
+    out_.append(reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(T));
+    return block;
+  }
+
+  // Symbol of a string in the snapshot
+  uint32_t Name(absl::string_view name) { return strings_.Intern(name); }
+  uint32_t Remap(Symbol symbol) {
+    uint32_t& remapped = remap_[symbol];
+    if (remapped == kNoSymbol) {
+      remapped = strings_.Intern(graph_.symbols()->Get(symbol));
+    }
+    return remapped;
+  }
+
+  ColumnRecord WriteStrings(uint32_t name, const StringColumn& column) {
+    Array<Symbol> values;
+    values.resize(column.size());
+    Symbol* remapped = values.mutable_data();
+    column.ForEach(
+        [&](size_t row) { remapped[row] = Remap(column.values[row]); });
+    return {name, kStrings, Append<Symbol>(values),
+            Append<uint64_t>(column.present)};
+  }
+
+  template <typename T>
+  ColumnRecord WriteColumn(uint32_t name, ColumnKind kind,
+                           const Column<T>& column) {
+    return {name, kind, Append<T>(column.values),
+            Append<uint64_t>(column.present)};
+  }
+
+  TableRecord WriteTable(const NodeTable& table) {
+    TableRecord record = {};
+    record.type = Name(table.type());
+    record.handles = Append<uint64_t>(table.handles_);
+    record.ids = WriteStrings(kNoSymbol, table.ids_);
+
+    std::vector<ColumnRecord> columns;
+    for (const std::string* name : SortedNames(table.strings_)) {
+      columns.push_back(WriteStrings(Name(*name), table.strings_.at(*name)));
+    }
+    for (const std::string* name : SortedNames(table.doubles_)) {
+      columns.push_back(
+          WriteColumn(Name(*name), kDoubles, table.doubles_.at(*name)));
+    }
+    for (const std::string* name : SortedNames(table.ints_)) {
+      columns.push_back(WriteColumn(Name(*name), kInts, table.ints_.at(*name)));
+    }
+    for (const std::string* name : SortedNames(table.bools_)) {
+      columns.push_back(
+          WriteColumn(Name(*name), kBools, table.bools_.at(*name)));
+    }
+    record.columns = Append(absl::Span<const ColumnRecord>(columns));
+    return record;
+  }
+
+  EdgeTableRecord WriteEdges(const EdgeTable& edges) {
+    EdgeTableRecord record = {};
+    record.types = WriteStrings(kNoSymbol, edges.types_);
+    record.ids = WriteStrings(kNoSymbol, edges.ids_);
+    record.source_ids = WriteStrings(kNoSymbol, edges.source_ids_);
+    record.target_ids = WriteStrings(kNoSymbol, edges.target_ids_);
+    record.source_handles = Append<uint64_t>(edges.source_handles_);
+    record.target_handles = Append<uint64_t>(edges.target_handles_);
+    record.weights = WriteColumn(kNoSymbol, kDoubles, edges.weights_);
+
+    std::vector<ColumnRecord> properties;
+    for (const std::string* name : SortedNames(edges.properties_)) {
+      properties.push_back(
+          WriteStrings(Name(*name), edges.properties_.at(*name)));
+    }
+    record.properties = Append(absl::Span<const ColumnRecord>(properties));
+    return record;
+  }
+
+  AdjacencyRecord WriteAdjacency(const AdjacencyIndex& index) {
+    AdjacencyRecord record = {};
+    record.node_count = index.node_count_;
+    record.sources = Append<NodeIndex>(index.sources_);
+    record.targets = Append<NodeIndex>(index.targets_);
+
+    // Keys from the maps, or from the keys of an index itself opened from
+    // a snapshot. ID keys are placed once the heap is.
+    if (index.id_keys_.empty()) {
+      for (const auto& [id, node] : index.nodes_by_id_) {
+        ids_.push_back({Name(id), node});
+      }
+    } else {
+      for (const auto& key : index.id_keys_) {
+        ids_.push_back(
+            {Name(index.key_heap_.substr(key.offset, key.size)), key.node});
+      }
+    }
+    std::vector<AdjacencyIndex::HandleKey> handles(index.handle_keys_.begin(),
+                                                   index.handle_keys_.end());
+    for (const auto& [handle, node] : index.nodes_by_handle_) {
+      handles.push_back({handle, node, 0});
+    }
+    std::sort(handles.begin(), handles.end(),
+              [](const auto& a, const auto& b) { return a.handle < b.handle; });
+    record.handle_keys =
+        Append(absl::Span<const AdjacencyIndex::HandleKey>(handles));
+
+    std::vector<TypeIndexRecord> types;
+    for (const std::string* name : SortedNames(index.types_)) {
+      const auto& type = index.types_.at(*name);
+      types.push_back({Name(*name), 0, Append<uint32_t>(type.edges),
+                       Append<uint32_t>(type.out_offsets),
+                       Append<uint32_t>(type.out_edges),
+                       Append<uint32_t>(type.in_offsets),
+                       Append<uint32_t>(type.in_edges)});
+    }
+    record.types = Append(absl::Span<const TypeIndexRecord>(types));
+    return record;
+  }
+
+  void WriteIdKeys(const std::vector<uint64_t>& offsets,
+                   AdjacencyRecord* record) {
+    std::sort(ids_.begin(), ids_.end(), [&](const auto& a, const auto& b) {
+      return strings_.Get(a.first) < strings_.Get(b.first);
+    });
+    std::vector<AdjacencyIndex::IdKey> keys;
+    for (const auto& [symbol, node] : ids_) {
+      keys.push_back({offsets[symbol],
+                      static_cast<uint32_t>(strings_.Get(symbol).size()),
+                      node});
+    }
+    record->id_keys = Append(absl::Span<const AdjacencyIndex::IdKey>(keys));
+  }
+
+  const ColumnarGraph& graph_;
+  std::string out_;
+  SymbolTable strings_;
+  std::vector<uint32_t> remap_;  // Graph symbol to snapshot symbol
+  std::vector<std::pair<uint32_t, NodeIndex>> ids_;
+};
+
+class GraphSnapshot::Reader {
+ public:
+  explicit Reader(absl::string_view file) : file_(file) {}
+
+  absl::StatusOr<ColumnarGraph> Read(std::shared_ptr<const void> mapping) {
+    if (file_.size() < sizeof(kMagic) ||
+        std::memcmp(file_.data(), kMagic, sizeof(kMagic)) != 0) {
+      return absl::InvalidArgumentError("Not a graph snapshot");
+    }
+    Header header;
+    if (file_.size() < sizeof(header)) return Damaged();
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.byte_order != kByteOrderMark) {
+      return absl::FailedPreconditionError(
+          "Graph snapshot written on a host of another byte order");
+    }
+    if (header.version != kFormatVersion) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Unsupported graph snapshot version: ", header.version));
+    }
+    if (header.size != file_.size() ||
+        reinterpret_cast<uintptr_t>(file_.data()) % 8 != 0) {
+      return Damaged();
+    }
+
+    // Strings first: every other section names them
+    offsets_ = View<uint64_t>(header.symbol_offsets);
+    Array<char> heap = View<char>(header.symbol_heap);
+    if (!ok_ || offsets_.empty() || offsets_[0] != 0 ||
+        !std::is_sorted(offsets_.begin(), offsets_.end()) ||
+        offsets_.back() != heap.size()) {
+      return Damaged();
+    }
+    heap_ = absl::string_view(heap.data(), heap.size());
+    ColumnarGraph graph(std::make_shared<SymbolTable>(offsets_, heap_));
+    graph.mapping_ = std::move(mapping);
+    symbols_ = graph.symbols_.get();
+
+    Array<char> proto = View<char>(header.graph);
+    if (!ok_ || !graph.graph_->ParseFromArray(proto.data(), proto.size())) {
+      return Damaged();
+    }
+    for (const auto& record : View<TableRecord>(header.tables)) {
+      ReadTable(record, &graph);
+    }
+    ReadEdges(header.edges, &graph.edges_);
+    ReadAdjacency(header.adjacency, graph.edges_.size(), &graph.adjacency_);
+    if (!ok_) return Damaged();
+    return graph;
+  }
+
+ private:
+  absl::Status Damaged() const {
+    return absl::DataLossError("Damaged graph snapshot");
+  }
+
+  // View of an array, if it lies in the file
+  template <typename T>
+  Array<T> View(const Block& block) {
+    uint64_t limit = (file_.size() - std::min<uint64_t>(block.offset,
+                                                        file_.size())) /
+                     sizeof(T);
+    if (block.offset > file_.size() || block.offset % alignof(T) != 0 ||
+        block.count > limit) {
+      ok_ = false;
+      return {};
+    }
+    return Array<T>::View(
+        reinterpret_cast<const T*>(file_.data() + block.offset), block.count);
+  }
+
+  absl::string_view Name(uint32_t symbol) {
+    if (symbol >= offsets_.size() - 1) {
+      ok_ = false;
+      return {};
+    }
+    return heap_.substr(offsets_[symbol], offsets_[symbol + 1] -
+                                              offsets_[symbol]);
+  }
+
+  // Column of at most `rows` rows, its bitmap covering them
+  template <typename T>
+  void ReadColumn(const ColumnRecord& record, size_t rows, Column<T>* column) {
+    column->values = View<T>(record.values);
+    column->present = View<uint64_t>(record.present);
+    if (column->values.size() > rows ||
+        column->present.size() < (column->values.size() + 63) / 64) {
+      ok_ = false;
+    }
+  }
+
+  // As above, each byte 0 or 1; any other is not a valid bool to load
+  void ReadColumn(const ColumnRecord& record, size_t rows,
+                  Column<bool>* column) {
+    static_assert(sizeof(bool) == 1);
+    Array<uint8_t> bytes = View<uint8_t>(record.values);
+    if (!std::all_of(bytes.begin(), bytes.end(),
+                     [](uint8_t byte) { return byte <= 1; })) {
+      ok_ = false;
+      return;
+    }
+    ReadColumn<bool>(record, rows, column);
+  }
+
+  // As above, each value present naming a symbol
+  void ReadColumn(const ColumnRecord& record, size_t rows,
+                  StringColumn* column) {
+    ReadColumn<Symbol>(record, rows, column);
+    if (!ok_) return;
+    size_t symbol_count = offsets_.size() - 1;
+    column->ForEach([&](size_t row) {
+      if (column->values[row] >= symbol_count) ok_ = false;
+    });
+  }
+
+  // Whether each of `values` is below `limit`
+  static bool Below(const Array<uint32_t>& values, uint64_t limit) {
+    return std::all_of(values.begin(), values.end(),
+                       [&](uint32_t value) { return value < limit; });
+  }
+
+  // As Below(), for edge ends, which may also be kNoNode
+  static bool EndsBelow(const Array<NodeIndex>& ends, uint64_t node_count) {
+    return std::all_of(ends.begin(), ends.end(), [&](NodeIndex end) {
+      return end < node_count || end == AdjacencyIndex::kNoNode;
+    });
+  }
+
+  void ReadTable(const TableRecord& record, ColumnarGraph* graph) {
+    NodeTable* table = graph->mutable_table(Name(record.type));
+    table->handles_ = View<uint64_t>(record.handles);
+    size_t rows = table->size();
+    ReadColumn(record.ids, rows, &table->ids_);
+    for (const auto& column : View<ColumnRecord>(record.columns)) {
+      std::string name(Name(column.name));
+      switch (column.kind) {
+        case kStrings:
+          ReadColumn(column, rows,
+                     &table->strings_.try_emplace(name, symbols_).first->second);
+          break;
+        case kDoubles:
+          ReadColumn(column, rows, &table->doubles_[name]);
+          break;
+        case kInts:
+          ReadColumn(column, rows, &table->ints_[name]);
+          break;
+        case kBools:
+          ReadColumn(column, rows, &table->bools_[name]);
+          break;
+        default:
+          ok_ = false;
+      }
+    }
+  }
+
+  void ReadEdges(const EdgeTableRecord& record, EdgeTable* edges) {
+    edges->source_handles_ = View<uint64_t>(record.source_handles);
+    edges->target_handles_ = View<uint64_t>(record.target_handles);
+    size_t rows = edges->source_handles_.size();
+    ReadColumn(record.types, rows, &edges->types_);
+    ReadColumn(record.ids, rows, &edges->ids_);
+    ReadColumn(record.source_ids, rows, &edges->source_ids_);
+    ReadColumn(record.target_ids, rows, &edges->target_ids_);
+    ReadColumn(record.weights, rows, &edges->weights_);
+    if (edges->types_.size() != rows || edges->target_handles_.size() != rows) {
+      ok_ = false;
+    }
+    for (const auto& column : View<ColumnRecord>(record.properties)) {
+      ReadColumn(column, rows,
+                 &edges->properties_
+                      .try_emplace(std::string(Name(column.name)), symbols_)
+                      .first->second);
+    }
+  }
+
+  // Every node and edge number is checked, since lookups index arrays by
+  // them unchecked
+  void ReadAdjacency(const AdjacencyRecord& record, size_t edge_count,
+                     AdjacencyIndex* index) {
+    // kNoNode marks an edge end with no node, so can't count them
+    if (record.node_count >= AdjacencyIndex::kNoNode) {
+      ok_ = false;
+      return;
+    }
+    uint64_t node_count = record.node_count;
+    index->node_count_ = node_count;
+    index->sources_ = View<NodeIndex>(record.sources);
+    index->targets_ = View<NodeIndex>(record.targets);
+    index->id_keys_ = View<AdjacencyIndex::IdKey>(record.id_keys);
+    index->handle_keys_ = View<AdjacencyIndex::HandleKey>(record.handle_keys);
+    index->key_heap_ = heap_;
+    if (index->sources_.size() != edge_count ||
+        index->targets_.size() != edge_count ||
+        !EndsBelow(index->sources_, node_count) ||
+        !EndsBelow(index->targets_, node_count)) {
+      ok_ = false;
+    }
+    for (const auto& key : index->id_keys_) {
+      if (key.offset > heap_.size() || key.size > heap_.size() - key.offset ||
+          key.node >= node_count) {
+        ok_ = false;
+      }
+    }
+    for (const auto& key : index->handle_keys_) {
+      if (key.node >= node_count) ok_ = false;
+    }
+
+    // Offsets: a slot per node, rising to one past the last edge listed
+    auto offsets_ok = [&](const Array<uint32_t>& offsets,
+                          const Array<uint32_t>& lists) {
+      return offsets.size() == node_count + 1 && offsets[0] == 0 &&
+             std::is_sorted(offsets.begin(), offsets.end()) &&
+             offsets.back() == lists.size();
+    };
+    for (const auto& type : View<TypeIndexRecord>(record.types)) {
+      auto& index_type = index->types_[Name(type.type)];
+      index_type.edges = View<uint32_t>(type.edges);
+      index_type.out_offsets = View<uint32_t>(type.out_offsets);
+      index_type.out_edges = View<uint32_t>(type.out_edges);
+      index_type.in_offsets = View<uint32_t>(type.in_offsets);
+      index_type.in_edges = View<uint32_t>(type.in_edges);
+      if (!ok_ ||
+          !offsets_ok(index_type.out_offsets, index_type.out_edges) ||
+          !offsets_ok(index_type.in_offsets, index_type.in_edges) ||
+          !Below(index_type.edges, edge_count) ||
+          !Below(index_type.out_edges, edge_count) ||
+          !Below(index_type.in_edges, edge_count)) {
+        ok_ = false;
+        return;
+      }
+    }
+  }
+
+  absl::string_view file_;
+  bool ok_ = true;  // False once a record is found out of place
+  Array<uint64_t> offsets_;
+  absl::string_view heap_;
+  SymbolTable* symbols_ = nullptr;
+};
+
+std::string GraphSnapshot::Serialize(const ColumnarGraph& graph) {
+  return Writer(graph).Write();
+}
+
+absl::Status GraphSnapshot::Write(const ColumnarGraph& graph,
+                                  absl::string_view file_path) {
+  std::string contents = Serialize(graph);
+  return common::WriteFileAtomically(file_path, [&](std::ostream& out) {
+    return static_cast<bool>(out.write(contents.data(), contents.size()));
+  });
+}
+
+absl::StatusOr<ColumnarGraph> GraphSnapshot::Open(
+    absl::string_view file_path) {
+  auto buffer_or = parser::DXFBuffer::Map(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
+  absl::string_view contents = (*buffer_or)->contents();
+  auto graph_or = Reader(contents).Read(*std::move(buffer_or));
+  if (!graph_or.ok()) {
+    return absl::Status(graph_or.status().code(),
+                        absl::StrCat(graph_or.status().message(), ": ",
+                                     file_path));
+  }
+  return graph_or;
+}
+
+}  // namespace finetoo::graph
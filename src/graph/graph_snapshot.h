@@ -0,0 +1,60 @@
+// Copyright 2025 Finetoo
+// Graph Snapshot - A ColumnarGraph in a file, used in place
+//
+// Reading a graph back from a serialized PropertyGraph allocates every
+// node and property again. A snapshot instead lays the ColumnarGraph out
+// as it is held in memory: a string heap with its offsets, fixed-size
+// records for each node table, the edge table and the adjacency index,
+// and the arrays they point to (column values and bitmaps, handles, CSR
+// offsets and edge lists), each aligned to its type. Open() maps the file
+// and returns a graph whose arrays view the mapping, so only the pages
+// an operation reads are loaded, and processes opening the same snapshot
+// share them through the page cache.
+//
+// The file is a Header (magic, version, byte order, size and the records
+// of each section) followed by the arrays, each 8-byte aligned at an
+// offset the records give. Values are in the writing host's byte order; a
+// host of the other order won't open the file. Only schema, metadata and
+// stats remain a serialized PropertyGraph, parsed on open; they are small.
+// Open() checks the header, that each array lies in the file and that the
+// arrays' lengths agree, that bools are 0 or 1, and every value later used
+// as an index: symbols, node and edge numbers, CSR offsets and ID keys into
+// the string heap. Other values (reals, handles, bitmaps) are used as they
+// are.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "src/graph/columnar_graph.h"
+
+namespace finetoo::graph {
+
+class GraphSnapshot {
+ public:
+  // Bump whenever the layout changes; other versions are not opened
+  static constexpr uint32_t kFormatVersion = 1;
+
+  // Snapshot of a graph with indexed edges (ColumnarGraph::IndexEdges()).
+  // Only the strings the graph uses are kept, renumbered.
+  static std::string Serialize(const ColumnarGraph& graph);
+
+  // Serialize() to `file_path`, written aside and renamed into place
+  static absl::Status Write(const ColumnarGraph& graph,
+                            absl::string_view file_path);
+
+  // Graph viewing the snapshot at `file_path`, mapped for as long as the
+  // graph lives. Its columns get copied into memory of their own only if
+  // written to.
+  static absl::StatusOr<ColumnarGraph> Open(absl::string_view file_path);
+
+ private:
+  class Writer;
+  class Reader;
+};
+
+}  // namespace finetoo::graph
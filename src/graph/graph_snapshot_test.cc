@@ -0,0 +1,148 @@
+// Copyright 2025 Finetoo
+// GraphSnapshot Tests
+
+#include "src/graph/graph_snapshot.h"
+
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "google/protobuf/util/message_differencer.h"
+#include "src/graph/test_drawings.h"
+
+namespace finetoo::graph {
+namespace {
+
+// Layers, a block nested in another and two entities, for the tables,
+// edge types and keys a snapshot holds
+constexpr char kDXF[] =
+    "  0\nSECTION\n  2\nTABLES\n  0\nTABLE\n  2\nLAYER\n"
+    "  0\nLAYER\n  5\nA\n  2\nWALLS\n 70\n     4\n 62\n    -3\n"
+    "  0\nENDTAB\n  0\nENDSEC\n  0\nSECTION\n  2\nBLOCKS\n"
+    "  0\nBLOCK\n  2\nBOLT\n  0\nCIRCLE\n  8\n0\n 40\n1.0\n  0\nENDBLK\n"
+    "  0\nBLOCK\n  2\nPART\n  0\nINSERT\n  5\nC1\n  8\n0\n  2\nBOLT\n"
+    "  0\nENDBLK\n  0\nENDSEC\n  0\nSECTION\n  2\nENTITIES\n"
+    "  0\nINSERT\n  5\n1A\n  8\nWALLS\n  2\nPART\n 10\n1\n 20\n2\n"
+    "  0\nLINE\n  5\n1B\n  8\nWALLS\n 10\n0\n 20\n0\n 11\n3\n 21\n4\n"
+    "  0\nENDSEC\n  0\nEOF\n";
+
+TEST(GraphSnapshotTest, OpensTheGraphWritten) {
+  auto built_or = BuildColumnarGraph(kDXF);
+  ASSERT_TRUE(built_or.ok()) << built_or.status();
+  std::string path = ::testing::TempDir() + "/graph_snapshot_test.graph";
+  ASSERT_TRUE(GraphSnapshot::Write(*built_or, path).ok());
+
+  auto opened_or = GraphSnapshot::Open(path);
+  ASSERT_TRUE(opened_or.ok()) << opened_or.status();
+  const ColumnarGraph& opened = *opened_or;
+
+  // Columns and edge lists are read in place
+  const StringColumn* layers = opened.table("Entity")->strings("layer");
+  ASSERT_NE(layers, nullptr);
+  EXPECT_TRUE(layers->values.is_view());
+  EXPECT_EQ(layers->Get(0), "WALLS");
+  EXPECT_EQ(layers->Find("WALLS"), layers->values[0]);
+  EXPECT_EQ(opened.table("Entity")->doubles("gc_11")->values[1], 3);
+
+  const AdjacencyIndex& adjacency = opened.adjacency();
+  auto part = adjacency.FindNode("block_PART");
+  ASSERT_TRUE(part.has_value());
+  auto nested = adjacency.OutEdges("CONTAINS", *part);
+  ASSERT_EQ(nested.size(), 1);
+  EXPECT_EQ(adjacency.target(nested[0]), adjacency.FindNode("block_BOLT"));
+  auto inserts = adjacency.InEdges("REFERENCES", *part);
+  ASSERT_EQ(inserts.size(), 1);
+  EXPECT_EQ(adjacency.source(inserts[0]), adjacency.FindNode(0x1A));
+  EXPECT_EQ(opened.edges().TargetNodeId(inserts[0]), "block_PART");
+  EXPECT_FALSE(adjacency.FindNode("block_NONE").has_value());
+
+  // The same graph, and the same snapshot written again
+  EXPECT_TRUE(GraphSnapshot::Serialize(opened) ==
+              GraphSnapshot::Serialize(*built_or));
+  auto reopened_or = GraphSnapshot::Open(path);
+  ASSERT_TRUE(reopened_or.ok()) << reopened_or.status();
+  GraphHandle expected = std::move(*built_or).Export();
+  GraphHandle exported = std::move(*reopened_or).Export();
+  std::string differences;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&differences);
+  EXPECT_TRUE(differencer.Compare(*exported, *expected)) << differences;
+}
+
+TEST(GraphSnapshotTest, RejectsOtherFiles) {
+  auto built_or = BuildColumnarGraph(kDXF);
+  ASSERT_TRUE(built_or.ok()) << built_or.status();
+  std::string snapshot = GraphSnapshot::Serialize(*built_or);
+  std::string path = ::testing::TempDir() + "/graph_snapshot_test.other";
+
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << kDXF;
+  EXPECT_EQ(GraphSnapshot::Open(path).status().code(),
+            absl::StatusCode::kInvalidArgument);
+
+  std::ofstream(path, std::ios::binary | std::ios::trunc)
+      << snapshot.substr(0, snapshot.size() - 8);
+  EXPECT_EQ(GraphSnapshot::Open(path).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+TEST(GraphSnapshotTest, RejectsOutOfRangeValues) {
+  auto built_or = BuildColumnarGraph(kDXF);
+  ASSERT_TRUE(built_or.ok()) << built_or.status();
+  std::string snapshot = GraphSnapshot::Serialize(*built_or);
+  std::string path = ::testing::TempDir() + "/graph_snapshot_test.damaged";
+
+  // Each word in turn set to all ones: a symbol, node, edge or heap offset
+  // out of range, or a bool that isn't 0 or 1. The snapshot is rejected, or
+  // opens with every value it hands out in range.
+  for (size_t offset = 0; offset + 4 <= snapshot.size(); offset += 4) {
+    std::string damaged = snapshot;
+    damaged.replace(offset, 4, 4, '\xff');
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+    auto opened_or = GraphSnapshot::Open(path);
+    if (!opened_or.ok()) continue;
+    SCOPED_TRACE(offset);
+
+    const AdjacencyIndex& adjacency = opened_or->adjacency();
+    size_t node_count = adjacency.node_count();
+    auto is_node = [&](NodeIndex node) {
+      return node < node_count || node == AdjacencyIndex::kNoNode;
+    };
+    for (auto node : {adjacency.FindNode("block_PART"),
+                      adjacency.FindNode(0x1A)}) {
+      EXPECT_TRUE(!node || *node < node_count);
+    }
+    for (const char* type : {"CONTAINS", "REFERENCES", "BELONGS_TO"}) {
+      for (uint32_t edge : adjacency.Edges(type)) {
+        ASSERT_LT(edge, adjacency.edge_count());
+        EXPECT_TRUE(is_node(adjacency.source(edge)));
+        EXPECT_TRUE(is_node(adjacency.target(edge)));
+      }
+      for (NodeIndex node = 0; node < node_count; node++) {
+        for (auto edges : {adjacency.OutEdges(type, node),
+                           adjacency.InEdges(type, node)}) {
+          for (uint32_t edge : edges) {
+            EXPECT_LT(edge, adjacency.edge_count());
+          }
+        }
+      }
+    }
+    // The layer flags, inspected as bytes since loading any other value as
+    // a bool is undefined
+    for (const auto& table : opened_or->tables()) {
+      for (const char* name : {"off", "frozen", "locked"}) {
+        const Column<bool>* column = table->bools(name);
+        if (column == nullptr) continue;
+        const auto* bytes =
+            reinterpret_cast<const unsigned char*>(column->values.data());
+        for (size_t row = 0; row < column->size(); row++) {
+          EXPECT_LE(bytes[row], 1) << name << " row " << row;
+        }
+      }
+    }
+    std::move(*opened_or).Export();
+  }
+}
+
+}  // namespace
+}  // namespace finetoo::graph
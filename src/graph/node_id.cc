@@ -0,0 +1,29 @@
+// Copyright 2025 Finetoo
+// Node IDs Implementation
+
+#include "src/graph/node_id.h"
+
+#include "src/parser/dxf_handle.h"
+
+namespace finetoo::graph {
+
+std::string NodeId(const finetoo::graph::v1::Node& node) {
+  return NodeId(node.id(), node.handle());
+}
+
+std::string NodeId(absl::string_view id, uint64_t handle) {
+  if (!id.empty()) return std::string(id);
+  return parser::FormatHandle(handle);
+}
+
+std::string SourceNodeId(const finetoo::graph::v1::Edge& edge) {
+  if (!edge.source_node_id().empty()) return edge.source_node_id();
+  return parser::FormatHandle(edge.source_handle());
+}
+
+std::string TargetNodeId(const finetoo::graph::v1::Edge& edge) {
+  if (!edge.target_node_id().empty()) return edge.target_node_id();
+  return parser::FormatHandle(edge.target_handle());
+}
+
+}  // namespace finetoo::graph
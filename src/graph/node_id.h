@@ -0,0 +1,26 @@
+// Copyright 2025 Finetoo
+// Node IDs - Printable identifiers for nodes and edge endpoints
+//
+// DXF nodes are identified by their integer handle rather than a string ID
+// (see Node.handle). These helpers give every node the same printable ID,
+// for results, provenance and reports.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "proto/graph.pb.h"
+
+namespace finetoo::graph {
+
+// The node's string ID if it has one, else its handle in hex
+std::string NodeId(const finetoo::graph::v1::Node& node);
+std::string NodeId(absl::string_view id, uint64_t handle);
+
+// Same for the ends of an edge
+std::string SourceNodeId(const finetoo::graph::v1::Edge& edge);
+std::string TargetNodeId(const finetoo::graph::v1::Edge& edge);
+
+}  // namespace finetoo::graph
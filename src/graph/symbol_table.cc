@@ -0,0 +1,118 @@
+// Copyright 2025 Finetoo
+// Symbol Table Implementation
+
+#include "src/graph/symbol_table.h"
+
+#include <cstring>
+
+#include "absl/numeric/bits.h"
+
+namespace finetoo::graph {
+
+SymbolTable::SymbolTable(absl::Span<const uint64_t> offsets,
+                         absl::string_view heap)
+    : indexed_(false) {
+  size_t size = offsets.empty() ? 0 : offsets.size() - 1;
+  for (size_t symbol = 0; symbol < size; symbol++) {
+    auto [segment, offset] = Locate(symbol);
+    absl::string_view* views = segments_[segment].load();
+    if (views == nullptr) {
+      views = new absl::string_view[size_t{1} << (segment + kFirstSegmentBits)];
+      segments_[segment].store(views);
+    }
+    views[offset] =
+        heap.substr(offsets[symbol], offsets[symbol + 1] - offsets[symbol]);
+  }
+  size_.store(size);
+}
+
+SymbolTable::~SymbolTable() {
+  for (auto& segment : segments_) delete[] segment.load();
+}
+
+std::pair<int, size_t> SymbolTable::Locate(Symbol symbol) {
+  uint64_t index = uint64_t{symbol} + (1 << kFirstSegmentBits);
+  int segment = absl::bit_width(index) - 1 - kFirstSegmentBits;
+  return {segment, index - (uint64_t{1} << (segment + kFirstSegmentBits))};
+}
+
+void SymbolTable::IndexStrings() const {
+  if (indexed_.load(std::memory_order_acquire)) return;
+  absl::MutexLock lock(&mutex_);
+  if (indexed_.load(std::memory_order_relaxed)) return;
+  symbols_.reserve(size());
+  for (Symbol symbol = 0; symbol < size(); symbol++) {
+    symbols_.emplace(Get(symbol), symbol);
+  }
+  indexed_.store(true, std::memory_order_release);
+}
+
+Symbol SymbolTable::Intern(absl::string_view value) {
+  IndexStrings();
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = symbols_.find(value);
+    if (it != symbols_.end()) return it->second;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  auto it = symbols_.find(value);  // Another thread may have added it
+  if (it != symbols_.end()) return it->second;
+
+  size_t symbol = size_.load(std::memory_order_relaxed);
+  auto [segment, offset] = Locate(symbol);
+  absl::string_view* views = segments_[segment].load(std::memory_order_relaxed);
+  if (views == nullptr) {
+    views = new absl::string_view[size_t{1} << (segment + kFirstSegmentBits)];
+    segments_[segment].store(views, std::memory_order_release);
+  }
+
+  views[offset] = Store(value);
+  symbols_.emplace(views[offset], symbol);
+  size_.store(symbol + 1, std::memory_order_release);
+  return symbol;
+}
+
+std::optional<Symbol> SymbolTable::Find(absl::string_view value) const {
+  IndexStrings();
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = symbols_.find(value);
+  if (it == symbols_.end()) return std::nullopt;
+  return it->second;
+}
+
+size_t SymbolTable::SpaceUsed() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  size_t views = 0;
+  for (int segment = 0; segment < kSegments; segment++) {
+    if (segments_[segment].load() == nullptr) break;
+    views += size_t{1} << (segment + kFirstSegmentBits);
+  }
+  return bytes_ + views * sizeof(absl::string_view) +
+         symbols_.capacity() * (sizeof(absl::string_view) + sizeof(Symbol) + 1);
+}
+
+absl::string_view SymbolTable::Store(absl::string_view value) {
+  if (value.empty()) return absl::string_view();
+
+  char* data;
+  if (value.size() > kBlockSize / 4) {
+    // Large strings get a block of their own, ahead of the current one
+    auto block = blocks_.insert(blocks_.end() - !blocks_.empty(),
+                                std::make_unique<char[]>(value.size()));
+    data = block->get();
+    bytes_ += value.size();
+  } else {
+    if (block_used_ + value.size() > kBlockSize) {
+      blocks_.push_back(std::make_unique<char[]>(kBlockSize));
+      block_used_ = 0;
+      bytes_ += kBlockSize;
+    }
+    data = blocks_.back().get() + block_used_;
+    block_used_ += value.size();
+  }
+  std::memcpy(data, value.data(), value.size());
+  return absl::string_view(data, value.size());
+}
+
+}  // namespace finetoo::graph
@@ -0,0 +1,97 @@
+// Copyright 2025 Finetoo
+// Symbol Table - Interned strings with integer IDs
+//
+// Layer names, entity types, block names and most group values repeat
+// across the nodes of a drawing and across the drawings of a batch. A
+// SymbolTable keeps one copy of each and numbers them, so a column stores
+// a 4-byte Symbol per row instead of a string. One table can be shared by
+// every graph a GraphBuilder builds, or view the strings of a snapshot.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+
+namespace finetoo::graph {
+
+// ID of an interned string, numbered from 0 in order of first use
+using Symbol = uint32_t;
+
+// Interned strings, up to 2^32 - 1024 of them. Intern() and Find() are
+// thread-safe; Get() takes no lock. Views returned stay valid for the
+// table's lifetime.
+class SymbolTable {
+ public:
+  SymbolTable() = default;
+
+  // Strings viewed in `heap`, which must outlive the table: symbol i is
+  // bytes [offsets[i], offsets[i + 1]). Find() and Intern() index them on
+  // first use.
+  SymbolTable(absl::Span<const uint64_t> offsets, absl::string_view heap);
+
+  ~SymbolTable();
+
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  // Symbol of `value`, added if new
+  Symbol Intern(absl::string_view value);
+
+  // Symbol of `value`, if it was interned
+  std::optional<Symbol> Find(absl::string_view value) const;
+
+  // String of a symbol Intern() returned
+  absl::string_view Get(Symbol symbol) const {
+    auto [segment, offset] = Locate(symbol);
+    return segments_[segment].load(std::memory_order_acquire)[offset];
+  }
+
+  // Number of symbols; every Symbol below it is valid
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+
+  // Bytes held, strings and index
+  size_t SpaceUsed() const;
+
+ private:
+  // Symbols are indexed in segments of 1024, 2048, 4096, ... views that
+  // never move once allocated, so readers need no lock
+  static constexpr int kFirstSegmentBits = 10;
+  static constexpr int kSegments = 32 - kFirstSegmentBits;
+
+  static std::pair<int, size_t> Locate(Symbol symbol);
+
+  // Strings are packed into blocks of this size, or one of their own
+  static constexpr size_t kBlockSize = 64 << 10;
+
+  // Copy `value` into block storage
+  absl::string_view Store(absl::string_view value)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Index a viewed heap, if not done yet
+  void IndexStrings() const;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<absl::string_view, Symbol> symbols_
+      ABSL_GUARDED_BY(mutex_);
+  mutable std::atomic<bool> indexed_{true};
+  std::vector<std::unique_ptr<char[]>> blocks_ ABSL_GUARDED_BY(mutex_);
+  size_t block_used_ ABSL_GUARDED_BY(mutex_) = kBlockSize;
+  size_t bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  std::array<std::atomic<absl::string_view*>, kSegments> segments_{};
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace finetoo::graph
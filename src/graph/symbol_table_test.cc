@@ -0,0 +1,64 @@
+// Copyright 2025 Finetoo
+// SymbolTable Tests
+
+#include "src/graph/symbol_table.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "absl/strings/str_cat.h"
+
+namespace finetoo::graph {
+namespace {
+
+TEST(SymbolTableTest, InternsOnce) {
+  SymbolTable symbols;
+  std::string layer = "WALLS";
+  Symbol walls = symbols.Intern(layer);
+  layer = "DOORS";  // The table keeps its own copy
+  EXPECT_EQ(symbols.Intern("DOORS"), walls + 1);
+  EXPECT_EQ(symbols.Intern("WALLS"), walls);
+  EXPECT_EQ(symbols.Get(walls), "WALLS");
+  EXPECT_EQ(symbols.Find("DOORS"), walls + 1);
+  EXPECT_FALSE(symbols.Find("ROOF").has_value());
+
+  EXPECT_EQ(symbols.Get(symbols.Intern("")), "");
+  std::string large(100000, 'x');
+  EXPECT_EQ(symbols.Get(symbols.Intern(large)), large);
+  EXPECT_EQ(symbols.size(), 4);
+}
+
+TEST(SymbolTableTest, ViewsStayValidAcrossThreads) {
+  SymbolTable symbols;
+  Symbol first = symbols.Intern("0");
+  absl::string_view view = symbols.Get(first);
+
+  // Threads intern overlapping ranges, crossing several index segments
+  constexpr int kCount = 20000;
+  std::vector<std::vector<Symbol>> interned(4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kCount; i++) {
+        std::string value = absl::StrCat((i + t * 1000) % kCount);
+        interned[t].push_back(symbols.Intern(value));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(symbols.size(), kCount);
+  EXPECT_EQ(view.data(), symbols.Get(first).data());
+  for (int t = 0; t < 4; t++) {
+    for (int i = 0; i < kCount; i++) {
+      EXPECT_EQ(symbols.Get(interned[t][i]),
+                absl::StrCat((i + t * 1000) % kCount));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace finetoo::graph
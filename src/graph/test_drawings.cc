@@ -0,0 +1,40 @@
+// Copyright 2025 Finetoo
+// Test Drawings Implementation
+
+#include "src/graph/test_drawings.h"
+
+#include <string>
+
+#include "src/graph/graph_builder.h"
+#include "src/parser/dxf_text_parser.h"
+
+namespace finetoo::graph {
+
+const char kPartDrawing[] =
+    "  0\nSECTION\n  2\nBLOCKS\n  0\nBLOCK\n  2\nPART\n  0\nCIRCLE\n  8\n0\n"
+    " 40\n1.0\n  0\nENDBLK\n  0\nENDSEC\n  0\nSECTION\n  2\nENTITIES\n"
+    "  0\nINSERT\n  5\n1A\n  8\nWALLS\n  2\nPART\n 10\n1\n 20\n2\n"
+    "  0\nENDSEC\n  0\nEOF\n";
+
+namespace {
+
+absl::StatusOr<parser::DXFFile> Parse(absl::string_view contents) {
+  return parser::DXFTextParser().Parse(
+      parser::DXFBuffer::FromString(std::string(contents)));
+}
+
+}  // namespace
+
+absl::StatusOr<GraphHandle> BuildGraph(absl::string_view contents) {
+  auto file_or = Parse(contents);
+  if (!file_or.ok()) return file_or.status();
+  return GraphBuilder().Build(*file_or);
+}
+
+absl::StatusOr<ColumnarGraph> BuildColumnarGraph(absl::string_view contents) {
+  auto file_or = Parse(contents);
+  if (!file_or.ok()) return file_or.status();
+  return GraphBuilder().BuildColumnar(*file_or);
+}
+
+}  // namespace finetoo::graph
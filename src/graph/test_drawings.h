@@ -0,0 +1,21 @@
+// Copyright 2025 Finetoo
+// Test Drawings - Small DXF drawings, and their graphs, shared by tests
+
+#pragma once
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "src/graph/columnar_graph.h"
+#include "src/graph/graph_handle.h"
+
+namespace finetoo::graph {
+
+// Block PART, holding a CIRCLE, and one INSERT of it: handle 1A, on layer
+// WALLS, at (1, 2)
+extern const char kPartDrawing[];
+
+// Graph of a drawing given as DXF text
+absl::StatusOr<GraphHandle> BuildGraph(absl::string_view contents);
+absl::StatusOr<ColumnarGraph> BuildColumnarGraph(absl::string_view contents);
+
+}  // namespace finetoo::graph
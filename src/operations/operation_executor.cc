@@ -3,15 +3,45 @@
 
 #include "src/operations/operation_executor.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "src/graph/node_id.h"
+#include "src/parser/dxf_handle.h"
 
 namespace finetoo::operations {
 
 OperationExecutor::OperationExecutor(finetoo::graph::v1::PropertyGraph* graph)
     : graph_(graph) {}
 
+OperationExecutor::OperationExecutor(const graph::ColumnarGraph* graph)
+    : graph_(&graph->graph()), columns_(graph) {}
+
+OperationExecutor::OperationExecutor(const graph::GraphSet* graphs)
+    : graph_(nullptr), graphs_(graphs) {
+  for (const auto& member : graphs->members()) {
+    members_.push_back(
+        std::make_unique<OperationExecutor>(member.graph.get()));
+  }
+}
+
 absl::StatusOr<finetoo::operations::v1::OperationResult>
 OperationExecutor::Execute(const finetoo::operations::v1::Operation& operation) {
+  if (graphs_ != nullptr) return ExecuteAcross(operation);
   switch (operation.type()) {
     case finetoo::operations::v1::MATCH:
       return Match(operation);
@@ -44,6 +74,365 @@ OperationExecutor::ExecutePlan(
   return absl::UnimplementedError("ExecutePlan not yet implemented");
 }
 
+absl::StatusOr<finetoo::operations::v1::OperationResult>
+OperationExecutor::ExecuteAcross(
+    const finetoo::operations::v1::Operation& operation) {
+  const auto& parameters = operation.parameters();
+  auto it_function = parameters.find("function");
+  auto it_group_by = parameters.find("group_by");
+  bool match = operation.type() == finetoo::operations::v1::MATCH;
+  bool aggregate = operation.type() == finetoo::operations::v1::AGGREGATE;
+  bool grouped = aggregate && it_group_by != parameters.end();
+
+  // The drawing column holds one value per member
+  bool on_drawing =
+      (match || operation.type() == finetoo::operations::v1::FILTER)
+          ? operation.property_name() == graph::GraphSet::kDrawingProperty
+          : grouped && it_group_by->second == graph::GraphSet::kDrawingProperty;
+
+  finetoo::operations::v1::OperationResult result;
+
+  // Sums and averages combine the members' raw totals: an average is
+  // their sum over their count
+  const std::string* function =
+      it_function != parameters.end() ? &it_function->second : nullptr;
+  if (aggregate && !grouped && function != nullptr &&
+      (*function == "SUM" || *function == "AVG")) {
+    std::optional<Totals> totals;
+    for (const auto& member : members_) {
+      auto member_totals =
+          member->Sum(operation.target_type(), operation.property_name());
+      if (!member_totals.has_value()) continue;
+      if (!totals.has_value()) totals.emplace();
+      totals->sum += member_totals->sum;
+      totals->count += member_totals->count;
+    }
+    if (totals.has_value()) SetTotals(*function, *totals, &result);
+    return result;
+  }
+
+  // Anything else aggregated is a count
+  std::map<std::string, int64_t> counts;
+  int64_t processed = 0;
+  for (size_t i = 0; i < members_.size(); i++) {
+    auto member_or = on_drawing
+                         ? ExecuteOnDrawing(operation, graphs_->member(i))
+                         : members_[i]->Execute(operation);
+    if (!member_or.ok()) return member_or.status();
+
+    processed += member_or->nodes_processed();
+    result.mutable_node_ids()->MergeFrom(member_or->node_ids());
+    result.mutable_provenance()->MergeFrom(member_or->provenance());
+    for (const auto& [key, value] : member_or->values()) {
+      int64_t count = 0;
+      if (!aggregate) {
+        (*result.mutable_values())[key] = value;
+      } else if (absl::SimpleAtoi(value, &count)) {
+        counts[key] += count;
+      }
+    }
+
+    // Match stops at the first node found
+    if (match && result.node_ids_size() > 0) break;
+  }
+  for (const auto& [key, count] : counts) {
+    (*result.mutable_values())[key] = std::to_string(count);
+  }
+
+  result.set_nodes_processed(processed);
+  return result;
+}
+
+absl::StatusOr<finetoo::operations::v1::OperationResult>
+OperationExecutor::ExecuteOnDrawing(
+    const finetoo::operations::v1::Operation& op,
+    const graph::GraphSet::Member& member) {
+  finetoo::operations::v1::OperationResult result;
+  bool aggregate = op.type() == finetoo::operations::v1::AGGREGATE;
+  auto it_value = op.parameters().find("value");
+  if (!aggregate && it_value == op.parameters().end()) {
+    return absl::InvalidArgumentError(
+        "Match and Filter operations require 'value' parameter");
+  }
+
+  const auto& nodes_by_type = member.graph->nodes_by_type();
+  auto type_it = nodes_by_type.find(op.target_type());
+  if (type_it == nodes_by_type.end()) return result;
+  const auto& nodes = type_it->second.nodes();
+
+  // Every node of the member is in one group, or matches or not alike
+  if (aggregate) {
+    (*result.mutable_values())[member.drawing] = std::to_string(nodes.size());
+    for (const auto& node : nodes) {
+      result.add_provenance(graph::NodeId(node));
+    }
+    result.set_nodes_processed(nodes.size());
+    return result;
+  }
+
+  auto it_operator = op.parameters().find("operator");
+  const std::string op_str = it_operator != op.parameters().end()
+                                 ? it_operator->second
+                                 : "EQUALS";
+  const std::string& value = it_value->second;
+  bool matches = false;
+  if (op_str == "EQUALS") {
+    matches = member.drawing == value;
+  } else if (op_str == "CONTAINS") {
+    matches = absl::StrContains(member.drawing, value);
+  }
+  bool match = op.type() == finetoo::operations::v1::MATCH;
+  if (matches) {
+    for (const auto& node : nodes) {
+      result.add_node_ids(graph::NodeId(node));
+      result.add_provenance(graph::NodeId(node));
+      if (match) {
+        (*result.mutable_values())[op.property_name()] = value;
+        result.set_nodes_processed(1);
+        return result;
+      }
+    }
+  }
+
+  result.set_nodes_processed(nodes.size());
+  return result;
+}
+
+const finetoo::graph::v1::Node* OperationExecutor::FindByHandle(
+    uint64_t handle) {
+  if (!handles_indexed_) {
+    for (const auto& [type, collection] : graph_->nodes_by_type()) {
+      for (const auto& node : collection.nodes()) {
+        if (node.handle() != parser::kNoHandle) {
+          nodes_by_handle_.emplace(node.handle(), &node);
+        }
+      }
+    }
+    handles_indexed_ = true;
+  }
+
+  auto it = nodes_by_handle_.find(handle);
+  return it == nodes_by_handle_.end() ? nullptr : it->second;
+}
+
+const graph::AdjacencyIndex& OperationExecutor::Adjacency() {
+  if (columns_ != nullptr && !columns_->adjacency().empty()) {
+    return columns_->adjacency();
+  }
+  if (adjacency_.empty()) adjacency_ = graph::AdjacencyIndex::Build(*graph_);
+  return adjacency_;
+}
+
+std::pair<const graph::NodeTable*, size_t> OperationExecutor::FindRowByHandle(
+    uint64_t handle) {
+  if (!handles_indexed_) {
+    for (const auto& table : columns_->tables()) {
+      for (size_t row = 0; row < table->size(); row++) {
+        if (table->handle(row) != parser::kNoHandle) {
+          rows_by_handle_.emplace(table->handle(row),
+                                  std::make_pair(table.get(), row));
+        }
+      }
+    }
+    handles_indexed_ = true;
+  }
+
+  auto it = rows_by_handle_.find(handle);
+  if (it == rows_by_handle_.end()) return {nullptr, 0};
+  return it->second;
+}
+
+finetoo::operations::v1::OperationResult OperationExecutor::MatchColumns(
+    const std::string& target_type, const std::string& property_name,
+    const std::string& value) {
+  finetoo::operations::v1::OperationResult result;
+  auto add_match = [&](const graph::NodeTable& table, size_t row) {
+    std::string id = table.NodeId(row);
+    result.add_node_ids(id);
+    result.add_provenance(id);
+    (*result.mutable_values())[property_name] = value;
+    result.set_nodes_processed(1);
+  };
+
+  if (property_name == "handle") {
+    auto [table, row] = FindRowByHandle(parser::ParseHandle(value));
+    if (table != nullptr && table->type() == target_type) {
+      add_match(*table, row);
+    }
+    return result;
+  }
+
+  const graph::NodeTable* table = columns_->table(target_type);
+  if (table == nullptr) return result;
+
+  // Compare symbols: the value is looked up in the symbol table once
+  const graph::StringColumn* strings = table->strings(property_name);
+  std::optional<graph::Symbol> symbol;
+  if (strings != nullptr) symbol = strings->Find(value);
+  if (symbol.has_value()) {
+    for (size_t row = 0; row < strings->size(); row++) {
+      if (strings->values[row] == *symbol && strings->Has(row)) {
+        add_match(*table, row);
+        return result;
+      }
+    }
+  }
+
+  result.set_nodes_processed(table->size());
+  return result;
+}
+
+finetoo::operations::v1::OperationResult OperationExecutor::FilterColumns(
+    const std::string& target_type, const std::string& property_name,
+    const std::string& op_str, const std::string& value) {
+  finetoo::operations::v1::OperationResult result;
+  const graph::NodeTable* table = columns_->table(target_type);
+  if (table == nullptr) return result;
+
+  // As with nodes, the handle, then a string, then a numeric value of the
+  // property decide, the last one present winning
+  std::vector<uint8_t> matches(table->size(), 0);
+  bool equals = op_str == "EQUALS";
+  bool contains = op_str == "CONTAINS";
+
+  if (property_name == "handle" && (equals || contains)) {
+    const parser::DXFHandle handle = parser::ParseHandle(value);
+    for (size_t row = 0; row < table->size(); row++) {
+      uint64_t row_handle = table->handle(row);
+      if (row_handle == parser::kNoHandle) continue;
+      matches[row] = equals ? row_handle == handle
+                            : parser::FormatHandle(row_handle).find(value) !=
+                                  std::string::npos;
+    }
+  }
+
+  // Each distinct string is tested once, when a row first has it
+  const graph::StringColumn* strings = table->strings(property_name);
+  if (strings != nullptr && (equals || contains)) {
+    std::vector<int8_t> symbol_matches(strings->symbols->size(), -1);
+    strings->ForEach([&](size_t row) {
+      int8_t& match = symbol_matches[strings->values[row]];
+      if (match < 0) {
+        absl::string_view entry = strings->Get(row);
+        match = equals ? entry == value : absl::StrContains(entry, value);
+      }
+      matches[row] = match;
+    });
+  }
+
+  const graph::Column<double>* doubles = table->doubles(property_name);
+  bool greater = op_str == "GREATER_THAN";
+  bool less = op_str == "LESS_THAN";
+  double target_value = 0;
+  if (doubles != nullptr && (equals || greater || less) &&
+      absl::SimpleAtod(value, &target_value)) {
+    doubles->ForEach([&](size_t row) {
+      double row_value = doubles->values[row];
+      matches[row] = equals    ? row_value == target_value
+                     : greater ? row_value > target_value
+                               : row_value < target_value;
+    });
+  }
+
+  for (size_t row = 0; row < matches.size(); row++) {
+    if (!matches[row]) continue;
+    std::string id = table->NodeId(row);
+    result.add_node_ids(id);
+    result.add_provenance(id);
+  }
+
+  result.set_nodes_processed(table->size());
+  return result;
+}
+
+finetoo::operations::v1::OperationResult OperationExecutor::AggregateColumns(
+    const std::string& target_type, const std::string& property_name,
+    const std::string& function, const std::string* group_by) {
+  finetoo::operations::v1::OperationResult result;
+  const graph::NodeTable* table = columns_->table(target_type);
+  if (table == nullptr) return result;
+
+  // Count rows per symbol, then name the groups
+  if (group_by != nullptr) {
+    std::map<std::string, int64_t> counts;
+    int64_t grouped = 0;
+    const graph::StringColumn* strings = table->strings(*group_by);
+    if (strings != nullptr) {
+      absl::flat_hash_map<graph::Symbol, int64_t> symbol_counts;
+      strings->ForEach(
+          [&](size_t row) { symbol_counts[strings->values[row]]++; });
+      for (const auto& [symbol, count] : symbol_counts) {
+        counts[std::string(strings->symbols->Get(symbol))] += count;
+        grouped += count;
+      }
+    }
+    if (grouped < static_cast<int64_t>(table->size())) {
+      counts["unknown"] += table->size() - grouped;
+    }
+
+    for (size_t row = 0; row < table->size(); row++) {
+      result.add_provenance(table->NodeId(row));
+    }
+    for (const auto& [key, count] : counts) {
+      (*result.mutable_values())[key] = std::to_string(count);
+    }
+
+    result.set_nodes_processed(table->size());
+    return result;
+  }
+
+  if (function == "COUNT") {
+    int64_t count = table->size();
+    (*result.mutable_values())["count"] = std::to_string(count);
+    result.set_nodes_processed(count);
+  } else if (function == "SUM" || function == "AVG") {
+    SetTotals(function, *Sum(target_type, property_name), &result);
+  }
+
+  return result;
+}
+
+std::optional<OperationExecutor::Totals> OperationExecutor::Sum(
+    const std::string& target_type, const std::string& property_name) {
+  Totals totals;
+  if (columns_ != nullptr) {
+    const graph::NodeTable* table = columns_->table(target_type);
+    if (table == nullptr) return std::nullopt;
+    const graph::Column<double>* doubles = table->doubles(property_name);
+    if (doubles != nullptr) {
+      doubles->ForEach([&](size_t row) {
+        totals.sum += doubles->values[row];
+        totals.count++;
+      });
+    }
+    return totals;
+  }
+
+  const auto& nodes_by_type = graph_->nodes_by_type();
+  auto type_it = nodes_by_type.find(target_type);
+  if (type_it == nodes_by_type.end()) return std::nullopt;
+  for (const auto& node : type_it->second.nodes()) {
+    auto num_it = node.numeric_props().find(property_name);
+    if (num_it != node.numeric_props().end()) {
+      totals.sum += num_it->second;
+      totals.count++;
+    }
+  }
+  return totals;
+}
+
+void OperationExecutor::SetTotals(
+    const std::string& function, const Totals& totals,
+    finetoo::operations::v1::OperationResult* result) {
+  if (function == "SUM") {
+    (*result->mutable_values())["sum"] = std::to_string(totals.sum);
+  } else {
+    double avg = (totals.count > 0) ? (totals.sum / totals.count) : 0.0;
+    (*result->mutable_values())["avg"] = std::to_string(avg);
+  }
+  result->set_nodes_processed(totals.count);
+}
+
 // Operation implementations (skeletons)
 
 absl::StatusOr<finetoo::operations::v1::OperationResult>
@@ -60,6 +449,21 @@ OperationExecutor::Match(const finetoo::operations::v1::Operation& op) {
   }
 
   const std::string& value = it_value->second;
+  if (columns_ != nullptr) {
+    return MatchColumns(target_type, property_name, value);
+  }
+
+  // Handles are unique: answer from the index
+  if (property_name == "handle") {
+    const auto* node = FindByHandle(parser::ParseHandle(value));
+    if (node != nullptr && node->type() == target_type) {
+      result.add_node_ids(graph::NodeId(*node));
+      result.add_provenance(graph::NodeId(*node));
+      (*result.mutable_values())[property_name] = value;
+      result.set_nodes_processed(1);
+    }
+    return result;
+  }
 
   // Get nodes of target type
   const auto& nodes_by_type = graph_->nodes_by_type();
@@ -74,8 +478,8 @@ OperationExecutor::Match(const finetoo::operations::v1::Operation& op) {
     // Check string properties
     auto str_it = node.string_props().find(property_name);
     if (str_it != node.string_props().end() && str_it->second == value) {
-      result.add_node_ids(node.id());
-      result.add_provenance(node.id());
+      result.add_node_ids(graph::NodeId(node));
+      result.add_provenance(graph::NodeId(node));
       (*result.mutable_values())[property_name] = value;
       result.set_nodes_processed(1);
       return result;  // Return first match for unique property
@@ -103,6 +507,9 @@ OperationExecutor::Filter(const finetoo::operations::v1::Operation& op) {
 
   const std::string& value = it_value->second;
   const std::string op_str = (it_operator != op.parameters().end()) ? it_operator->second : "EQUALS";
+  if (columns_ != nullptr) {
+    return FilterColumns(target_type, property_name, op_str, value);
+  }
 
   // Get nodes of target type
   const auto& nodes_by_type = graph_->nodes_by_type();
@@ -113,12 +520,25 @@ OperationExecutor::Filter(const finetoo::operations::v1::Operation& op) {
   }
 
   // Filter nodes
+  const parser::DXFHandle handle = parser::ParseHandle(value);
+  double target_value = 0;
+  const bool numeric = absl::SimpleAtod(value, &target_value);
   int64_t processed = 0;
   for (const auto& node : type_it->second.nodes()) {
     processed++;
 
     bool matches = false;
 
+    // Handles are compared as integers
+    if (property_name == "handle" && node.handle() != parser::kNoHandle) {
+      if (op_str == "EQUALS") {
+        matches = (node.handle() == handle);
+      } else if (op_str == "CONTAINS") {
+        matches = parser::FormatHandle(node.handle()).find(value) !=
+                  std::string::npos;
+      }
+    }
+
     // Check string properties
     auto str_it = node.string_props().find(property_name);
     if (str_it != node.string_props().end()) {
@@ -131,24 +551,19 @@ OperationExecutor::Filter(const finetoo::operations::v1::Operation& op) {
 
     // Check numeric properties
     auto num_it = node.numeric_props().find(property_name);
-    if (num_it != node.numeric_props().end()) {
-      try {
-        double target_value = std::stod(value);
-        if (op_str == "EQUALS") {
-          matches = (num_it->second == target_value);
-        } else if (op_str == "GREATER_THAN") {
-          matches = (num_it->second > target_value);
-        } else if (op_str == "LESS_THAN") {
-          matches = (num_it->second < target_value);
-        }
-      } catch (...) {
-        // Ignore parse errors
+    if (num_it != node.numeric_props().end() && numeric) {
+      if (op_str == "EQUALS") {
+        matches = (num_it->second == target_value);
+      } else if (op_str == "GREATER_THAN") {
+        matches = (num_it->second > target_value);
+      } else if (op_str == "LESS_THAN") {
+        matches = (num_it->second < target_value);
       }
     }
 
     if (matches) {
-      result.add_node_ids(node.id());
-      result.add_provenance(node.id());
+      result.add_node_ids(graph::NodeId(node));
+      result.add_provenance(graph::NodeId(node));
     }
   }
 
@@ -176,50 +591,87 @@ OperationExecutor::Traverse(const finetoo::operations::v1::Operation& op) {
 
   const std::string& edge_type = it_edge_type->second;
 
-  // Get start nodes from previous operation result or filter
-  std::vector<std::string> start_nodes;
+  // Get start nodes from previous operation result or filter. An ID that
+  // reads as hex may name a node by handle.
+  absl::flat_hash_set<std::string> start_nodes;
+  absl::flat_hash_set<uint64_t> start_handles;
   if (it_start_nodes != op.parameters().end()) {
     // Parse comma-separated node IDs
     const std::string& node_ids_str = it_start_nodes->second;
     size_t start = 0;
-    size_t end = node_ids_str.find(',');
-    while (end != std::string::npos) {
-      start_nodes.push_back(node_ids_str.substr(start, end - start));
+    while (true) {
+      size_t end = node_ids_str.find(',', start);
+      std::string id = node_ids_str.substr(start, end - start);
+      parser::DXFHandle handle = parser::ParseHandle(id);
+      if (handle != parser::kNoHandle) start_handles.insert(handle);
+      start_nodes.insert(std::move(id));
+      if (end == std::string::npos) break;
       start = end + 1;
-      end = node_ids_str.find(',', start);
     }
-    start_nodes.push_back(node_ids_str.substr(start));
   }
 
-  // Traverse edges
-  int64_t processed = 0;
-  for (const auto& edge : graph_->edges()) {
-    if (edge.type() == edge_type) {
-      processed++;
-
-      // Check if this edge starts from one of our start nodes
-      bool should_traverse = start_nodes.empty();
-      if (!should_traverse) {
-        for (const auto& start_id : start_nodes) {
-          if (edge.source_node_id() == start_id) {
-            should_traverse = true;
-            break;
-          }
-        }
-      }
-
-      if (should_traverse) {
-        result.add_node_ids(edge.target_node_id());
-        result.add_provenance(edge.source_node_id() + " -> " + edge.target_node_id());
+  // Edges are followed source -> target, or target -> source with
+  // direction=IN (e.g. from a Layer node to the entities on it)
+  auto it_direction = op.parameters().find("direction");
+  bool inbound = it_direction != op.parameters().end() &&
+                 it_direction->second == "IN";
+
+  // Edges to follow: all of the type, or those of the start nodes, in
+  // graph order
+  const graph::AdjacencyIndex& adjacency = Adjacency();
+  absl::Span<const uint32_t> typed_edges = adjacency.Edges(edge_type);
+  std::vector<uint32_t> followed;
+  if (start_nodes.empty()) {
+    followed.assign(typed_edges.begin(), typed_edges.end());
+  } else {
+    absl::flat_hash_set<graph::NodeIndex> from;
+    for (const auto& id : start_nodes) {
+      if (auto node = adjacency.FindNode(id)) from.insert(*node);
+    }
+    for (uint64_t handle : start_handles) {
+      if (auto node = adjacency.FindNode(handle)) from.insert(*node);
+    }
+    for (graph::NodeIndex node : from) {
+      auto edges = inbound ? adjacency.InEdges(edge_type, node)
+                           : adjacency.OutEdges(edge_type, node);
+      followed.insert(followed.end(), edges.begin(), edges.end());
+    }
+    std::sort(followed.begin(), followed.end());
+  }
 
-        // Add edge properties to values
-        for (const auto& [key, value] : edge.properties()) {
-          (*result.mutable_values())[edge.target_node_id() + "." + key] = value;
-        }
+  // Indexed columns keep their edges in an EdgeTable
+  const graph::EdgeTable* edge_table =
+      columns_ != nullptr && &adjacency == &columns_->adjacency()
+          ? &columns_->edges()
+          : nullptr;
+  for (uint32_t index : followed) {
+    std::string source_id, target_id;
+    if (edge_table != nullptr) {
+      source_id = edge_table->SourceNodeId(index);
+      target_id = edge_table->TargetNodeId(index);
+    } else {
+      source_id = graph::SourceNodeId(graph_->edges(index));
+      target_id = graph::TargetNodeId(graph_->edges(index));
+    }
+    if (inbound) std::swap(source_id, target_id);
+    result.add_node_ids(target_id);
+    result.add_provenance(source_id + " -> " + target_id);
+
+    // Add edge properties to values
+    auto add_property = [&](absl::string_view key, absl::string_view value) {
+      (*result.mutable_values())[absl::StrCat(target_id, ".", key)] =
+          std::string(value);
+    };
+    if (edge_table != nullptr) {
+      edge_table->ForEachProperty(index, add_property);
+    } else {
+      for (const auto& [key, value] : graph_->edges(index).properties()) {
+        add_property(key, value);
       }
     }
   }
 
+  int64_t processed = typed_edges.size();
   result.set_nodes_processed(processed);
   return result;
 }
@@ -240,6 +692,11 @@ OperationExecutor::Aggregate(const finetoo::operations::v1::Operation& op) {
   const std::string& function = it_function->second;
   const std::string& target_type = op.target_type();
   const std::string& property_name = op.property_name();
+  if (columns_ != nullptr) {
+    return AggregateColumns(
+        target_type, property_name, function,
+        it_group_by != op.parameters().end() ? &it_group_by->second : nullptr);
+  }
 
   // Get nodes to aggregate
   std::vector<const finetoo::graph::v1::Node*> nodes_to_aggregate;
@@ -273,7 +730,7 @@ OperationExecutor::Aggregate(const finetoo::operations::v1::Operation& op) {
       }
 
       counts[group_key]++;
-      result.add_provenance(node.id());
+      result.add_provenance(graph::NodeId(node));
     }
 
     // Add results
@@ -291,25 +748,7 @@ OperationExecutor::Aggregate(const finetoo::operations::v1::Operation& op) {
     (*result.mutable_values())["count"] = std::to_string(count);
     result.set_nodes_processed(count);
   } else if (function == "SUM" || function == "AVG") {
-    double sum = 0.0;
-    int64_t count = 0;
-
-    for (const auto& node : type_it->second.nodes()) {
-      auto num_it = node.numeric_props().find(property_name);
-      if (num_it != node.numeric_props().end()) {
-        sum += num_it->second;
-        count++;
-      }
-    }
-
-    if (function == "SUM") {
-      (*result.mutable_values())["sum"] = std::to_string(sum);
-    } else {
-      double avg = (count > 0) ? (sum / count) : 0.0;
-      (*result.mutable_values())["avg"] = std::to_string(avg);
-    }
-
-    result.set_nodes_processed(count);
+    SetTotals(function, *Sum(target_type, property_name), &result);
   }
 
   return result;
@@ -3,9 +3,21 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "proto/graph.pb.h"
 #include "proto/operations.pb.h"
+#include "src/graph/adjacency_index.h"
+#include "src/graph/columnar_graph.h"
+#include "src/graph/graph_set.h"
 
 namespace finetoo::operations {
 
@@ -14,6 +26,15 @@ class OperationExecutor {
  public:
   explicit OperationExecutor(finetoo::graph::v1::PropertyGraph* graph);
 
+  // Execute against a graph's columns: Match, Filter and Aggregate scan
+  // column arrays rather than each node's property maps
+  explicit OperationExecutor(const graph::ColumnarGraph* graph);
+
+  // Execute across a set's members as if they were one graph: each
+  // operation runs on every member and their results are combined.
+  // GraphSet::kDrawingProperty is answered from each member's drawing.
+  explicit OperationExecutor(const graph::GraphSet* graphs);
+
   // Execute a single operation
   absl::StatusOr<finetoo::operations::v1::OperationResult> Execute(
       const finetoo::operations::v1::Operation& operation);
@@ -23,7 +44,64 @@ class OperationExecutor {
       const finetoo::operations::v1::OperationPlan& plan);
 
  private:
-  finetoo::graph::v1::PropertyGraph* graph_;
+  // Edges and the rest; without nodes when executing against columns_
+  const finetoo::graph::v1::PropertyGraph* graph_;
+  const graph::ColumnarGraph* columns_ = nullptr;
+
+  // Set executed across, with an executor per member
+  const graph::GraphSet* graphs_ = nullptr;
+  std::vector<std::unique_ptr<OperationExecutor>> members_;
+
+  // Execute on each of graphs_' members and combine the results
+  absl::StatusOr<finetoo::operations::v1::OperationResult> ExecuteAcross(
+      const finetoo::operations::v1::Operation& operation);
+
+  // Match, Filter or Aggregate on `member`'s drawing column
+  absl::StatusOr<finetoo::operations::v1::OperationResult> ExecuteOnDrawing(
+      const finetoo::operations::v1::Operation& op,
+      const graph::GraphSet::Member& member);
+
+  // Nodes by DXF handle, built on first use
+  absl::flat_hash_map<uint64_t, const finetoo::graph::v1::Node*>
+      nodes_by_handle_;
+  absl::flat_hash_map<uint64_t, std::pair<const graph::NodeTable*, size_t>>
+      rows_by_handle_;
+  bool handles_indexed_ = false;
+
+  // Edges by node: columns_' index, or one built on first use
+  graph::AdjacencyIndex adjacency_;
+  const graph::AdjacencyIndex& Adjacency();
+
+  // Node with `handle`, or null
+  const finetoo::graph::v1::Node* FindByHandle(uint64_t handle);
+
+  // Table and row of the node with `handle`, or {null, 0}
+  std::pair<const graph::NodeTable*, size_t> FindRowByHandle(uint64_t handle);
+
+  // Match, Filter and Aggregate against columns_, given their parameters
+  finetoo::operations::v1::OperationResult MatchColumns(
+      const std::string& target_type, const std::string& property_name,
+      const std::string& value);
+  finetoo::operations::v1::OperationResult FilterColumns(
+      const std::string& target_type, const std::string& property_name,
+      const std::string& op_str, const std::string& value);
+  finetoo::operations::v1::OperationResult AggregateColumns(
+      const std::string& target_type, const std::string& property_name,
+      const std::string& function, const std::string* group_by);
+
+  // Sum of target_type nodes' numeric `property_name`, over the nodes that
+  // have it, or nullopt if there are no target_type nodes. Kept unformatted
+  // so sums of several graphs combine exactly.
+  struct Totals {
+    double sum = 0.0;
+    int64_t count = 0;
+  };
+  std::optional<Totals> Sum(const std::string& target_type,
+                            const std::string& property_name);
+
+  // Set the "sum" or "avg" value of `totals`, as `function` asks
+  static void SetTotals(const std::string& function, const Totals& totals,
+                        finetoo::operations::v1::OperationResult* result);
 
   // 8 Generic Operation Primitives:
 
@@ -0,0 +1,208 @@
+// Copyright 2025 Finetoo
+// OperationExecutor Tests
+
+#include "src/operations/operation_executor.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/util/message_differencer.h"
+#include "src/graph/graph_set.h"
+#include "src/graph/test_drawings.h"
+
+namespace finetoo::operations {
+namespace {
+
+using graph::GraphSet;
+
+// INSERT of block PART, as in kPartDrawing
+struct Insert {
+  std::string handle;
+  std::string layer;
+  std::string x;
+};
+
+// kPartDrawing with `inserts` as its entities
+std::string Drawing(const std::vector<Insert>& inserts) {
+  std::string entities;
+  for (const Insert& insert : inserts) {
+    absl::StrAppend(&entities, "  0\nINSERT\n  5\n", insert.handle,
+                    "\n  8\n", insert.layer, "\n  2\nPART\n 10\n", insert.x,
+                    "\n 20\n2\n");
+  }
+  std::string dxf = graph::kPartDrawing;
+  size_t begin = dxf.find("  0\nINSERT");
+  dxf.replace(begin, dxf.find("  0\nENDSEC\n  0\nEOF") - begin, entities);
+  return dxf;
+}
+
+using Parameters = std::vector<std::pair<std::string, std::string>>;
+
+v1::Operation MakeOperation(v1::OperationType type,
+                            const std::string& property_name,
+                            Parameters parameters) {
+  v1::Operation operation;
+  operation.set_type(type);
+  operation.set_target_type("Entity");
+  operation.set_property_name(property_name);
+  for (auto& [key, value] : parameters) {
+    (*operation.mutable_parameters())[key] = std::move(value);
+  }
+  return operation;
+}
+
+class OperationExecutorTest : public ::testing::Test {
+ protected:
+  void Add(const std::string& drawing, const std::vector<Insert>& inserts) {
+    auto graph_or = graph::BuildGraph(Drawing(inserts));
+    ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+    graphs_.Add(drawing, *std::move(graph_or));
+  }
+
+  v1::OperationResult Execute(v1::OperationType type,
+                              const std::string& property_name,
+                              Parameters parameters) {
+    auto result_or = OperationExecutor(&graphs_).Execute(
+        MakeOperation(type, property_name, std::move(parameters)));
+    EXPECT_TRUE(result_or.ok()) << result_or.status();
+    return result_or.value_or(v1::OperationResult());
+  }
+
+  GraphSet graphs_;
+};
+
+TEST_F(OperationExecutorTest, AveragesAcrossDrawingsFromMemberSums) {
+  // Each member's sum rounds to 0.000001 or 0.000002 as six decimals; the
+  // raw sums give the true total and mean
+  Add("A.dxf", {{"1A", "WALLS", "0.0000014"}});
+  Add("B.dxf", {{"2A", "WALLS", "0.0000014"}});
+  Add("C.dxf", {{"3A", "WALLS", "0.0000019"}});
+
+  v1::OperationResult sum =
+      Execute(v1::AGGREGATE, "gc_10", {{"function", "SUM"}});
+  EXPECT_EQ(sum.values().at("sum"), "0.000005");
+  EXPECT_EQ(sum.nodes_processed(), 3);
+
+  v1::OperationResult average =
+      Execute(v1::AGGREGATE, "gc_10", {{"function", "AVG"}});
+  EXPECT_EQ(average.values().at("avg"), "0.000002");
+  EXPECT_EQ(average.values().count("sum"), 0);
+  EXPECT_EQ(average.nodes_processed(), 3);
+}
+
+TEST_F(OperationExecutorTest, CountsAcrossDrawingsStayIntegers) {
+  Add("A.dxf", {{"1A", "WALLS", "1"}, {"1B", "DOORS", "2"}});
+  Add("B.dxf", {{"2A", "WALLS", "3"}});
+
+  v1::OperationResult count =
+      Execute(v1::AGGREGATE, "type", {{"function", "COUNT"}});
+  EXPECT_EQ(count.values().at("count"), "3");
+
+  v1::OperationResult layers = Execute(
+      v1::AGGREGATE, "layer", {{"function", "COUNT"}, {"group_by", "layer"}});
+  EXPECT_EQ(layers.values().at("WALLS"), "2");
+  EXPECT_EQ(layers.values().at("DOORS"), "1");
+  EXPECT_EQ(layers.nodes_processed(), 3);
+}
+
+TEST_F(OperationExecutorTest, MatchStopsAtFirstDrawingWithAHit) {
+  Add("A.dxf", {{"1A", "WALLS", "1"}, {"1B", "WALLS", "2"}});
+  Add("B.dxf", {{"2A", "WALLS", "3"}, {"2B", "DOORS", "4"}});
+  Add("C.dxf", {{"3A", "DOORS", "5"}});
+
+  v1::OperationResult result =
+      Execute(v1::MATCH, "layer", {{"value", "DOORS"}});
+  ASSERT_EQ(result.node_ids_size(), 1);
+  EXPECT_EQ(result.node_ids(0), "2B");
+  EXPECT_EQ(result.values().at("layer"), "DOORS");
+  // All of A, and B up to its match; C isn't searched
+  EXPECT_EQ(result.nodes_processed(), 3);
+}
+
+TEST_F(OperationExecutorTest, FiltersAndGroupsOnTheDrawing) {
+  Add("A.dxf", {{"1A", "WALLS", "1"}, {"1B", "WALLS", "2"}});
+  Add("B.dxf", {{"2A", "WALLS", "3"}});
+  Add("C2.dxf", {{"3A", "WALLS", "4"}});
+  const std::string drawing(GraphSet::kDrawingProperty);
+
+  v1::OperationResult equal = Execute(
+      v1::FILTER, drawing, {{"operator", "EQUALS"}, {"value", "A.dxf"}});
+  EXPECT_EQ(std::vector<std::string>(equal.node_ids().begin(),
+                                     equal.node_ids().end()),
+            (std::vector<std::string>{"1A", "1B"}));
+  EXPECT_EQ(equal.nodes_processed(), 4);
+
+  v1::OperationResult containing = Execute(
+      v1::FILTER, drawing, {{"operator", "CONTAINS"}, {"value", "2"}});
+  EXPECT_EQ(std::vector<std::string>(containing.node_ids().begin(),
+                                     containing.node_ids().end()),
+            (std::vector<std::string>{"3A"}));
+
+  v1::OperationResult grouped = Execute(
+      v1::AGGREGATE, "type", {{"function", "COUNT"}, {"group_by", drawing}});
+  EXPECT_EQ(grouped.values().at("A.dxf"), "2");
+  EXPECT_EQ(grouped.values().at("B.dxf"), "1");
+  EXPECT_EQ(grouped.values().at("C2.dxf"), "1");
+  EXPECT_EQ(grouped.provenance_size(), 4);
+}
+
+TEST(OperationExecutorColumnsTest, MatchesTheNodeExecutor) {
+  std::string dxf = Drawing({{"1A", "WALLS", "1"},
+                             {"1B", "DOORS", "2.5"},
+                             {"2C", "WALLS", "4"},
+                             {"2D", "WINDOWS", "0.5"}});
+  auto graph_or = graph::BuildGraph(dxf);
+  ASSERT_TRUE(graph_or.ok()) << graph_or.status();
+  auto columns_or = graph::BuildColumnarGraph(dxf);
+  ASSERT_TRUE(columns_or.ok()) << columns_or.status();
+  OperationExecutor nodes(graph_or->get());
+  OperationExecutor columns(&*columns_or);
+
+  struct Case {
+    v1::OperationType type;
+    std::string property_name;
+    Parameters parameters;
+  };
+  const std::vector<Case> cases = {
+      {v1::MATCH, "handle", {{"value", "2C"}}},
+      {v1::MATCH, "handle", {{"value", "FF"}}},
+      {v1::MATCH, "layer", {{"value", "DOORS"}}},
+      {v1::MATCH, "layer", {{"value", "ROOF"}}},
+      {v1::FILTER, "handle", {{"operator", "EQUALS"}, {"value", "1B"}}},
+      {v1::FILTER, "handle", {{"operator", "CONTAINS"}, {"value", "2"}}},
+      {v1::FILTER, "layer", {{"operator", "EQUALS"}, {"value", "WALLS"}}},
+      {v1::FILTER, "layer", {{"operator", "CONTAINS"}, {"value", "W"}}},
+      {v1::FILTER, "gc_10", {{"operator", "GREATER_THAN"}, {"value", "1"}}},
+      {v1::FILTER, "gc_10", {{"operator", "LESS_THAN"}, {"value", "2.5"}}},
+      {v1::FILTER, "gc_10", {{"operator", "EQUALS"}, {"value", "4"}}},
+      {v1::FILTER, "gc_10", {{"operator", "GREATER_THAN"}, {"value", "x"}}},
+      {v1::AGGREGATE, "type", {{"function", "COUNT"}}},
+      {v1::AGGREGATE, "gc_10", {{"function", "SUM"}}},
+      {v1::AGGREGATE, "gc_10", {{"function", "AVG"}}},
+      {v1::AGGREGATE, "type", {{"function", "COUNT"}, {"group_by", "layer"}}},
+      {v1::AGGREGATE, "type", {{"function", "COUNT"}, {"group_by", "none"}}},
+      {v1::TRAVERSE, "", {{"edge_type", "REFERENCES"}}},
+      {v1::TRAVERSE, "", {{"edge_type", "BELONGS_TO"},
+                          {"start_node_ids", "1A,2D"}}},
+  };
+  for (const Case& c : cases) {
+    v1::Operation operation =
+        MakeOperation(c.type, c.property_name, c.parameters);
+    SCOPED_TRACE(operation.ShortDebugString());
+    auto expected_or = nodes.Execute(operation);
+    auto actual_or = columns.Execute(operation);
+    ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+    ASSERT_TRUE(actual_or.ok()) << actual_or.status();
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+        *actual_or, *expected_or))
+        << "columns: " << actual_or->ShortDebugString()
+        << "\nnodes: " << expected_or->ShortDebugString();
+  }
+}
+
+}  // namespace
+}  // namespace finetoo::operations
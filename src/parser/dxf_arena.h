@@ -0,0 +1,89 @@
+// Copyright 2025 Finetoo
+// DXF Arena - Bump allocation for parsed drawings
+//
+// A DXFFile's entities, blocks and pair arrays are carved out of arenas the
+// file owns: allocation is a pointer bump, nothing is freed individually,
+// and everything is released at once when the file goes away. Containers
+// use DXFArenaAllocator, which falls back to the heap when given no arena,
+// so entities built by hand (or copied out of a file) work as before.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace finetoo::parser {
+
+class DXFArena {
+ public:
+  DXFArena() : memory_(kInitialBlockSize) {}
+
+  // Non-copyable, non-movable (allocations point into this object's blocks)
+  DXFArena(const DXFArena&) = delete;
+  DXFArena& operator=(const DXFArena&) = delete;
+
+  // Not thread-safe: each parser thread fills its own arena
+  void* Allocate(size_t size, size_t alignment) {
+    return memory_.allocate(size, alignment);
+  }
+
+ private:
+  // First block; later ones grow geometrically
+  static constexpr size_t kInitialBlockSize = 64 << 10;
+
+  std::pmr::monotonic_buffer_resource memory_;
+};
+
+// Allocates from a DXFArena, or from the heap when it has none. Arena memory
+// is only returned with the arena, so deallocating is free and a container
+// never touches its arena again once it is empty. Copies of a container go
+// to the heap, independent of the file they were taken from.
+template <typename T>
+class DXFArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  DXFArenaAllocator() = default;
+  DXFArenaAllocator(DXFArena* arena) : arena_(arena) {}  // NOLINT: implicit
+  template <typename U>
+  DXFArenaAllocator(const DXFArenaAllocator<U>& other)  // NOLINT: implicit
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ == nullptr) return std::allocator<T>().allocate(n);
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (arena_ == nullptr) std::allocator<T>().deallocate(p, n);
+  }
+
+  DXFArenaAllocator select_on_container_copy_construction() const {
+    return DXFArenaAllocator();
+  }
+
+  DXFArena* arena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const DXFArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+
+ private:
+  DXFArena* arena_ = nullptr;
+};
+
+template <typename T>
+using DXFVector = std::vector<T, DXFArenaAllocator<T>>;
+
+// Element addresses survive appends, so lookups can point into it
+template <typename T>
+using DXFDeque = std::deque<T, DXFArenaAllocator<T>>;
+
+}  // namespace finetoo::parser
@@ -0,0 +1,40 @@
+// Copyright 2025 Finetoo
+// DXF Binary Implementation
+
+#include "src/parser/dxf_binary.h"
+
+namespace finetoo::parser {
+
+DXFBinaryValue BinaryValueType(int group_code) {
+  if ((group_code >= 10 && group_code <= 59) ||
+      (group_code >= 110 && group_code <= 149) ||
+      (group_code >= 210 && group_code <= 239) ||
+      (group_code >= 460 && group_code <= 469) ||
+      (group_code >= 1010 && group_code <= 1059)) {
+    return DXFBinaryValue::kDouble;
+  }
+  if ((group_code >= 60 && group_code <= 79) ||
+      (group_code >= 170 && group_code <= 179) ||
+      (group_code >= 270 && group_code <= 289) ||
+      (group_code >= 370 && group_code <= 389) ||
+      (group_code >= 400 && group_code <= 409) ||
+      (group_code >= 1060 && group_code <= 1070)) {
+    return DXFBinaryValue::kInt16;
+  }
+  if ((group_code >= 90 && group_code <= 99) ||
+      (group_code >= 420 && group_code <= 459) || group_code == 1071) {
+    return DXFBinaryValue::kInt32;
+  }
+  if (group_code >= 160 && group_code <= 169) {
+    return DXFBinaryValue::kInt64;
+  }
+  if (group_code >= 290 && group_code <= 299) {
+    return DXFBinaryValue::kBool;
+  }
+  if ((group_code >= 310 && group_code <= 319) || group_code == 1004) {
+    return DXFBinaryValue::kBytes;
+  }
+  return DXFBinaryValue::kString;
+}
+
+}  // namespace finetoo::parser
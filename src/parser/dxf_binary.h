@@ -0,0 +1,39 @@
+// Copyright 2025 Finetoo
+// DXF Binary - Layout of binary DXF files
+//
+// Binary DXF starts with a 22-byte sentinel, followed by group code / value
+// pairs with little-endian binary fields. Group codes are 2 bytes (R13 and
+// later) or 1 byte with 255 escaping a 2-byte code (R12). Each value's
+// encoding follows from its group code range. DXFTokenizer reads both
+// formats; this header only describes the encoding.
+
+#pragma once
+
+#include "absl/strings/string_view.h"
+
+namespace finetoo::parser {
+
+// First bytes of every binary DXF file
+inline constexpr absl::string_view kBinaryDXFSentinel(
+    "AutoCAD Binary DXF\r\n\x1a\0", 22);
+
+// True if `input` starts with the binary DXF sentinel
+inline bool IsBinaryDXF(absl::string_view input) {
+  return input.substr(0, kBinaryDXFSentinel.size()) == kBinaryDXFSentinel;
+}
+
+// Encoding of a value in binary DXF
+enum class DXFBinaryValue {
+  kString,  // '\0'-terminated
+  kDouble,  // 8 bytes
+  kInt16,   // 2 bytes
+  kInt32,   // 4 bytes
+  kInt64,   // 8 bytes
+  kBool,    // 1 byte
+  kBytes,   // 1 length byte, then that many bytes
+};
+
+// Value encoding for a group code, from the DXF reference's code ranges
+DXFBinaryValue BinaryValueType(int group_code);
+
+}  // namespace finetoo::parser
@@ -0,0 +1,101 @@
+// Copyright 2025 Finetoo
+// DXF Buffer Implementation
+
+#include "src/parser/dxf_buffer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+
+namespace finetoo::parser {
+
+absl::StatusOr<std::shared_ptr<const DXFBuffer>> DXFBuffer::Map(
+    absl::string_view file_path) {
+  std::string path(file_path);
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(
+        absl::StrFormat("Cannot open file: %s (%s)", file_path, strerror(errno)));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return Read(file_path);
+  }
+
+  auto buffer = std::shared_ptr<DXFBuffer>(new DXFBuffer());
+  if (st.st_size == 0) {
+    close(fd);
+    return buffer;
+  }
+
+  void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping keeps its own reference to the file
+  if (addr == MAP_FAILED) {
+    return Read(file_path);
+  }
+
+  // DXF is parsed front to back; let the kernel read ahead aggressively
+  madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+  buffer->data_ = static_cast<const char*>(addr);
+  buffer->size_ = st.st_size;
+  buffer->mapped_ = true;
+  return buffer;
+}
+
+absl::StatusOr<std::shared_ptr<const DXFBuffer>> DXFBuffer::Read(
+    absl::string_view file_path) {
+  std::ifstream input{std::string{file_path}, std::ios::binary};
+  if (!input.is_open()) {
+    return absl::NotFoundError(absl::StrFormat("Cannot open file: %s", file_path));
+  }
+
+  std::ostringstream contents;
+  contents << input.rdbuf();
+  return FromString(std::move(contents).str());
+}
+
+std::shared_ptr<const DXFBuffer> DXFBuffer::FromString(std::string contents) {
+  auto buffer = std::shared_ptr<DXFBuffer>(new DXFBuffer());
+  buffer->owned_ = std::move(contents);
+  buffer->data_ = buffer->owned_.data();
+  buffer->size_ = buffer->owned_.size();
+  return buffer;
+}
+
+std::shared_ptr<DXFBuffer> DXFBuffer::ForStreaming() {
+  return std::shared_ptr<DXFBuffer>(new DXFBuffer());
+}
+
+char* DXFBuffer::AllocateBlock(size_t size) {
+  blocks_.push_back({std::make_unique_for_overwrite<char[]>(size), size});
+  block_bytes_ += size;
+  return blocks_.back().data.get();
+}
+
+void DXFBuffer::ReleaseOldBlocks() {
+  if (blocks_.size() < 2) return;
+  Block last = std::move(blocks_.back());
+  blocks_.clear();
+  block_bytes_ = last.size;
+  blocks_.push_back(std::move(last));
+}
+
+DXFBuffer::~DXFBuffer() {
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+}  // namespace finetoo::parser
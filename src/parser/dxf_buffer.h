@@ -0,0 +1,80 @@
+// Copyright 2025 Finetoo
+// DXF Buffer - Read-only backing storage for zero-copy parsing
+//
+// Parsed DXF values are string_views into a DXFBuffer. Files on disk are
+// memory-mapped; streamed input is copied once onto the heap. Either way the
+// bytes never move, so views stay valid for as long as the buffer is alive.
+// Streams are read in blocks as they are tokenized and each block is kept.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace finetoo::parser {
+
+class DXFBuffer {
+ public:
+  // Memory-map a file read-only. Falls back to reading it onto the heap if
+  // the path is not a regular file (e.g. a FIFO or /dev/stdin).
+  static absl::StatusOr<std::shared_ptr<const DXFBuffer>> Map(
+      absl::string_view file_path);
+
+  // Read a whole file onto the heap without mapping it.
+  static absl::StatusOr<std::shared_ptr<const DXFBuffer>> Read(
+      absl::string_view file_path);
+
+  // Take ownership of bytes already in memory.
+  static std::shared_ptr<const DXFBuffer> FromString(std::string contents);
+
+  // Empty buffer that a streamed input is appended to block by block
+  static std::shared_ptr<DXFBuffer> ForStreaming();
+
+  ~DXFBuffer();
+
+  // Non-copyable, non-movable (views point into this object's storage)
+  DXFBuffer(const DXFBuffer&) = delete;
+  DXFBuffer& operator=(const DXFBuffer&) = delete;
+
+  // Whole input. Empty for streamed buffers, whose bytes live in blocks.
+  absl::string_view contents() const { return {data_, size_}; }
+
+  // Total bytes held
+  size_t size() const { return size_ + block_bytes_; }
+
+  // Allocate a block of `size` bytes owned by this buffer (streaming only).
+  // Blocks are never moved, and only freed by ReleaseOldBlocks().
+  char* AllocateBlock(size_t size);
+
+  // Free every block but the most recent one. For consumers that are done
+  // with earlier input and want to stream in constant memory.
+  void ReleaseOldBlocks();
+
+  // True if the bytes are an mmap(2) of the source file
+  bool is_mapped() const { return mapped_; }
+
+ private:
+  DXFBuffer() = default;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+
+  // Heap storage when not mapped
+  std::string owned_;
+
+  // Heap storage for streamed input
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+  std::vector<Block> blocks_;
+  size_t block_bytes_ = 0;
+};
+
+}  // namespace finetoo::parser
@@ -0,0 +1,243 @@
+// Copyright 2025 Finetoo
+// DXF Decompress Implementation
+
+#include "src/parser/dxf_decompress.h"
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+namespace finetoo::parser {
+
+namespace {
+
+// Decompressed bytes per block handed to the reader
+constexpr size_t kBlockSize = 1 << 20;
+
+// Blocks decompressed ahead of the reader
+constexpr size_t kMaxReadyBlocks = 4;
+
+// Compressed bytes read from a stream at a time
+constexpr size_t kInputBlockSize = 1 << 20;
+
+// Largest piece of in-memory input fed to the decoder at once (zlib counts
+// input in 32-bit integers)
+constexpr size_t kMaxInputPiece = size_t{1} << 30;
+
+}  // namespace
+
+DXFCompression DetectCompression(absl::string_view prefix) {
+  if (prefix.substr(0, 2) == "\x1f\x8b") return DXFCompression::kGzip;
+  if (prefix.substr(0, 4) == "\x28\xb5\x2f\xfd") return DXFCompression::kZstd;
+  return DXFCompression::kNone;
+}
+
+DXFCompression DetectCompression(std::istream& input) {
+  switch (input.peek()) {
+    case 0x1f:
+      return DXFCompression::kGzip;
+    case 0x28:
+      return DXFCompression::kZstd;
+    default:
+      return DXFCompression::kNone;
+  }
+}
+
+DecompressingStreamBuf::DecompressingStreamBuf(DXFCompression compression,
+                                               absl::string_view input)
+    : compression_(compression), input_(input) {
+  Start();
+}
+
+DecompressingStreamBuf::DecompressingStreamBuf(DXFCompression compression,
+                                               std::istream& input)
+    : compression_(compression), stream_(&input) {
+  Start();
+}
+
+DecompressingStreamBuf::~DecompressingStreamBuf() {
+  {
+    absl::MutexLock lock(&mu_);
+    cancelled_ = true;
+  }
+  worker_.join();
+}
+
+void DecompressingStreamBuf::Start() {
+  worker_ = std::thread([this]() { Run(); });
+}
+
+absl::Status DecompressingStreamBuf::status() const {
+  absl::MutexLock lock(&mu_);
+  return status_;
+}
+
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+  {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &DecompressingStreamBuf::HasBlockOrDone));
+    if (ready_.empty()) return traits_type::eof();
+    current_ = std::move(ready_.front());
+    ready_.pop_front();
+  }
+
+  char* begin = current_.data();
+  setg(begin, begin, begin + current_.size());
+  return traits_type::to_int_type(*gptr());
+}
+
+bool DecompressingStreamBuf::HasBlockOrDone() const {
+  return !ready_.empty() || done_;
+}
+
+bool DecompressingStreamBuf::HasRoomOrCancelled() const {
+  return ready_.size() < kMaxReadyBlocks || cancelled_;
+}
+
+void DecompressingStreamBuf::Run() {
+  absl::Status status =
+      compression_ == DXFCompression::kGzip ? Inflate() : Unzstd();
+
+  absl::MutexLock lock(&mu_);
+  status_ = std::move(status);
+  done_ = true;
+}
+
+bool DecompressingStreamBuf::ReadInput(absl::string_view* piece) {
+  if (stream_ == nullptr) {
+    if (input_.empty()) return false;
+    *piece = input_.substr(0, kMaxInputPiece);
+    input_.remove_prefix(piece->size());
+    return true;
+  }
+
+  input_block_.resize(kInputBlockSize);
+  stream_->read(input_block_.data(), input_block_.size());
+  size_t bytes_read = stream_->gcount();
+  if (bytes_read == 0) return false;
+  *piece = absl::string_view(input_block_.data(), bytes_read);
+  return true;
+}
+
+bool DecompressingStreamBuf::Publish(std::string block) {
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(this, &DecompressingStreamBuf::HasRoomOrCancelled));
+  if (cancelled_) return false;
+  ready_.push_back(std::move(block));
+  return true;
+}
+
+absl::Status DecompressingStreamBuf::Inflate() {
+  z_stream z{};
+  if (inflateInit2(&z, 15 + 16) != Z_OK) {
+    return absl::InternalError("Failed to initialize gzip decoder");
+  }
+
+  absl::Status status;
+  std::string block(kBlockSize, '\0');
+  size_t filled = 0;
+  bool member_done = false;  // At the end of a gzip member
+  bool output_full = false;  // The decoder may hold more output
+  absl::string_view piece;
+  while (true) {
+    if (z.avail_in == 0 && !output_full) {
+      if (!ReadInput(&piece)) break;
+      z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(piece.data()));
+      z.avail_in = piece.size();
+    }
+
+    // Another member follows the one just finished
+    if (member_done) {
+      if (z.avail_in == 0) break;
+      inflateReset(&z);
+      member_done = false;
+    }
+
+    z.next_out = reinterpret_cast<Bytef*>(block.data() + filled);
+    z.avail_out = block.size() - filled;
+    int ret = inflate(&z, Z_NO_FLUSH);
+    filled = block.size() - z.avail_out;
+    if (ret == Z_STREAM_END) {
+      member_done = true;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      status = absl::DataLossError(absl::StrFormat(
+          "Corrupt gzip input: %s", z.msg != nullptr ? z.msg : "unknown"));
+      break;
+    }
+
+    output_full = filled == block.size();
+    if (output_full) {
+      if (!Publish(std::move(block))) break;
+      block.assign(kBlockSize, '\0');
+      filled = 0;
+    } else if (ret == Z_BUF_ERROR && z.avail_in > 0) {
+      status = absl::DataLossError("Corrupt gzip input");
+      break;
+    }
+  }
+  inflateEnd(&z);
+
+  if (status.ok() && !member_done) {
+    status = absl::DataLossError("Truncated gzip input");
+  }
+  if (filled > 0) {
+    block.resize(filled);
+    Publish(std::move(block));
+  }
+  return status;
+}
+
+absl::Status DecompressingStreamBuf::Unzstd() {
+  ZSTD_DCtx* context = ZSTD_createDCtx();
+  if (context == nullptr) {
+    return absl::InternalError("Failed to initialize zstd decoder");
+  }
+
+  absl::Status status;
+  std::string block(kBlockSize, '\0');
+  ZSTD_outBuffer out{block.data(), block.size(), 0};
+  ZSTD_inBuffer in{nullptr, 0, 0};
+  size_t ret = 0;  // 0 once a frame is complete
+  bool any_input = false;
+  bool output_full = false;  // The decoder may hold more output
+  absl::string_view piece;
+  while (true) {
+    if (in.pos == in.size && !output_full) {
+      if (!ReadInput(&piece)) break;
+      in = ZSTD_inBuffer{piece.data(), piece.size(), 0};
+      any_input = true;
+    }
+
+    ret = ZSTD_decompressStream(context, &out, &in);
+    if (ZSTD_isError(ret)) {
+      status = absl::DataLossError(
+          absl::StrFormat("Corrupt zstd input: %s", ZSTD_getErrorName(ret)));
+      break;
+    }
+
+    output_full = out.pos == out.size;
+    if (output_full) {
+      if (!Publish(std::move(block))) break;
+      block.assign(kBlockSize, '\0');
+      out = ZSTD_outBuffer{block.data(), block.size(), 0};
+    }
+  }
+  ZSTD_freeDCtx(context);
+
+  if (status.ok() && (ret != 0 || !any_input)) {
+    status = absl::DataLossError("Truncated zstd input");
+  }
+  if (out.pos > 0) {
+    block.resize(out.pos);
+    Publish(std::move(block));
+  }
+  return status;
+}
+
+}  // namespace finetoo::parser
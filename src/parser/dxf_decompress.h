@@ -0,0 +1,98 @@
+// Copyright 2025 Finetoo
+// DXF Decompress - Transparent gzip / zstd input
+//
+// Compressed drawings are recognized by their magic number and inflated on
+// a background thread into a std::streambuf, so the tokenizer works on one
+// block while the next is being decompressed. No temporary files.
+
+#pragma once
+
+#include <deque>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace finetoo::parser {
+
+// Input compression, recognized by magic number
+enum class DXFCompression {
+  kNone,
+  kGzip,  // 1f 8b
+  kZstd,  // 28 b5 2f fd
+};
+
+// Compression of an input starting with `prefix` (4 bytes suffice)
+DXFCompression DetectCompression(absl::string_view prefix);
+
+// Compression of a stream, judged by its first byte without consuming it.
+// Neither magic number can start an ASCII or binary DXF file; a wrong
+// guess surfaces as a decompression error.
+DXFCompression DetectCompression(std::istream& input);
+
+// Read-only stream buffer over the decompressed bytes of a gzip or zstd
+// input. Concatenated gzip members / zstd frames are read in sequence.
+class DecompressingStreamBuf : public std::streambuf {
+ public:
+  // Decompress `input`, which must outlive this object
+  DecompressingStreamBuf(DXFCompression compression, absl::string_view input);
+
+  // Decompress the rest of `input`, which must outlive this object and is
+  // only read from the background thread
+  DecompressingStreamBuf(DXFCompression compression, std::istream& input);
+
+  // Stops and joins the background thread
+  ~DecompressingStreamBuf() override;
+
+  DecompressingStreamBuf(const DecompressingStreamBuf&) = delete;
+  DecompressingStreamBuf& operator=(const DecompressingStreamBuf&) = delete;
+
+  // Error that ended the output early (corrupt or truncated input). Check
+  // it once the stream reports end of file.
+  absl::Status status() const;
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  void Start();
+
+  // Background thread body
+  void Run();
+  absl::Status Inflate();
+  absl::Status Unzstd();
+
+  // Read the next piece of compressed input. False at end of input.
+  bool ReadInput(absl::string_view* piece);
+
+  // Hand a decompressed block to the reader, waiting while kMaxReadyBlocks
+  // are queued. False if the reader went away.
+  bool Publish(std::string block);
+
+  // Await() conditions
+  bool HasBlockOrDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool HasRoomOrCancelled() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const DXFCompression compression_;
+  absl::string_view input_;
+  std::istream* stream_ = nullptr;
+  std::string input_block_;
+
+  mutable absl::Mutex mu_;
+  std::deque<std::string> ready_ ABSL_GUARDED_BY(mu_);
+  bool done_ ABSL_GUARDED_BY(mu_) = false;
+  bool cancelled_ ABSL_GUARDED_BY(mu_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+
+  // Block currently exposed through the get area
+  std::string current_;
+
+  std::thread worker_;
+};
+
+}  // namespace finetoo::parser
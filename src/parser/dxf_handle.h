@@ -0,0 +1,47 @@
+// Copyright 2025 Finetoo
+// DXF Handle - Entity handles as integers
+//
+// Handles (group code 5) are hexadecimal numbers of up to 64 bits. They are
+// decoded once while parsing and carried as integers from then on, so maps
+// keyed by handle hash and compare a single word. Hex text is only produced
+// again where handles leave the program (reports, provenance).
+
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+#include "absl/strings/string_view.h"
+
+namespace finetoo::parser {
+
+using DXFHandle = uint64_t;
+
+// Handle of an entity without one (0 is never assigned by AutoCAD)
+inline constexpr DXFHandle kNoHandle = 0;
+
+// Decode hex handle text ("1F", "2a"). kNoHandle if `text` is empty, not
+// plain hex or wider than 64 bits.
+inline DXFHandle ParseHandle(absl::string_view text) {
+  DXFHandle handle = kNoHandle;
+  const char* end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, handle, 16);
+  if (ec != std::errc() || ptr != end) return kNoHandle;
+  return handle;
+}
+
+// Upper-case hex text of a handle, as AutoCAD writes it. Empty for
+// kNoHandle.
+inline std::string FormatHandle(DXFHandle handle) {
+  if (handle == kNoHandle) return std::string();
+  char text[16];
+  auto [end, ec] = std::to_chars(text, text + sizeof(text), handle, 16);
+  for (char* p = text; p < end; p++) {
+    if (*p >= 'a') *p -= 'a' - 'A';
+  }
+  return std::string(text, end);
+}
+
+}  // namespace finetoo::parser
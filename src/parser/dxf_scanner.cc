@@ -0,0 +1,211 @@
+// Copyright 2025 Finetoo
+// DXF Scanner Implementation
+
+#include "src/parser/dxf_scanner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace finetoo::parser {
+
+namespace {
+
+// Bytes examined per SIMD step (and newline slots that must be free first)
+constexpr size_t kStride = 64;
+
+// Record offsets of '\n' in data[0, size) into `out`. Stops at a stride
+// boundary once fewer than kStride slots remain. Returns the number of
+// offsets written; *scanned is how many leading bytes were examined.
+using FindNewlinesFn = size_t (*)(const char* data, size_t size, uint32_t* out,
+                                  size_t capacity, size_t* scanned);
+
+inline size_t EmitMask(uint64_t mask, uint32_t base, uint32_t* out) {
+  size_t count = 0;
+  while (mask != 0) {
+    out[count++] = base + __builtin_ctzll(mask);
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+inline size_t FindNewlinesTail(const char* data, size_t begin, size_t size,
+                               uint32_t* out) {
+  size_t count = 0;
+  for (size_t i = begin; i < size; i++) {
+    if (data[i] == '\n') out[count++] = i;
+  }
+  return count;
+}
+
+size_t FindNewlinesScalar(const char* data, size_t size, uint32_t* out,
+                          size_t capacity, size_t* scanned) {
+  size_t count = 0;
+  const char* p = data;
+  const char* end = data + size;
+  while (count < capacity) {
+    const void* newline = memchr(p, '\n', end - p);
+    if (newline == nullptr) {
+      *scanned = size;
+      return count;
+    }
+    out[count++] = static_cast<const char*>(newline) - data;
+    p = static_cast<const char*>(newline) + 1;
+  }
+  *scanned = p - data;
+  return count;
+}
+
+#if defined(__x86_64__)
+
+size_t FindNewlinesSSE2(const char* data, size_t size, uint32_t* out,
+                        size_t capacity, size_t* scanned) {
+  const __m128i newline = _mm_set1_epi8('\n');
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + kStride <= size && capacity - count >= kStride; i += kStride) {
+    const __m128i* p = reinterpret_cast<const __m128i*>(data + i);
+    uint64_t m0 = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p), newline)));
+    uint64_t m1 = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 1), newline)));
+    uint64_t m2 = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 2), newline)));
+    uint64_t m3 = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 3), newline)));
+    count += EmitMask(m0 | (m1 << 16) | (m2 << 32) | (m3 << 48), i, out + count);
+  }
+  if (i + kStride > size && capacity - count >= kStride) {
+    count += FindNewlinesTail(data, i, size, out + count);
+    i = size;
+  }
+  *scanned = i;
+  return count;
+}
+
+__attribute__((target("avx2")))
+size_t FindNewlinesAVX2(const char* data, size_t size, uint32_t* out,
+                        size_t capacity, size_t* scanned) {
+  const __m256i newline = _mm256_set1_epi8('\n');
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + kStride <= size && capacity - count >= kStride; i += kStride) {
+    const __m256i* p = reinterpret_cast<const __m256i*>(data + i);
+    uint64_t lo = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p), newline)));
+    uint64_t hi = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(p + 1), newline)));
+    count += EmitMask(lo | (hi << 32), i, out + count);
+  }
+  if (i + kStride > size && capacity - count >= kStride) {
+    count += FindNewlinesTail(data, i, size, out + count);
+    i = size;
+  }
+  *scanned = i;
+  return count;
+}
+
+#endif  // __x86_64__
+
+FindNewlinesFn KernelFunction(ScanKernel kernel) {
+#if defined(__x86_64__)
+  switch (kernel) {
+    case ScanKernel::kAVX2:
+      return FindNewlinesAVX2;
+    case ScanKernel::kSSE2:
+      return FindNewlinesSSE2;
+    case ScanKernel::kScalar:
+      break;
+  }
+#endif
+  return FindNewlinesScalar;
+}
+
+// Same set as absl::ascii_isspace: ' ', \t, \n, \v, \f, \r
+inline bool IsSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+// Parse a group code line: optional whitespace, optional sign, up to nine
+// decimal digits, optional whitespace. Anything else is left to the
+// tokenizer's slow path.
+inline bool ParseGroupCode(const char* p, const char* end, int32_t* code) {
+  while (p < end && IsSpace(*p)) p++;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = (*p == '-');
+    p++;
+  }
+
+  const char* digits = p;
+  int32_t value = 0;
+  while (p < end && *p >= '0' && *p <= '9' && p - digits < 9) {
+    value = value * 10 + (*p - '0');
+    p++;
+  }
+  if (p == digits) return false;
+
+  while (p < end && IsSpace(*p)) p++;
+  if (p != end) return false;
+
+  *code = negative ? -value : value;
+  return true;
+}
+
+}  // namespace
+
+ScanKernel BestScanKernel() {
+#if defined(__x86_64__)
+  static const ScanKernel kernel = __builtin_cpu_supports("avx2")
+                                       ? ScanKernel::kAVX2
+                                       : ScanKernel::kSSE2;
+  return kernel;
+#else
+  return ScanKernel::kScalar;
+#endif
+}
+
+size_t ScanPairs(absl::string_view input, size_t max_tokens,
+                 std::vector<DXFToken>* tokens, ScanKernel kernel) {
+  tokens->clear();
+
+  const char* data = input.data();
+  size_t size = std::min<size_t>(input.size(),
+                                 std::numeric_limits<uint32_t>::max());
+
+  // Two lines per pair, plus room for one more stride of newlines
+  thread_local std::vector<uint32_t> newlines;
+  newlines.resize(2 * max_tokens + kStride);
+
+  size_t scanned = 0;
+  size_t count = KernelFunction(kernel)(data, size, newlines.data(),
+                                        newlines.size(), &scanned);
+
+  size_t line_start = 0;
+  for (size_t i = 0; i + 1 < count && tokens->size() < max_tokens; i += 2) {
+    uint32_t code_end = newlines[i];
+    uint32_t value_end = newlines[i + 1];
+
+    int32_t group_code;
+    if (!ParseGroupCode(data + line_start, data + code_end, &group_code)) {
+      break;
+    }
+
+    // Trim the value the way absl::StripAsciiWhitespace would
+    uint32_t value_begin = code_end + 1;
+    uint32_t value_stop = value_end;
+    while (value_begin < value_stop && IsSpace(data[value_begin])) value_begin++;
+    while (value_stop > value_begin && IsSpace(data[value_stop - 1])) value_stop--;
+
+    tokens->push_back(
+        DXFToken{group_code, value_begin, value_stop - value_begin});
+    line_start = value_end + 1;
+  }
+
+  return line_start;
+}
+
+}  // namespace finetoo::parser
@@ -0,0 +1,49 @@
+// Copyright 2025 Finetoo
+// DXF Scanner - Vectorized group code / value pair scanning
+//
+// Finds line boundaries 64 bytes at a time (AVX2 or SSE2, chosen at runtime,
+// with a portable fallback) and decodes whole runs of pairs into a flat
+// array of (group_code, value_offset, value_length) records. The tokenizer
+// serves pairs out of these batches; anything unusual (a malformed group
+// code, a pair cut off by the end of the input) is left for its slow path.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace finetoo::parser {
+
+// One pair located in a scanned buffer. Offsets are relative to the start of
+// the input passed to ScanPairs.
+struct DXFToken {
+  int32_t group_code;
+  uint32_t value_offset;  // First byte of the trimmed value
+  uint32_t value_length;
+};
+
+// Newline search implementation
+enum class ScanKernel {
+  kScalar,
+  kSSE2,
+  kAVX2,
+};
+
+// Fastest kernel supported by this CPU. Passing a kernel the CPU lacks to
+// ScanPairs is undefined; SSE2 is always available on x86-64 and every
+// kernel falls back to scalar on other architectures.
+ScanKernel BestScanKernel();
+
+// Decode up to `max_tokens` complete pairs from the front of `input` into
+// `tokens` (cleared first). Stops before the first pair that is not
+// newline-terminated or whose group code is not a plain decimal integer.
+// Returns the number of bytes consumed. Values are whitespace-trimmed, as
+// in DXFTokenizer. Inputs past 4 GiB are scanned only up to that point.
+size_t ScanPairs(absl::string_view input, size_t max_tokens,
+                 std::vector<DXFToken>* tokens,
+                 ScanKernel kernel = BestScanKernel());
+
+}  // namespace finetoo::parser
@@ -3,28 +3,438 @@
 
 #include "src/parser/dxf_text_parser.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <system_error>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/strip.h"
+#include "src/common/parallel.h"
+#include "src/parser/dxf_binary.h"
+#include "src/parser/dxf_decompress.h"
 
 namespace finetoo::parser {
 
-// DXFEntity convenience accessors
-absl::StatusOr<std::string> DXFEntity::GetString(int group_code) const {
-  for (const auto& pair : data) {
-    if (pair.group_code == group_code) {
-      return pair.value;
+namespace {
+
+// Inputs smaller than this are parsed on the calling thread
+constexpr size_t kMinParallelBytes = 4 << 20;
+
+// Smallest piece of a section handed to a worker
+constexpr size_t kMinChunkBytes = 1 << 20;
+
+// Return the (trimmed) line starting at *pos and advance *pos past it
+absl::string_view NextLine(absl::string_view text, size_t* pos) {
+  size_t end = text.find('\n', *pos);
+  if (end == absl::string_view::npos) end = text.size();
+  absl::string_view line = text.substr(*pos, end - *pos);
+  *pos = std::min(end + 1, text.size());
+  return absl::StripAsciiWhitespace(line);
+}
+
+// True if two consecutive lines must be a group code 0 pair. A line reading
+// "0" may also be a value (layer "0"), but then the next line would be a
+// group code; a next line that is not an integer rules that out. This lets
+// us find record boundaries at an arbitrary offset without knowing which
+// lines are codes and which are values.
+bool IsZeroPair(absl::string_view line, absl::string_view next_line) {
+  int unused;
+  return line == "0" && !absl::SimpleAtoi(next_line, &unused);
+}
+
+// Offset of the first group code 0 pair starting at or after `from` whose
+// value is accepted, or npos.
+size_t FindZeroPair(absl::string_view text, size_t from,
+                    absl::FunctionRef<bool(absl::string_view)> accept) {
+  size_t pos = 0;
+  if (from > 0) {
+    pos = text.find('\n', from - 1);
+    if (pos == absl::string_view::npos) return absl::string_view::npos;
+    pos++;
+  }
+
+  size_t line_start = pos;
+  absl::string_view line = NextLine(text, &pos);
+  while (pos < text.size()) {
+    size_t next_start = pos;
+    absl::string_view next_line = NextLine(text, &pos);
+    if (IsZeroPair(line, next_line) && accept(next_line)) return line_start;
+    line_start = next_start;
+    line = next_line;
+  }
+  return absl::string_view::npos;
+}
+
+// Offset of the first "0/<value>" pair at or after `from`, located with a
+// substring search (much faster than walking lines over a large section).
+size_t FindZeroPair(absl::string_view text, size_t from,
+                    absl::string_view value) {
+  for (size_t match = text.find(value, from); match != absl::string_view::npos;
+       match = text.find(value, match + 1)) {
+    // The match must be a whole line...
+    if (match == 0 || text[match - 1] != '\n') continue;
+    size_t pos = match;
+    if (NextLine(text, &pos) != value) continue;
+
+    // ...preceded by a "0" line
+    size_t line_start =
+        match >= 2 ? text.rfind('\n', match - 2) : absl::string_view::npos;
+    line_start = (line_start == absl::string_view::npos) ? 0 : line_start + 1;
+    if (line_start < from) continue;
+    size_t unused = line_start;
+    if (NextLine(text, &unused) == "0") return line_start;
+  }
+  return absl::string_view::npos;
+}
+
+// A section located by its "0/SECTION" ... "0/ENDSEC" markers
+struct SectionSpan {
+  absl::string_view name;
+  absl::string_view body;  // Pairs between the name and ENDSEC
+};
+
+// Locate the sections of a text DXF with substring searches, or nullopt if
+// the markers are not well nested
+std::optional<std::vector<SectionSpan>> LocateSections(absl::string_view text) {
+  std::vector<SectionSpan> sections;
+  size_t pos = 0;
+  size_t last_end = 0;
+  while (true) {
+    size_t start = FindZeroPair(text, pos, "SECTION");
+    if (start == absl::string_view::npos) break;
+    if (start < last_end) return std::nullopt;  // Not well nested
+
+    pos = start;
+    NextLine(text, &pos);
+    NextLine(text, &pos);
+    if (NextLine(text, &pos) != "2") return std::nullopt;
+    absl::string_view name = NextLine(text, &pos);
+
+    size_t end = FindZeroPair(text, pos, "ENDSEC");
+    if (end == absl::string_view::npos) return std::nullopt;
+    sections.push_back({name, text.substr(pos, end - pos)});
+    last_end = end;
+  }
+  return sections;
+}
+
+// Split a section body into pieces of at least `chunk_bytes`, each starting
+// at a group code 0 pair whose value is accepted
+std::vector<absl::string_view> SplitSection(
+    absl::string_view body, size_t chunk_bytes,
+    absl::FunctionRef<bool(absl::string_view)> accept) {
+  std::vector<absl::string_view> pieces;
+  size_t begin = 0;
+  while (body.size() - begin > 2 * chunk_bytes) {
+    size_t split = FindZeroPair(body, begin + chunk_bytes, accept);
+    if (split == absl::string_view::npos) break;
+    pieces.push_back(body.substr(begin, split - begin));
+    begin = split;
+  }
+  pieces.push_back(body.substr(begin));
+  return pieces;
+}
+
+// Value type of a group code, from the DXF reference's group code ranges
+enum class NumericKind { kNone, kReal, kInteger };
+
+NumericKind NumericKindOf(int group_code) {
+  if ((group_code >= 10 && group_code <= 59) ||
+      (group_code >= 110 && group_code <= 149) ||
+      (group_code >= 210 && group_code <= 239) ||
+      (group_code >= 460 && group_code <= 469) ||
+      (group_code >= 1010 && group_code <= 1059)) {
+    return NumericKind::kReal;
+  }
+  if ((group_code >= 60 && group_code <= 99) ||
+      (group_code >= 160 && group_code <= 179) ||
+      (group_code >= 270 && group_code <= 299) ||
+      (group_code >= 370 && group_code <= 389) ||
+      (group_code >= 400 && group_code <= 409) ||
+      (group_code >= 420 && group_code <= 459) ||
+      (group_code >= 1060 && group_code <= 1071)) {
+    return NumericKind::kInteger;
+  }
+  return NumericKind::kNone;
+}
+
+// Decode a whole value with std::from_chars. Values it rejects (e.g. a
+// leading '+') are left to the accessors' slower absl fallback.
+template <typename T>
+bool ParseNumber(absl::string_view value, T* out) {
+  const char* end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, *out);
+  return ec == std::errc() && ptr == end;
+}
+
+// Number of "0/<value>" records in `text`
+int64_t CountZeroPairs(absl::string_view text, absl::string_view value) {
+  int64_t count = 0;
+  for (size_t pos = FindZeroPair(text, 0, value); pos != absl::string_view::npos;
+       pos = FindZeroPair(text, pos + 1, value)) {
+    count++;
+  }
+  return count;
+}
+
+// Number of group code 0 records in `text`, which starts at a pair
+int64_t CountRecords(absl::string_view text) {
+  int64_t count = 0;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    if (NextLine(text, &pos) == "0") count++;
+    NextLine(text, &pos);
+  }
+  return count;
+}
+
+// Sections larger than kProbeSamples * kProbeSampleBytes have their records
+// counted in that many samples spread over the section and extrapolated
+constexpr size_t kProbeSamples = 16;
+constexpr size_t kProbeSampleBytes = 16 << 10;
+
+// Number of records in a section body; *exact is false if it is estimated
+int64_t EstimateRecords(absl::string_view body, bool* exact) {
+  *exact = body.size() <= kProbeSamples * kProbeSampleBytes;
+  if (*exact) return CountRecords(body);
+
+  auto any = [](absl::string_view) { return true; };
+  size_t stride = body.size() / kProbeSamples;
+  int64_t records = 0;
+  size_t sampled_bytes = 0;
+  for (size_t i = 0; i < kProbeSamples; i++) {
+    size_t begin = FindZeroPair(body, i * stride, any);
+    if (begin == absl::string_view::npos) break;
+    size_t end = FindZeroPair(body, begin + kProbeSampleBytes, any);
+    if (end == absl::string_view::npos) end = body.size();
+    records += CountRecords(body.substr(begin, end - begin));
+    sampled_bytes += end - begin;
+  }
+  if (sampled_bytes == 0) return 0;
+  return std::llround(static_cast<double>(records) * body.size() /
+                      sampled_bytes);
+}
+
+// Offset in `text` of the group code line before `value`, a record's type
+// value: where the record starts
+size_t RecordOffset(absl::string_view text, absl::string_view value) {
+  size_t pos = value.data() - text.data();
+  size_t value_line = pos == 0 ? absl::string_view::npos : text.rfind('\n', pos - 1);
+  if (value_line == absl::string_view::npos || value_line == 0) return 0;
+  size_t code_line = text.rfind('\n', value_line - 1);
+  return code_line == absl::string_view::npos ? 0 : code_line + 1;
+}
+
+// Sets the source of tracked records (DXFParseOptions::track_changes). A
+// record's source runs from its group code 0 line to the next tracked
+// record's, or to the end of the section or input.
+template <typename Record>
+class SourceTracker {
+ public:
+  explicit SourceTracker(bool enabled) : enabled_(enabled) {}
+
+  // A tracked record, or the section's ENDSEC, starts at group code 0 pair
+  // `value`: the open record ends here
+  void Boundary(const DXFTokenizer& input, absl::string_view value) {
+    absl::string_view text = Text(input);
+    if (!text.empty()) Close(text.data() + RecordOffset(text, value));
+  }
+
+  // The input ended: so does the open record
+  void EndOfInput(const DXFTokenizer& input) {
+    absl::string_view text = Text(input);
+    if (!text.empty()) Close(text.data() + text.size());
+  }
+
+  // `record` starts at the last boundary
+  void Open(Record* record) {
+    if (begin_ != nullptr) open_ = record;
+  }
+
+ private:
+  // Sources are only known for text in memory
+  absl::string_view Text(const DXFTokenizer& input) const {
+    return enabled_ ? input.text() : absl::string_view();
+  }
+
+  void Close(const char* end) {
+    if (open_ != nullptr) {
+      open_->source = absl::string_view(begin_, end - begin_);
+    }
+    open_ = nullptr;
+    begin_ = end;
+  }
+
+  bool enabled_;
+  Record* open_ = nullptr;
+  const char* begin_ = nullptr;
+};
+
+// `view`, which pointed into bytes at `from` that are now at `to`
+absl::string_view Rebase(absl::string_view view, const char* from,
+                         const char* to) {
+  if (view.data() == nullptr) return view;
+  return absl::string_view(to + (view.data() - from), view.size());
+}
+
+// Append a copy of `entity` whose source bytes moved from `from` to `to`
+void CopyRebased(const DXFEntity& entity, const char* from, const char* to,
+                 DXFDeque<DXFEntity>* entities) {
+  DXFEntity& copy = entities->emplace_back(entities->get_allocator().arena());
+  copy.type = Rebase(entity.type, from, to);
+  copy.handle = entity.handle;
+  copy.layer = Rebase(entity.layer, from, to);
+  copy.data.reserve(entity.data.size());
+  for (const DXFPair& pair : entity.data) {
+    copy.data.push_back({pair.group_code, Rebase(pair.value, from, to)});
+  }
+  copy.index.assign(entity.index.begin(), entity.index.end());
+  copy.source = Rebase(entity.source, from, to);
+}
+
+void CopyRebased(const DXFBlock& block, const char* from, const char* to,
+                 DXFDeque<DXFBlock>* blocks) {
+  DXFBlock& copy = blocks->emplace_back(blocks->get_allocator().arena());
+  copy.name = Rebase(block.name, from, to);
+  copy.handle = block.handle;
+  for (const DXFEntity& entity : block.entities) {
+    CopyRebased(entity, from, to, &copy.entities);
+  }
+  copy.source = Rebase(block.source, from, to);
+}
+
+// Rebuild `records` from a section body: records of `previous` whose source
+// bytes reappear unchanged at the front and back of `body` are copied, and
+// `parse` tokenizes the rest in between. Sources are compared byte for
+// byte; `previous` still owns the bytes it was parsed from.
+template <typename Record>
+absl::Status ReparseRecords(
+    absl::string_view body, const DXFDeque<Record>& previous,
+    DXFDeque<Record>* records, DXFChanges::Kept* kept,
+    absl::FunctionRef<absl::Status(DXFTokenizer&)> parse) {
+  auto matches = [&](const Record& record, size_t offset) {
+    return !record.source.empty() && offset <= body.size() &&
+           record.source.size() <= body.size() - offset &&
+           body.substr(offset, record.source.size()) == record.source;
+  };
+
+  size_t front = 0;
+  kept->prefix = 0;
+  while (kept->prefix < previous.size() &&
+         matches(previous[kept->prefix], front)) {
+    front += previous[kept->prefix].source.size();
+    kept->prefix++;
+  }
+
+  size_t back = body.size();
+  kept->suffix = 0;
+  while (kept->prefix + kept->suffix < previous.size()) {
+    const Record& record = previous[previous.size() - 1 - kept->suffix];
+    if (record.source.size() > back - front ||
+        !matches(record, back - record.source.size())) {
+      break;
+    }
+    back -= record.source.size();
+    kept->suffix++;
+  }
+
+  const char* to = body.data();
+  for (size_t i = 0; i < kept->prefix; i++) {
+    CopyRebased(previous[i], previous[i].source.data(), to, records);
+    to += previous[i].source.size();
+  }
+
+  DXFTokenizer tokens(body.substr(front, back - front));
+  auto status = parse(tokens);
+  if (!status.ok()) return status;
+
+  to = body.data() + back;
+  for (size_t i = previous.size() - kept->suffix; i < previous.size(); i++) {
+    CopyRebased(previous[i], previous[i].source.data(), to, records);
+    to += previous[i].source.size();
+  }
+  return absl::OkStatus();
+}
+
+// Arena list holding one fresh arena
+std::vector<std::unique_ptr<DXFArena>> NewArenas() {
+  std::vector<std::unique_ptr<DXFArena>> arenas;
+  arenas.push_back(std::make_unique<DXFArena>());
+  return arenas;
+}
+
+}  // namespace
+
+// Entity index and accessors
+
+void DXFEntity::BuildIndex() {
+  // Insertion into a sorted scratch array: entities have few distinct codes,
+  // and repeats (polyline vertices) are dropped after a short search
+  thread_local std::vector<DXFGroupIndex> entries;
+  entries.clear();
+  for (uint32_t i = 0; i < data.size(); i++) {
+    int32_t code = data[i].group_code;
+    auto it = entries.end();
+    while (it != entries.begin() && (it - 1)->group_code > code) --it;
+    if (it != entries.begin() && (it - 1)->group_code == code) continue;
+    entries.insert(it, DXFGroupIndex{code, i});
+  }
+  index.assign(entries.begin(), entries.end());
+
+  for (auto& entry : index) {
+    absl::string_view value = data[entry.position].value;
+    switch (NumericKindOf(entry.group_code)) {
+      case NumericKind::kReal:
+        entry.has_double = ParseNumber(value, &entry.double_value);
+        break;
+      case NumericKind::kInteger:
+        entry.has_int = ParseNumber(value, &entry.int_value);
+        if (entry.has_int) {
+          entry.has_double = true;
+          entry.double_value = entry.int_value;
+        }
+        break;
+      case NumericKind::kNone:
+        break;
+    }
+  }
+}
+
+const DXFGroupIndex* DXFEntityView::Find(int group_code) const {
+  auto it = std::lower_bound(index.begin(), index.end(), group_code,
+                             [](const DXFGroupIndex& entry, int code) {
+                               return entry.group_code < code;
+                             });
+  if (it == index.end() || it->group_code != group_code) return nullptr;
+  return &*it;
+}
+
+absl::StatusOr<absl::string_view> DXFEntityView::GetString(
+    int group_code) const {
+  if (!index.empty()) {
+    if (const DXFGroupIndex* entry = Find(group_code)) {
+      return data[entry->position].value;
+    }
+  } else {
+    for (const auto& pair : data) {
+      if (pair.group_code == group_code) {
+        return pair.value;
+      }
     }
   }
   return absl::NotFoundError(
       absl::StrFormat("Group code %d not found in entity %s", group_code, type));
 }
 
-absl::StatusOr<double> DXFEntity::GetDouble(int group_code) const {
+absl::StatusOr<double> DXFEntityView::GetDouble(int group_code) const {
+  const DXFGroupIndex* entry = Find(group_code);
+  if (entry != nullptr && entry->has_double) return entry->double_value;
+
   auto value_or = GetString(group_code);
   if (!value_or.ok()) return value_or.status();
 
@@ -36,7 +446,10 @@ absl::StatusOr<double> DXFEntity::GetDouble(int group_code) const {
   return result;
 }
 
-absl::StatusOr<int> DXFEntity::GetInt(int group_code) const {
+absl::StatusOr<int> DXFEntityView::GetInt(int group_code) const {
+  const DXFGroupIndex* entry = Find(group_code);
+  if (entry != nullptr && entry->has_int) return entry->int_value;
+
   auto value_or = GetString(group_code);
   if (!value_or.ok()) return value_or.status();
 
@@ -48,24 +461,386 @@ absl::StatusOr<int> DXFEntity::GetInt(int group_code) const {
   return result;
 }
 
+absl::StatusOr<absl::string_view> DXFEntity::GetString(int group_code) const {
+  return DXFEntityView(*this).GetString(group_code);
+}
+
+absl::StatusOr<double> DXFEntity::GetDouble(int group_code) const {
+  return DXFEntityView(*this).GetDouble(group_code);
+}
+
+absl::StatusOr<int> DXFEntity::GetInt(int group_code) const {
+  return DXFEntityView(*this).GetInt(group_code);
+}
+
+// DXFFile
+
+DXFFile::DXFFile()
+    : arenas(NewArenas()),
+      entities(arenas.front().get()),
+      blocks(arenas.front().get()),
+      tables(arenas.front().get()),
+      objects(arenas.front().get()) {}
+
+DXFFile::DXFFile(DXFFile&& other) {
+  // Members start empty, containers on the heap; only that can throw, and
+  // `other` is untouched until then. Moving a deque would hand its source
+  // a fresh map from arenas that now belong to this file, so the members
+  // are swapped instead, leaving `other` our empty containers.
+  swap(other);
+}
+
+DXFFile& DXFFile::operator=(DXFFile&& other) {
+  // Taken aside first, so a throw leaves both files as they were. The old
+  // contents go with `moved`, whose containers are destroyed before the
+  // arenas they point into.
+  DXFFile moved(std::move(other));
+  swap(moved);
+  return *this;
+}
+
+void DXFFile::swap(DXFFile& other) noexcept {
+  // Container allocators propagate on swap, so each container keeps the
+  // arena it was allocated from
+  arenas.swap(other.arenas);
+  version.swap(other.version);
+  entities.swap(other.entities);
+  blocks.swap(other.blocks);
+  tables.swap(other.tables);
+  objects.swap(other.objects);
+  entity_by_handle.swap(other.entity_by_handle);
+  block_by_name.swap(other.block_by_name);
+  table_by_name.swap(other.table_by_name);
+  layer_by_name.swap(other.layer_by_name);
+  buffer.swap(other.buffer);
+  decoded_values.swap(other.decoded_values);
+}
+
 // DXFTextParser implementation
 
 absl::StatusOr<DXFFile> DXFTextParser::Parse(absl::string_view file_path) {
-  std::ifstream input{std::string{file_path}};  // Use braces to avoid "most vexing parse"
-  if (!input.is_open()) {
-    return absl::NotFoundError(absl::StrFormat("Cannot open file: %s", file_path));
-  }
+  auto buffer_or = options_.use_mmap && !options_.track_changes
+                       ? DXFBuffer::Map(file_path)
+                       : DXFBuffer::Read(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
 
-  return Parse(input);
+  return Parse(*std::move(buffer_or));
 }
 
 absl::StatusOr<DXFFile> DXFTextParser::Parse(std::istream& input) {
+  DXFCompression compression = DetectCompression(input);
+  if (compression == DXFCompression::kNone) return ParseStream(input);
+
+  DecompressingStreamBuf decompressed(compression, input);
+  std::istream stream(&decompressed);
+  auto file_or = ParseStream(stream);
+
+  // A decompression error explains whatever parse error it caused
+  if (!decompressed.status().ok()) return decompressed.status();
+  return file_or;
+}
+
+absl::StatusOr<DXFFile> DXFTextParser::ParseStream(std::istream& input) {
+  auto storage = DXFBuffer::ForStreaming();
+  DXFTokenizer tokens(input, storage.get());
+
+  DXFFile file;
+  file.buffer = std::move(storage);
+  auto status = ParseSections(tokens, file);
+  if (!status.ok()) return status;
+
+  file.decoded_values = tokens.decoded_values();
+  return file;
+}
+
+absl::StatusOr<DXFFile> DXFTextParser::Parse(
+    std::shared_ptr<const DXFBuffer> buffer) {
+  DXFCompression compression = DetectCompression(buffer->contents());
+  if (compression != DXFCompression::kNone) {
+    DecompressingStreamBuf decompressed(compression, buffer->contents());
+    std::istream stream(&decompressed);
+    auto file_or = ParseStream(stream);
+    if (!decompressed.status().ok()) return decompressed.status();
+    return file_or;
+  }
+
+  int num_threads = options_.num_threads > 0 ? options_.num_threads
+                                             : common::DefaultThreadCount();
+  // Binary DXF has no line structure to split at
+  if (num_threads > 1 && buffer->contents().size() >= kMinParallelBytes &&
+      !IsBinaryDXF(buffer->contents())) {
+    auto file = ParseParallel(buffer, num_threads);
+    if (file.has_value()) return *std::move(file);
+  }
+
+  DXFTokenizer tokens(buffer->contents());
+
   DXFFile file;
-  line_number_ = 0;
+  file.buffer = std::move(buffer);
+  auto status = ParseSections(tokens, file);
+  if (!status.ok()) return status;
+
+  file.decoded_values = tokens.decoded_values();
+  return file;
+}
+
+absl::Status DXFTextParser::Parse(absl::string_view file_path,
+                                  DXFVisitor& visitor) {
+  auto buffer_or = options_.use_mmap ? DXFBuffer::Map(file_path)
+                                     : DXFBuffer::Read(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
+
+  return Parse(**buffer_or, visitor);
+}
+
+absl::Status DXFTextParser::Parse(std::istream& input, DXFVisitor& visitor) {
+  DXFCompression compression = DetectCompression(input);
+  if (compression == DXFCompression::kNone) return VisitStream(input, visitor);
+
+  DecompressingStreamBuf decompressed(compression, input);
+  std::istream stream(&decompressed);
+  auto status = VisitStream(stream, visitor);
+  if (!decompressed.status().ok()) return decompressed.status();
+  return status;
+}
+
+absl::Status DXFTextParser::Parse(const DXFBuffer& buffer,
+                                  DXFVisitor& visitor) {
+  DXFCompression compression = DetectCompression(buffer.contents());
+  if (compression != DXFCompression::kNone) {
+    DecompressingStreamBuf decompressed(compression, buffer.contents());
+    std::istream stream(&decompressed);
+    auto status = VisitStream(stream, visitor);
+    if (!decompressed.status().ok()) return decompressed.status();
+    return status;
+  }
+
+  DXFTokenizer tokens(buffer.contents());
+  return VisitSections(tokens, visitor);
+}
+
+absl::Status DXFTextParser::VisitStream(std::istream& input,
+                                        DXFVisitor& visitor) {
+  auto storage = DXFBuffer::ForStreaming();
+  DXFTokenizer tokens(input, storage.get());
+  return VisitSections(tokens, visitor);
+}
+
+absl::StatusOr<DXFFile> DXFTextParser::Reparse(const DXFFile& previous,
+                                               absl::string_view file_path,
+                                               DXFChanges* changes) {
+  auto buffer_or = options_.use_mmap && !options_.track_changes
+                       ? DXFBuffer::Map(file_path)
+                       : DXFBuffer::Read(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
+
+  return Reparse(previous, *std::move(buffer_or), changes);
+}
+
+absl::StatusOr<DXFFile> DXFTextParser::Reparse(
+    const DXFFile& previous, std::shared_ptr<const DXFBuffer> buffer,
+    DXFChanges* changes) {
+  DXFChanges kept;
+  if (changes != nullptr) *changes = kept;
+
+  // Sections are taken apart as for a parallel parse. Anything else (or a
+  // repeated section) is parsed whole.
+  absl::string_view text = buffer->contents();
+  std::optional<std::vector<SectionSpan>> sections;
+  if (options_.track_changes &&
+      DetectCompression(text) == DXFCompression::kNone &&
+      !IsBinaryDXF(text)) {
+    sections = LocateSections(text);
+  }
+  absl::flat_hash_set<absl::string_view> names;
+  for (const auto& section : sections.value_or(std::vector<SectionSpan>())) {
+    if (!names.insert(section.name).second) sections.reset();
+    if (!sections.has_value()) break;
+  }
+  if (!sections.has_value()) return Parse(std::move(buffer));
+
+  DXFFile file;
+  for (const auto& section : *sections) {
+    if (!WantsSection(section.name)) continue;
+
+    DXFTokenizer tokens(section.body);
+    absl::Status status;
+    if (section.name == "HEADER") {
+      status = ParseHeader(tokens, &file.version, SectionEnd::kEndOfInput);
+    } else if (section.name == "TABLES") {
+      status = ParseTables(tokens, &file.tables, SectionEnd::kEndOfInput);
+    } else if (section.name == "BLOCKS") {
+      status = ReparseRecords<DXFBlock>(
+          section.body, previous.blocks, &file.blocks, &kept.blocks,
+          [&](DXFTokenizer& input) {
+            return ParseBlocks(input, &file.blocks, SectionEnd::kEndOfInput);
+          });
+    } else if (section.name == "ENTITIES" || section.name == "OBJECTS") {
+      bool objects = section.name == "OBJECTS";
+      DXFDeque<DXFEntity>* records = objects ? &file.objects : &file.entities;
+      status = ReparseRecords<DXFEntity>(
+          section.body, objects ? previous.objects : previous.entities,
+          records, objects ? &kept.objects : &kept.entities,
+          [&](DXFTokenizer& input) {
+            return ParseEntities(input, records, SectionEnd::kEndOfInput);
+          });
+    }
+    if (!status.ok()) return status;
+  }
+
+  file.buffer = std::move(buffer);
+  BuildLookups(file);
+  if (changes != nullptr) *changes = kept;
+  return file;
+}
+
+absl::StatusOr<DXFProbe> DXFTextParser::Probe(absl::string_view file_path) {
+  auto buffer_or = options_.use_mmap ? DXFBuffer::Map(file_path)
+                                     : DXFBuffer::Read(file_path);
+  if (!buffer_or.ok()) return buffer_or.status();
+  absl::string_view text = (*buffer_or)->contents();
+
+  DXFProbe probe;
+  probe.file_bytes = (*buffer_or)->size();
+
+  DXFCompression compression = DetectCompression(text);
+  if (compression != DXFCompression::kNone) {
+    DecompressingStreamBuf decompressed(compression, text);
+    std::istream stream(&decompressed);
+    auto storage = DXFBuffer::ForStreaming();
+    DXFTokenizer tokens(stream, storage.get());
+    auto status = ProbeTokens(tokens, &probe);
+    if (!decompressed.status().ok()) return decompressed.status();
+    if (!status.ok()) return status;
+    return probe;
+  }
+
+  // Text with recognizable section markers is searched, not tokenized
+  std::optional<std::vector<SectionSpan>> sections;
+  if (!IsBinaryDXF(text)) sections = LocateSections(text);
+  if (!sections.has_value() || sections->empty()) {
+    DXFTokenizer tokens(text);
+    auto status = ProbeTokens(tokens, &probe);
+    if (!status.ok()) return status;
+    return probe;
+  }
+
+  for (const auto& section : *sections) {
+    probe.sections.emplace_back(section.name);
+    if (section.name == "HEADER") {
+      DXFTokenizer tokens(section.body);
+      auto status = ProbeHeader(tokens, &probe, SectionEnd::kEndOfInput);
+      if (!status.ok()) return status;
+    } else if (section.name == "TABLES") {
+      probe.layer_count += CountZeroPairs(section.body, "LAYER");
+    } else if (section.name == "BLOCKS") {
+      probe.block_count += CountZeroPairs(section.body, "BLOCK");
+    } else if (section.name == "ENTITIES") {
+      bool exact;
+      probe.entity_count += EstimateRecords(section.body, &exact);
+      probe.entity_count_exact = probe.entity_count_exact && exact;
+    }
+  }
+  return probe;
+}
+
+absl::Status DXFTextParser::ProbeTokens(DXFTokenizer& input,
+                                        DXFProbe* probe) {
+  std::string section;
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (absl::IsOutOfRange(pair_or.status())) break;  // EOF
+      return pair_or.status();
+    }
+
+    const auto& pair = *pair_or;
+    if (pair.group_code != 0) continue;
+    if (pair.value == "EOF") break;
+
+    if (pair.value == "SECTION") {
+      auto name_pair_or = input.Next();
+      if (!name_pair_or.ok()) return name_pair_or.status();
+      if (name_pair_or->group_code != 2) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Expected group code 2 after SECTION, got %d",
+                           name_pair_or->group_code));
+      }
+      section = std::string(name_pair_or->value);
+      probe->sections.push_back(section);
+      if (section == "HEADER") {
+        auto status = ProbeHeader(input, probe);
+        if (!status.ok()) return status;
+        section.clear();
+      }
+      continue;
+    }
+
+    if (pair.value == "ENDSEC") {
+      section.clear();
+    } else if (section == "ENTITIES") {
+      probe->entity_count++;
+    } else if (section == "BLOCKS" && pair.value == "BLOCK") {
+      probe->block_count++;
+    } else if (section == "TABLES" && pair.value == "LAYER") {
+      probe->layer_count++;
+    }
+    input.SkipRecord();
+    input.ReleaseConsumed();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DXFTextParser::ProbeHeader(DXFTokenizer& input, DXFProbe* probe,
+                                        SectionEnd end) {
+  // Point variable whose coordinates (group codes 10/20/30) follow
+  std::array<double, 3>* point = nullptr;
+  bool has_min = false;
+  bool has_max = false;
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (end == SectionEnd::kEndOfInput && absl::IsOutOfRange(pair_or.status())) {
+        break;
+      }
+      return pair_or.status();
+    }
+
+    const auto& pair = *pair_or;
+    if (pair.group_code == 0 && pair.value == "ENDSEC") break;
+
+    if (pair.group_code == 9) {
+      point = nullptr;
+      if (pair.value == "$ACADVER") {
+        auto version_pair_or = input.Next();
+        if (version_pair_or.ok()) {
+          probe->version = std::string(version_pair_or->value);
+        }
+      } else if (pair.value == "$EXTMIN") {
+        point = &probe->extents_min;
+        has_min = true;
+      } else if (pair.value == "$EXTMAX") {
+        point = &probe->extents_max;
+        has_max = true;
+      }
+    } else if (point != nullptr &&
+               (pair.group_code == 10 || pair.group_code == 20 ||
+                pair.group_code == 30)) {
+      double value;
+      if (absl::SimpleAtod(pair.value, &value)) {
+        (*point)[pair.group_code / 10 - 1] = value;
+      }
+    }
+  }
+
+  probe->has_extents = has_min && has_max;
+  return absl::OkStatus();
+}
 
+absl::Status DXFTextParser::ParseSections(DXFTokenizer& input, DXFFile& file) {
   // Parse sections
-  while (input.good()) {
-    auto pair_or = ReadPair(input);
+  while (true) {
+    auto pair_or = input.Next();
     if (!pair_or.ok()) {
       if (absl::IsOutOfRange(pair_or.status())) {
         break;  // EOF
@@ -78,7 +853,7 @@ absl::StatusOr<DXFFile> DXFTextParser::Parse(std::istream& input) {
     // Section marker
     if (pair.group_code == 0 && pair.value == "SECTION") {
       // Read section name
-      auto name_pair_or = ReadPair(input);
+      auto name_pair_or = input.Next();
       if (!name_pair_or.ok()) return name_pair_or.status();
 
       if (name_pair_or->group_code != 2) {
@@ -87,26 +862,28 @@ absl::StatusOr<DXFFile> DXFTextParser::Parse(std::istream& input) {
                            name_pair_or->group_code));
       }
 
-      const std::string& section_name = name_pair_or->value;
+      absl::string_view section_name = name_pair_or->value;
 
-      if (section_name == "HEADER") {
-        auto status = ParseHeader(input, file);
+      if (!WantsSection(section_name)) {
+        SkipSection(input);
+      } else if (section_name == "HEADER") {
+        auto status = ParseHeader(input, &file.version);
+        if (!status.ok()) return status;
+      } else if (section_name == "TABLES") {
+        auto status = ParseTables(input, &file.tables);
         if (!status.ok()) return status;
       } else if (section_name == "BLOCKS") {
-        auto status = ParseBlocks(input, file);
+        auto status = ParseBlocks(input, &file.blocks);
         if (!status.ok()) return status;
       } else if (section_name == "ENTITIES") {
-        auto status = ParseEntities(input, file);
+        auto status = ParseEntities(input, &file.entities);
+        if (!status.ok()) return status;
+      } else if (section_name == "OBJECTS") {
+        auto status = ParseEntities(input, &file.objects);
         if (!status.ok()) return status;
       } else {
         // Skip unknown sections
-        while (input.good()) {
-          auto skip_pair_or = ReadPair(input);
-          if (!skip_pair_or.ok()) break;
-          if (skip_pair_or->group_code == 0 && skip_pair_or->value == "ENDSEC") {
-            break;
-          }
-        }
+        SkipSection(input);
       }
     }
 
@@ -118,47 +895,172 @@ absl::StatusOr<DXFFile> DXFTextParser::Parse(std::istream& input) {
   // Build lookup maps
   BuildLookups(file);
 
-  return file;
+  return absl::OkStatus();
 }
 
-absl::StatusOr<DXFPair> DXFTextParser::ReadPair(std::istream& input) {
-  std::string group_code_str;
-  std::string value;
+std::optional<DXFFile> DXFTextParser::ParseParallel(
+    std::shared_ptr<const DXFBuffer> buffer, int num_threads) {
+  absl::string_view text = buffer->contents();
 
-  // Read group code
-  if (!std::getline(input, group_code_str)) {
-    if (input.eof()) {
-      return absl::OutOfRangeError("End of file");
+  // Locate sections by their "0/SECTION" ... "0/ENDSEC" markers
+  auto sections_or = LocateSections(text);
+  if (!sections_or.has_value()) return std::nullopt;
+  const std::vector<SectionSpan>& sections = *sections_or;
+
+  // Cut sections at group code 0 records. Inside BLOCKS any record but
+  // ENDBLK will do: one that is not BLOCK is an entity of an open block, so
+  // very large blocks are split too and stitched back together below.
+  size_t total_bytes = 0;
+  for (const auto& section : sections) total_bytes += section.body.size();
+  size_t chunk_bytes = std::max(kMinChunkBytes, total_bytes / (4 * num_threads));
+
+  // Where a chunk's records go
+  enum class Target { kBlocks, kEntities, kObjects };
+
+  struct Chunk {
+    Chunk(Target target, absl::string_view text)
+        : target(target),
+          text(text),
+          arena(std::make_unique<DXFArena>()),
+          parsed_entities(arena.get()),
+          parsed_blocks(arena.get()),
+          continuation(arena.get()) {}
+
+    Target target;
+    absl::string_view text;
+    absl::Status status;
+
+    // Each worker allocates from its own arena, handed to the file after
+    std::unique_ptr<DXFArena> arena;
+    DXFDeque<DXFEntity> parsed_entities;
+    DXFDeque<DXFBlock> parsed_blocks;
+
+    // Entities continuing the block left open by the previous chunk
+    bool continues_block = false;
+    DXFBlock continuation;
+
+    // The chunk's last block has no ENDBLK yet
+    bool open = false;
+  };
+  std::vector<Chunk> chunks;
+
+  DXFFile file;
+  for (const auto& section : sections) {
+    if (!WantsSection(section.name)) {
+      continue;
+    } else if (section.name == "HEADER") {
+      // Small; parse it here while the workers start on the rest
+      DXFTokenizer tokens(section.body);
+      if (!ParseHeader(tokens, &file.version, SectionEnd::kEndOfInput).ok()) {
+        return std::nullopt;
+      }
+    } else if (section.name == "TABLES") {
+      // Small as well
+      DXFTokenizer tokens(section.body);
+      if (!ParseTables(tokens, &file.tables, SectionEnd::kEndOfInput).ok()) {
+        return std::nullopt;
+      }
+    } else if (section.name == "BLOCKS") {
+      for (absl::string_view piece : SplitSection(
+               section.body, chunk_bytes,
+               [](absl::string_view type) { return type != "ENDBLK"; })) {
+        chunks.emplace_back(Target::kBlocks, piece);
+      }
+    } else if (section.name == "ENTITIES" || section.name == "OBJECTS") {
+      Target target = section.name == "ENTITIES" ? Target::kEntities
+                                                 : Target::kObjects;
+      for (absl::string_view piece : SplitSection(
+               section.body, chunk_bytes,
+               [](absl::string_view) { return true; })) {
+        chunks.emplace_back(target, piece);
+      }
     }
-    return absl::DataLossError("Failed to read group code");
   }
-  line_number_++;
 
-  // Read value
-  if (!std::getline(input, value)) {
-    return absl::DataLossError(
-        absl::StrFormat("Failed to read value at line %d", line_number_));
-  }
-  line_number_++;
+  common::ParallelFor(chunks.size(), num_threads, [&](size_t i) {
+    Chunk& chunk = chunks[i];
+    DXFTokenizer tokens(chunk.text);
+    if (chunk.target != Target::kBlocks) {
+      chunk.status = ParseEntities(tokens, &chunk.parsed_entities,
+                                   SectionEnd::kEndOfInput);
+      return;
+    }
 
-  // Parse group code
-  int group_code;
-  std::string trimmed = std::string(absl::StripAsciiWhitespace(group_code_str));
-  if (!absl::SimpleAtoi(trimmed, &group_code)) {
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Invalid group code '%s' at line %d", trimmed, line_number_ - 2));
+    auto first_or = tokens.Peek();
+    if (first_or.ok() && first_or->group_code == 0 && first_or->value != "BLOCK") {
+      chunk.continues_block = true;
+      chunk.status = ParseBlockBody(tokens, &chunk.continuation);
+      if (absl::IsOutOfRange(chunk.status)) {
+        chunk.open = true;  // The whole chunk is inside one block
+        chunk.status = absl::OkStatus();
+        return;
+      }
+      if (!chunk.status.ok()) return;
+    }
+
+    chunk.status = ParseBlocks(tokens, &chunk.parsed_blocks,
+                               SectionEnd::kEndOfInput);
+    if (absl::IsOutOfRange(chunk.status)) {
+      chunk.open = true;
+      chunk.status = absl::OkStatus();
+    }
+  });
+
+  // Merge in file order. Entities move without their pairs, which stay in
+  // the chunk arenas.
+  for (const auto& chunk : chunks) {
+    if (!chunk.status.ok()) return std::nullopt;
   }
 
-  // Trim value
-  value = std::string(absl::StripAsciiWhitespace(value));
+  bool block_open = false;
+  for (auto& chunk : chunks) {
+    if (chunk.continues_block) {
+      if (!block_open) return std::nullopt;
+      auto& block = file.blocks.back();
+      std::move(chunk.continuation.entities.begin(),
+                chunk.continuation.entities.end(),
+                std::back_inserter(block.entities));
+
+      // The block's source runs on to this chunk's first block, unless
+      // the whole chunk is inside it
+      bool ends_here = !chunk.open || !chunk.parsed_blocks.empty();
+      if (options_.track_changes && ends_here) {
+        const char* end = chunk.parsed_blocks.empty()
+                              ? chunk.text.data() + chunk.text.size()
+                              : chunk.parsed_blocks.front().source.data();
+        block.source =
+            absl::string_view(block.source.data(), end - block.source.data());
+      }
+    } else if (block_open) {
+      return std::nullopt;  // BLOCK without ENDBLK
+    }
 
-  return DXFPair{group_code, value};
+    auto& records = chunk.target == Target::kObjects ? file.objects
+                                                     : file.entities;
+    std::move(chunk.parsed_entities.begin(), chunk.parsed_entities.end(),
+              std::back_inserter(records));
+    std::move(chunk.parsed_blocks.begin(), chunk.parsed_blocks.end(),
+              std::back_inserter(file.blocks));
+    block_open = chunk.open;
+  }
+  if (block_open) return std::nullopt;
+
+  for (auto& chunk : chunks) file.arenas.push_back(std::move(chunk.arena));
+  file.buffer = std::move(buffer);
+  BuildLookups(file);
+  return file;
 }
 
-absl::Status DXFTextParser::ParseHeader(std::istream& input, DXFFile& file) {
-  while (input.good()) {
-    auto pair_or = ReadPair(input);
-    if (!pair_or.ok()) return pair_or.status();
+absl::Status DXFTextParser::ParseHeader(DXFTokenizer& input,
+                                        std::string* version, SectionEnd end) {
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (end == SectionEnd::kEndOfInput && absl::IsOutOfRange(pair_or.status())) {
+        break;
+      }
+      return pair_or.status();
+    }
 
     const auto& pair = *pair_or;
 
@@ -169,9 +1071,9 @@ absl::Status DXFTextParser::ParseHeader(std::istream& input, DXFFile& file) {
 
     // Extract version
     if (pair.group_code == 9 && pair.value == "$ACADVER") {
-      auto version_pair_or = ReadPair(input);
+      auto version_pair_or = input.Next();
       if (version_pair_or.ok()) {
-        file.version = version_pair_or->value;
+        *version = std::string(version_pair_or->value);
       }
     }
   }
@@ -179,120 +1081,397 @@ absl::Status DXFTextParser::ParseHeader(std::istream& input, DXFFile& file) {
   return absl::OkStatus();
 }
 
-absl::Status DXFTextParser::ParseBlocks(std::istream& input, DXFFile& file) {
-  while (input.good()) {
-    auto pair_or = ReadPair(input);
-    if (!pair_or.ok()) return pair_or.status();
+void DXFTextParser::SkipSection(DXFTokenizer& input) {
+  while (true) {
+    input.SkipRecord();
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) break;
+    if (pair_or->group_code == 0 && pair_or->value == "ENDSEC") break;
+  }
+}
+
+absl::Status DXFTextParser::ParseBlocks(DXFTokenizer& input,
+                                        DXFDeque<DXFBlock>* blocks,
+                                        SectionEnd end) {
+  SourceTracker<DXFBlock> sources(options_.track_changes);
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (end == SectionEnd::kEndOfInput && absl::IsOutOfRange(pair_or.status())) {
+        sources.EndOfInput(input);
+        break;
+      }
+      return pair_or.status();
+    }
 
     const auto& pair = *pair_or;
 
     // End of section
     if (pair.group_code == 0 && pair.value == "ENDSEC") {
+      sources.Boundary(input, pair.value);
       break;
     }
 
     // Start of block
     if (pair.group_code == 0 && pair.value == "BLOCK") {
-      DXFBlock block;
-
-      // Read block properties
-      while (input.good()) {
-        auto block_pair_or = ReadPair(input);
-        if (!block_pair_or.ok()) return block_pair_or.status();
-
-        const auto& block_pair = *block_pair_or;
-
-        if (block_pair.group_code == 2) {
-          block.name = block_pair.value;
-        } else if (block_pair.group_code == 5) {
-          block.handle = block_pair.value;
-        } else if (block_pair.group_code == 0) {
-          // Start of entity within block or ENDBLK
-          if (block_pair.value == "ENDBLK") {
-            break;
-          } else {
-            // Parse entity within block
-            auto entity_or = ParseEntity(input, block_pair.value);
-            if (entity_or.ok()) {
-              block.entities.push_back(*entity_or);
-            }
-          }
-        }
+      // A chunk may end inside a block: it is kept, and OutOfRange tells
+      // the caller that the next chunk continues it
+      sources.Boundary(input, pair.value);
+      DXFBlock& block = blocks->emplace_back(blocks->get_allocator().arena());
+      sources.Open(&block);
+      auto status = ParseBlockBody(input, &block);
+      if (absl::IsOutOfRange(status)) sources.EndOfInput(input);
+      if (!status.ok()) return status;
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DXFTextParser::ParseBlockBody(DXFTokenizer& input,
+                                           DXFBlock* block) {
+  // Read block properties
+  while (true) {
+    auto block_pair_or = input.Next();
+    if (!block_pair_or.ok()) return block_pair_or.status();
+
+    const auto& block_pair = *block_pair_or;
+
+    if (block_pair.group_code == 2) {
+      block->name = block_pair.value;
+    } else if (block_pair.group_code == 5) {
+      block->handle = ParseHandle(block_pair.value);
+    } else if (block_pair.group_code == 0) {
+      // Start of entity within block or ENDBLK
+      if (block_pair.value == "ENDBLK") {
+        break;
+      } else if (!WantsEntity(block_pair.value)) {
+        input.SkipRecord();
+      } else {
+        // Parse entity within block
+        ParseEntity(input, block_pair.value, &block->entities);
       }
+    }
+  }
+
+  return absl::OkStatus();
+}
 
-      file.blocks.push_back(std::move(block));
+absl::Status DXFTextParser::ParseTables(DXFTokenizer& input,
+                                        DXFDeque<DXFTable>* tables,
+                                        SectionEnd end) {
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (end == SectionEnd::kEndOfInput && absl::IsOutOfRange(pair_or.status())) {
+        break;
+      }
+      return pair_or.status();
+    }
+
+    const auto& pair = *pair_or;
+
+    // End of section
+    if (pair.group_code == 0 && pair.value == "ENDSEC") {
+      break;
+    }
+
+    // Start of table
+    if (pair.group_code == 0 && pair.value == "TABLE") {
+      DXFTable& table = tables->emplace_back(tables->get_allocator().arena());
+      auto status = ParseTableBody(input, &table);
+      if (!status.ok()) return status;
     }
   }
 
   return absl::OkStatus();
 }
 
-absl::Status DXFTextParser::ParseEntities(std::istream& input, DXFFile& file) {
-  while (input.good()) {
-    auto pair_or = ReadPair(input);
+absl::Status DXFTextParser::ParseTableBody(DXFTokenizer& input,
+                                           DXFTable* table) {
+  while (true) {
+    auto pair_or = input.Next();
     if (!pair_or.ok()) return pair_or.status();
 
+    // Entries consume their own pairs, so anything else before a group
+    // code 0 belongs to the table itself
+    const auto& pair = *pair_or;
+    if (pair.group_code == 2) {
+      table->name = pair.value;
+    } else if (pair.group_code == 5) {
+      table->handle = ParseHandle(pair.value);
+    } else if (pair.group_code == 0) {
+      if (pair.value == "ENDTAB") break;
+      ParseEntity(input, pair.value, &table->records);
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DXFTextParser::ParseEntities(DXFTokenizer& input,
+                                          DXFDeque<DXFEntity>* entities,
+                                          SectionEnd end) {
+  // Filtered-out records count towards the source of the entity before them
+  SourceTracker<DXFEntity> sources(options_.track_changes);
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (end == SectionEnd::kEndOfInput && absl::IsOutOfRange(pair_or.status())) {
+        sources.EndOfInput(input);
+        break;
+      }
+      return pair_or.status();
+    }
+
     const auto& pair = *pair_or;
 
     // End of section
     if (pair.group_code == 0 && pair.value == "ENDSEC") {
+      sources.Boundary(input, pair.value);
       break;
     }
 
     // Start of entity
-    if (pair.group_code == 0) {
-      auto entity_or = ParseEntity(input, pair.value);
-      if (entity_or.ok()) {
-        file.entities.push_back(*entity_or);
-      }
+    if (pair.group_code == 0 && !WantsEntity(pair.value)) {
+      input.SkipRecord();
+    } else if (pair.group_code == 0) {
+      sources.Boundary(input, pair.value);
+      ParseEntity(input, pair.value, entities);
+      sources.Open(&entities->back());
     }
   }
 
   return absl::OkStatus();
 }
 
-absl::StatusOr<DXFEntity> DXFTextParser::ParseEntity(std::istream& input,
-                                                       const std::string& entity_type) {
-  DXFEntity entity;
-  entity.type = entity_type;
+void DXFTextParser::ParseEntity(DXFTokenizer& input,
+                                absl::string_view entity_type,
+                                DXFDeque<DXFEntity>* entities) {
+  // Pairs are collected in a reused scratch entity, then copied into the
+  // arena at their final size
+  thread_local DXFEntity scratch;
+  ReadEntity(input, entity_type, &scratch);
+
+  DXFEntity& entity = entities->emplace_back(entities->get_allocator().arena());
+  entity.type = scratch.type;
+  entity.handle = scratch.handle;
+  entity.layer = scratch.layer;
+  entity.data.assign(scratch.data.begin(), scratch.data.end());
+  entity.index.assign(scratch.index.begin(), scratch.index.end());
+}
+
+void DXFTextParser::ReadEntity(DXFTokenizer& input,
+                               absl::string_view entity_type,
+                               DXFEntity* entity) {
+  entity->type = entity_type;
+  entity->handle = kNoHandle;
+  entity->layer = {};
+  entity->data.clear();
 
   // Read entity data until next 0 code
-  while (input.good()) {
+  while (true) {
     // Peek to see if next is group code 0 (next entity)
-    auto pos = input.tellg();
-    auto pair_or = ReadPair(input);
+    auto pair_or = input.Peek();
 
-    if (!pair_or.ok()) {
-      input.seekg(pos);  // Reset position
+    // Leave errors and the next entity's 0 record for the caller
+    if (!pair_or.ok() || pair_or->group_code == 0) {
       break;
     }
 
     const auto& pair = *pair_or;
-
-    if (pair.group_code == 0) {
-      // Next entity - put it back
-      input.seekg(pos);
-      break;
-    }
+    input.Skip();
 
     // Store pair
-    entity.data.push_back(pair);
+    if (WantsGroupCode(pair.group_code)) {
+      entity->data.push_back(pair);
+    }
 
     // Extract common fields
     if (pair.group_code == 5) {
-      entity.handle = pair.value;
+      entity->handle = ParseHandle(pair.value);
     } else if (pair.group_code == 8) {
-      entity.layer = pair.value;
+      entity->layer = pair.value;
+    }
+  }
+
+  entity->BuildIndex();
+}
+
+absl::Status DXFTextParser::VisitSections(DXFTokenizer& input,
+                                          DXFVisitor& visitor) {
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) {
+      if (absl::IsOutOfRange(pair_or.status())) {
+        break;  // EOF
+      }
+      return pair_or.status();
+    }
+
+    const auto& pair = *pair_or;
+    if (pair.group_code == 0 && pair.value == "EOF") {
+      break;
+    }
+    if (pair.group_code != 0 || pair.value != "SECTION") {
+      continue;
+    }
+
+    auto name_pair_or = input.Next();
+    if (!name_pair_or.ok()) return name_pair_or.status();
+
+    if (name_pair_or->group_code != 2) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected group code 2 after SECTION, got %d",
+                          name_pair_or->group_code));
+    }
+
+    absl::string_view section_name = name_pair_or->value;
+    absl::Status status;
+    if (!WantsSection(section_name)) {
+      SkipSection(input);
+    } else if (section_name == "HEADER") {
+      std::string version;
+      status = ParseHeader(input, &version);
+      if (status.ok() && !version.empty()) status = visitor.OnVersion(version);
+    } else if (section_name == "TABLES") {
+      status = VisitTables(input, visitor);
+    } else if (section_name == "BLOCKS") {
+      status = VisitBlocks(input, visitor);
+    } else if (section_name == "ENTITIES") {
+      status = VisitEntities(input, visitor);
+    } else {
+      // Skip unknown sections
+      SkipSection(input);
     }
+    if (!status.ok()) return status;
+    input.ReleaseConsumed();
   }
 
-  return entity;
+  return absl::OkStatus();
+}
+
+absl::Status DXFTextParser::VisitTables(DXFTokenizer& input,
+                                        DXFVisitor& visitor) {
+  DXFEntity record;  // Reused for every entry
+  std::string table;
+
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) return pair_or.status();
+
+    const auto& pair = *pair_or;
+    if (pair.group_code == 0 && pair.value == "ENDSEC") {
+      break;
+    }
+    // Entries consume their own pairs, so a group code 2 outside of them
+    // names the table. Copied, since streamed input is released after
+    // every entry.
+    if (pair.group_code == 0 && pair.value == "TABLE") {
+      table.clear();
+    } else if (pair.group_code == 2) {
+      table = std::string(pair.value);
+    } else if (pair.group_code == 0 && pair.value != "ENDTAB") {
+      ReadEntity(input, pair.value, &record);
+      auto status = visitor.OnTableRecord(table, record);
+      if (!status.ok()) return status;
+      input.ReleaseConsumed();
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DXFTextParser::VisitBlocks(DXFTokenizer& input,
+                                        DXFVisitor& visitor) {
+  DXFEntity entity;  // Reused for every entity
+
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) return pair_or.status();
+
+    const auto& pair = *pair_or;
+    if (pair.group_code == 0 && pair.value == "ENDSEC") {
+      break;
+    }
+    if (pair.group_code != 0 || pair.value != "BLOCK") {
+      continue;
+    }
+
+    // Copied, since streamed input may be released before OnBlockEnd
+    std::string name;
+    DXFHandle handle = kNoHandle;
+    bool begun = false;
+    while (true) {
+      auto block_pair_or = input.Next();
+      if (!block_pair_or.ok()) return block_pair_or.status();
+
+      const auto& block_pair = *block_pair_or;
+      if (!begun && block_pair.group_code == 2) {
+        name = std::string(block_pair.value);
+      } else if (!begun && block_pair.group_code == 5) {
+        handle = ParseHandle(block_pair.value);
+      } else if (block_pair.group_code == 0) {
+        // Block properties end at the first entity or ENDBLK
+        if (!begun) {
+          auto status = visitor.OnBlockBegin({name, handle});
+          if (!status.ok()) return status;
+          begun = true;
+        }
+        if (block_pair.value == "ENDBLK") {
+          auto status = visitor.OnBlockEnd({name, handle});
+          if (!status.ok()) return status;
+          break;
+        }
+        if (!WantsEntity(block_pair.value)) {
+          input.SkipRecord();
+          continue;
+        }
+
+        ReadEntity(input, block_pair.value, &entity);
+        auto status = visitor.OnEntity(entity);
+        if (!status.ok()) return status;
+        input.ReleaseConsumed();
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DXFTextParser::VisitEntities(DXFTokenizer& input,
+                                          DXFVisitor& visitor) {
+  DXFEntity entity;  // Reused for every entity
+
+  while (true) {
+    auto pair_or = input.Next();
+    if (!pair_or.ok()) return pair_or.status();
+
+    const auto& pair = *pair_or;
+    if (pair.group_code == 0 && pair.value == "ENDSEC") {
+      break;
+    }
+
+    if (pair.group_code == 0 && !WantsEntity(pair.value)) {
+      input.SkipRecord();
+    } else if (pair.group_code == 0) {
+      ReadEntity(input, pair.value, &entity);
+      auto status = visitor.OnEntity(entity);
+      if (!status.ok()) return status;
+      input.ReleaseConsumed();
+    }
+  }
+
+  return absl::OkStatus();
 }
 
 void DXFTextParser::BuildLookups(DXFFile& file) {
+  file.entity_by_handle.reserve(file.entities.size());
+  file.block_by_name.reserve(file.blocks.size());
+
   // Build entity lookup by handle
   for (const auto& entity : file.entities) {
-    if (!entity.handle.empty()) {
+    if (entity.handle != kNoHandle) {
       file.entity_by_handle[entity.handle] = &entity;
     }
   }
@@ -307,11 +1486,25 @@ void DXFTextParser::BuildLookups(DXFFile& file) {
   // Also add block entities to entity lookup
   for (const auto& block : file.blocks) {
     for (const auto& entity : block.entities) {
-      if (!entity.handle.empty()) {
+      if (entity.handle != kNoHandle) {
         file.entity_by_handle[entity.handle] = &entity;
       }
     }
   }
+
+  // Tables by name, and layers by their name (group code 2)
+  for (const auto& table : file.tables) {
+    if (!table.name.empty()) {
+      file.table_by_name[table.name] = &table;
+    }
+    if (table.name != "LAYER") continue;
+    for (const auto& layer : table.records) {
+      auto name_or = layer.GetString(2);
+      if (name_or.ok() && !name_or->empty()) {
+        file.layer_by_name[*name_or] = &layer;
+      }
+    }
+  }
 }
 
 }  // namespace finetoo::parser
@@ -1,67 +1,286 @@
 // Copyright 2025 Finetoo
 // Simple DXF Text Parser
 //
-// Parses DXF files (text format) without external dependencies.
+// Parses DXF files (text format, or binary DXF detected by its sentinel)
+// without external dependencies.
 // DXF format: alternating group code / value pairs
+//
+// Parsing is zero-copy: files are memory-mapped and every string in the
+// result is a view into the mapping, which the DXFFile keeps alive. Entities
+// and their pairs are bump-allocated from arenas the DXFFile owns. Streams
+// are tokenized as they are read, without seeking. gzip and zstd inputs are
+// recognized by magic number and decompressed on a background thread while
+// they are tokenized. Large in-memory inputs are split at section and entity
+// boundaries and parsed on several threads. With track_changes, a later
+// Reparse() of the same drawing tokenizes only the blocks and entities that
+// changed since. A DXFVisitor can instead receive entities one at a time as
+// they are read, without a DXFFile ever being built. Probe() reports a
+// drawing's header metadata and record counts without decoding any
+// entities.
 
 #pragma once
 
-#include <fstream>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "src/parser/dxf_arena.h"
+#include "src/parser/dxf_buffer.h"
+#include "src/parser/dxf_handle.h"
+#include "src/parser/dxf_tokenizer.h"
 
 namespace finetoo::parser {
 
-// DXF group code / value pair
-struct DXFPair {
-  int group_code;
-  std::string value;
+// Where an entity's first pair with a given group code sits, with its value
+// pre-decoded when the code is numeric per the DXF reference (10-59 reals,
+// 60-99 integers, ...)
+struct DXFGroupIndex {
+  int32_t group_code;
+  uint32_t position;  // Into DXFEntity::data
+  bool has_double = false;
+  bool has_int = false;
+  int32_t int_value = 0;
+  double double_value = 0;
 };
 
 // Parsed DXF entity
 struct DXFEntity {
-  std::string type;     // "LINE", "CIRCLE", "DIMENSION", etc.
-  std::string handle;   // Unique identifier (group code 5)
-  std::string layer;    // Layer name (group code 8)
+  DXFEntity() = default;
+  explicit DXFEntity(DXFArena* arena) : data(arena), index(arena) {}
+
+  absl::string_view type;     // "LINE", "CIRCLE", "DIMENSION", etc.
+  DXFHandle handle = kNoHandle;  // Unique identifier (group code 5)
+  absl::string_view layer;    // Layer name (group code 8)
 
   // All group code/value pairs for this entity
-  std::vector<DXFPair> data;
+  DXFVector<DXFPair> data;
+
+  // One entry per distinct group code in `data`, sorted by code. Filled in
+  // by the parser; call BuildIndex() after changing `data` by hand (an
+  // entity without an index falls back to scanning `data`).
+  DXFVector<DXFGroupIndex> index;
+  void BuildIndex();
+
+  // Bytes of the record (and any filtered-out records after it). Set for
+  // blocks and top-level records parsed with track_changes.
+  absl::string_view source;
 
-  // Convenience accessors
-  absl::StatusOr<std::string> GetString(int group_code) const;
+  // Convenience accessors. The first pair with `group_code` wins.
+  absl::StatusOr<absl::string_view> GetString(int group_code) const;
   absl::StatusOr<double> GetDouble(int group_code) const;
   absl::StatusOr<int> GetInt(int group_code) const;
 };
 
 // Parsed DXF block definition
 struct DXFBlock {
-  std::string name;     // Block name (group code 2)
-  std::string handle;   // Block handle
-  std::vector<DXFEntity> entities;  // Entities within the block
+  DXFBlock() = default;
+  explicit DXFBlock(DXFArena* arena) : entities(arena) {}
+
+  absl::string_view name;     // Block name (group code 2)
+  DXFHandle handle = kNoHandle;  // Block handle
+  DXFDeque<DXFEntity> entities;  // Entities within the block
+
+  // As DXFEntity::source, through the block's ENDBLK record
+  absl::string_view source;
+};
+
+// Parsed symbol table (LAYER, LTYPE, STYLE, BLOCK_RECORD, ...). Each entry
+// is a record like an entity: type is the record type ("LAYER") and the
+// entry's name is group code 2.
+struct DXFTable {
+  DXFTable() = default;
+  explicit DXFTable(DXFArena* arena) : records(arena) {}
+
+  absl::string_view name;     // Table name (group code 2)
+  DXFHandle handle = kNoHandle;  // Table handle
+  DXFDeque<DXFEntity> records;   // Table entries
 };
 
-// Complete parsed DXF file
+// Complete parsed DXF file. Movable, not copyable.
 struct DXFFile {
+  DXFFile();
+  DXFFile(DXFFile&& other);
+  DXFFile& operator=(DXFFile&& other);
+
+  // Exchange contents, arenas included, with `other`. Never throws.
+  void swap(DXFFile& other) noexcept;
+
+  // Memory for the containers below (one arena per parser thread). Declared
+  // first so that it outlives them.
+  std::vector<std::unique_ptr<DXFArena>> arenas;
+
   std::string version;  // DXF version (e.g., "AC1027")
-  std::vector<DXFEntity> entities;  // All entities in ENTITIES section
-  std::vector<DXFBlock> blocks;     // All blocks in BLOCKS section
+  DXFDeque<DXFEntity> entities;  // All entities in ENTITIES section
+  DXFDeque<DXFBlock> blocks;     // All blocks in BLOCKS section
+  DXFDeque<DXFTable> tables;     // All tables in TABLES section
+  DXFDeque<DXFEntity> objects;   // All objects in OBJECTS section
 
-  // Entity lookup by handle
-  absl::flat_hash_map<std::string, const DXFEntity*> entity_by_handle;
+  // Entity lookup by handle. Entities and blocks never move, so appending
+  // to the containers above leaves both maps valid.
+  absl::flat_hash_map<DXFHandle, const DXFEntity*> entity_by_handle;
 
   // Block lookup by name
-  absl::flat_hash_map<std::string, const DXFBlock*> block_by_name;
+  absl::flat_hash_map<absl::string_view, const DXFBlock*> block_by_name;
+
+  // Table lookup by name ("LAYER", ...), and LAYER table entries by name
+  absl::flat_hash_map<absl::string_view, const DXFTable*> table_by_name;
+  absl::flat_hash_map<absl::string_view, const DXFEntity*> layer_by_name;
+
+  // Source bytes that every string_view above points into. Shared with the
+  // caller that handed the buffer to Parse(), which may keep reading it.
+  std::shared_ptr<const DXFBuffer> buffer;
+
+  // Binary DXF only: text of numeric values, which have none in the source
+  std::shared_ptr<const DXFBuffer> decoded_values;
+};
+
+// Entity handed to a DXFVisitor. Only valid during the callback.
+struct DXFEntityView {
+  absl::string_view type;
+  DXFHandle handle = kNoHandle;
+  absl::string_view layer;
+  absl::Span<const DXFPair> data;
+  absl::Span<const DXFGroupIndex> index;
+
+  DXFEntityView() = default;
+  DXFEntityView(const DXFEntity& entity)  // NOLINT: implicit by design
+      : type(entity.type),
+        handle(entity.handle),
+        layer(entity.layer),
+        data(entity.data),
+        index(entity.index) {}
+
+  // Same accessors as DXFEntity
+  absl::StatusOr<absl::string_view> GetString(int group_code) const;
+  absl::StatusOr<double> GetDouble(int group_code) const;
+  absl::StatusOr<int> GetInt(int group_code) const;
+
+ private:
+  // Index entry for `group_code`, or null if absent or not indexed
+  const DXFGroupIndex* Find(int group_code) const;
+};
+
+// Block handed to a DXFVisitor. Only valid during the callback.
+struct DXFBlockView {
+  absl::string_view name;
+  DXFHandle handle = kNoHandle;
+};
+
+// SAX-style receiver for streamed parsing. Records are delivered in file
+// order: symbol table entries, block entities between OnBlockBegin and
+// OnBlockEnd, then the entities of the ENTITIES section. Nothing is
+// retained after a callback returns, so a visitor can process arbitrarily
+// large drawings in constant memory. A non-OK status from any callback
+// stops the parse and is returned by it.
+class DXFVisitor {
+ public:
+  virtual ~DXFVisitor() = default;
+
+  // DXF version from the HEADER section ($ACADVER)
+  virtual absl::Status OnVersion(absl::string_view version) {
+    return absl::OkStatus();
+  }
+
+  // Entry of the symbol table named `table` ("LAYER", ...)
+  virtual absl::Status OnTableRecord(absl::string_view table,
+                                     const DXFEntityView& record) {
+    return absl::OkStatus();
+  }
+
+  virtual absl::Status OnBlockBegin(const DXFBlockView& block) {
+    return absl::OkStatus();
+  }
+
+  virtual absl::Status OnEntity(const DXFEntityView& entity) {
+    return absl::OkStatus();
+  }
+
+  virtual absl::Status OnBlockEnd(const DXFBlockView& block) {
+    return absl::OkStatus();
+  }
+};
+
+// What DXFTextParser::Reparse() carried over from the previous parse. Each
+// list kept a run of unchanged records at its front and back; the records
+// in between are new (all of them, when nothing could be reused).
+struct DXFChanges {
+  struct Kept {
+    size_t prefix = 0;
+    size_t suffix = 0;
+  };
+  Kept blocks;
+  Kept entities;
+  Kept objects;
+};
+
+// Drawing metadata from DXFTextParser::Probe
+struct DXFProbe {
+  std::string version;  // $ACADVER
+
+  // Drawing extents ($EXTMIN / $EXTMAX), when the header has them
+  bool has_extents = false;
+  std::array<double, 3> extents_min = {0, 0, 0};
+  std::array<double, 3> extents_max = {0, 0, 0};
+
+  std::vector<std::string> sections;  // Section names in file order
+  size_t file_bytes = 0;              // Size of the input as stored
+
+  int64_t layer_count = 0;   // LAYER table entries
+  int64_t block_count = 0;   // BLOCK records, *Model_Space etc. included
+  int64_t entity_count = 0;  // ENTITIES section records
+
+  // False if entity_count was extrapolated from samples of a large
+  // ENTITIES section rather than counted
+  bool entity_count_exact = true;
+};
+
+// Parser options
+struct DXFParseOptions {
+  // Memory-map files passed by path. When false the file is read onto the
+  // heap instead (values are still zero-copy views into that copy).
+  bool use_mmap = true;
+
+  // Threads used for mapped and in-memory inputs: 0 = one per hardware
+  // thread, 1 = parse on the calling thread. Streams are always sequential.
+  // Results are identical (file order) for any thread count.
+  int num_threads = 0;
+
+  // Filters applied while tokenizing; an empty set keeps everything.
+  // Unwanted sections and entities are skipped without being decoded or
+  // stored, e.g. a BOM pass can keep only BLOCKS/ENTITIES and INSERTs.
+  // Blocks and tables themselves are always kept when their section is
+  // wanted (possibly with no entities). entity_types also applies to
+  // OBJECTS records, group_codes to every record. DXFEntity::handle and
+  // layer are filled in even when group codes 5 and 8 are filtered out of
+  // DXFEntity::data.
+  absl::flat_hash_set<std::string> sections;      // "HEADER", "TABLES", ...
+  absl::flat_hash_set<std::string> entity_types;  // "INSERT", "LINE", ...
+  absl::flat_hash_set<int> group_codes;           // Pairs kept in data
+
+  // Record each block's and top-level record's source, for Reparse().
+  // Files are then read rather than mapped, so a drawing saved over in
+  // place leaves the earlier parse intact, and its bytes can be compared
+  // with the new ones. Text input only: binary and compressed drawings
+  // record nothing.
+  bool track_changes = false;
 };
 
 // Simple DXF text parser
 class DXFTextParser {
  public:
   DXFTextParser() = default;
+  explicit DXFTextParser(const DXFParseOptions& options) : options_(options) {}
 
   // Non-copyable, movable
   DXFTextParser(const DXFTextParser&) = delete;
@@ -72,31 +291,122 @@ class DXFTextParser {
   // Parse DXF file from path
   absl::StatusOr<DXFFile> Parse(absl::string_view file_path);
 
-  // Parse DXF from input stream
+  // Parse DXF from input stream (pipes and stdin included)
   absl::StatusOr<DXFFile> Parse(std::istream& input);
 
+  // Parse DXF already loaded into a buffer
+  absl::StatusOr<DXFFile> Parse(std::shared_ptr<const DXFBuffer> buffer);
+
+  // Stream a drawing through `visitor` instead of building a DXFFile.
+  // Always sequential; streams keep only the block being tokenized.
+  absl::Status Parse(absl::string_view file_path, DXFVisitor& visitor);
+  absl::Status Parse(std::istream& input, DXFVisitor& visitor);
+  absl::Status Parse(const DXFBuffer& buffer, DXFVisitor& visitor);
+
+  // Read the header and record counts of a drawing without parsing it. A
+  // mapped text file is only searched for section and block markers, and
+  // its entity count is estimated from a few samples when the ENTITIES
+  // section is large. Binary and compressed files are tokenized throughout
+  // (counts are exact). Parse filters do not apply.
+  absl::StatusOr<DXFProbe> Probe(absl::string_view file_path);
+
+  // Parse a new version of `previous`, a drawing parsed with the same
+  // options and track_changes. Blocks and top-level records whose source
+  // bytes are unchanged at either end of their section are copied over
+  // instead of tokenized; `changes` (optional) says which. Without sources
+  // to compare against this is a plain Parse() that keeps nothing.
+  absl::StatusOr<DXFFile> Reparse(const DXFFile& previous,
+                                  absl::string_view file_path,
+                                  DXFChanges* changes = nullptr);
+  absl::StatusOr<DXFFile> Reparse(const DXFFile& previous,
+                                  std::shared_ptr<const DXFBuffer> buffer,
+                                  DXFChanges* changes = nullptr);
+
  private:
-  // Read next group code / value pair
-  absl::StatusOr<DXFPair> ReadPair(std::istream& input);
+  // How a section's pairs end: at its ENDSEC record, or (for a chunk of a
+  // section handed to a worker) at the end of the input
+  enum class SectionEnd { kEndSec, kEndOfInput };
+
+  // Filters from DXFParseOptions
+  bool WantsSection(absl::string_view name) const {
+    return options_.sections.empty() || options_.sections.contains(name);
+  }
+  bool WantsEntity(absl::string_view type) const {
+    return options_.entity_types.empty() || options_.entity_types.contains(type);
+  }
+  bool WantsGroupCode(int group_code) const {
+    return options_.group_codes.empty() ||
+           options_.group_codes.contains(group_code);
+  }
+
+  // Skip the rest of a section, through its ENDSEC record
+  void SkipSection(DXFTokenizer& input);
+
+  // Parse / visit an uncompressed stream
+  absl::StatusOr<DXFFile> ParseStream(std::istream& input);
+  absl::Status VisitStream(std::istream& input, DXFVisitor& visitor);
+
+  // Parse all sections up to EOF
+  absl::Status ParseSections(DXFTokenizer& input, DXFFile& file);
+
+  // Split the buffer at section/entity boundaries and parse the pieces on
+  // worker threads. Returns nullopt if the layout is unusual or any piece
+  // fails, in which case the caller parses sequentially (for exact errors).
+  std::optional<DXFFile> ParseParallel(std::shared_ptr<const DXFBuffer> buffer,
+                                       int num_threads);
+
+  // Probe helpers: count records by walking every token (binary and
+  // compressed input), and read the probed HEADER variables
+  absl::Status ProbeTokens(DXFTokenizer& input, DXFProbe* probe);
+  absl::Status ProbeHeader(DXFTokenizer& input, DXFProbe* probe,
+                           SectionEnd end = SectionEnd::kEndSec);
 
   // Parse HEADER section
-  absl::Status ParseHeader(std::istream& input, DXFFile& file);
+  absl::Status ParseHeader(DXFTokenizer& input, std::string* version,
+                           SectionEnd end = SectionEnd::kEndSec);
+
+  // Parse BLOCKS section. OutOfRange if the input ends inside a block (the
+  // partial block is still appended).
+  absl::Status ParseBlocks(DXFTokenizer& input, DXFDeque<DXFBlock>* blocks,
+                           SectionEnd end = SectionEnd::kEndSec);
+
+  // Parse a block's properties and entities through its ENDBLK record
+  absl::Status ParseBlockBody(DXFTokenizer& input, DXFBlock* block);
+
+  // Parse TABLES section
+  absl::Status ParseTables(DXFTokenizer& input, DXFDeque<DXFTable>* tables,
+                           SectionEnd end = SectionEnd::kEndSec);
+
+  // Parse a table's properties and entries through its ENDTAB record
+  absl::Status ParseTableBody(DXFTokenizer& input, DXFTable* table);
+
+  // Parse ENTITIES section (or OBJECTS, which has the same layout)
+  absl::Status ParseEntities(DXFTokenizer& input,
+                             DXFDeque<DXFEntity>* entities,
+                             SectionEnd end = SectionEnd::kEndSec);
+
+  // Parse a single entity onto `entities`, stopping before the next group
+  // code 0
+  void ParseEntity(DXFTokenizer& input, absl::string_view entity_type,
+                   DXFDeque<DXFEntity>* entities);
 
-  // Parse BLOCKS section
-  absl::Status ParseBlocks(std::istream& input, DXFFile& file);
+  // Read a single entity into `entity`, reusing its storage
+  void ReadEntity(DXFTokenizer& input, absl::string_view entity_type,
+                  DXFEntity* entity);
 
-  // Parse ENTITIES section
-  absl::Status ParseEntities(std::istream& input, DXFFile& file);
+  // Deliver all sections up to EOF to `visitor`
+  absl::Status VisitSections(DXFTokenizer& input, DXFVisitor& visitor);
 
-  // Parse a single entity
-  absl::StatusOr<DXFEntity> ParseEntity(std::istream& input,
-                                         const std::string& entity_type);
+  // Deliver the records of a TABLES, BLOCKS or ENTITIES section to
+  // `visitor`
+  absl::Status VisitTables(DXFTokenizer& input, DXFVisitor& visitor);
+  absl::Status VisitBlocks(DXFTokenizer& input, DXFVisitor& visitor);
+  absl::Status VisitEntities(DXFTokenizer& input, DXFVisitor& visitor);
 
   // Build lookup maps
   void BuildLookups(DXFFile& file);
 
-  // Current line number (for error reporting)
-  int line_number_ = 0;
+  DXFParseOptions options_;
 };
 
 }  // namespace finetoo::parser
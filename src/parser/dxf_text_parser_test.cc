@@ -0,0 +1,919 @@
+// Copyright 2025 Finetoo
+// DXFTextParser Tests
+
+#include "src/parser/dxf_text_parser.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_replace.h"
+#include "src/parser/dxf_binary.h"
+
+namespace finetoo::parser {
+namespace {
+
+// Minimal R12-style drawing: header, one block, two entities
+constexpr char kSmallDXF[] =
+    "  0\nSECTION\n  2\nHEADER\n"
+    "  9\n$ACADVER\n  1\nAC1009\n"
+    "  0\nENDSEC\n"
+    "  0\nSECTION\n  2\nBLOCKS\n"
+    "  0\nBLOCK\n  8\n0\n  2\nNUT\n 70\n     0\n"
+    "  0\nCIRCLE\n  5\n2A\n  8\n0\n 10\n0.0\n 20\n0.0\n 40\n0.25\n"
+    "  0\nENDBLK\n  8\n0\n"
+    "  0\nENDSEC\n"
+    "  0\nSECTION\n  2\nENTITIES\n"
+    "  0\nLINE\n  5\n1F\n  8\nWALLS\n 10\n1.5\n 20\n-2.0\n 11\n3.0\n 21\n4.0\n"
+    "  0\nINSERT\n  5\n20\n  8\nPARTS\n  2\nNUT\n 10\n5.0\n 20\n6.0\n 66\n     1\n"
+    "  0\nENDSEC\n"
+    "  0\nEOF\n";
+
+// Stream buffer that refuses to seek, like a pipe or decompressor
+class NonSeekableBuf : public std::stringbuf {
+ public:
+  explicit NonSeekableBuf(const std::string& contents)
+      : std::stringbuf(contents) {}
+
+ protected:
+  pos_type seekoff(off_type, std::ios_base::seekdir,
+                   std::ios_base::openmode) override {
+    return pos_type(off_type(-1));
+  }
+  pos_type seekpos(pos_type, std::ios_base::openmode) override {
+    return pos_type(off_type(-1));
+  }
+};
+
+// Drawing with `count` LINE entities (and a block per 100 of them, and an
+// object per 10), large enough to span stream blocks and be split across
+// parser threads. Block entities sit on layer "0", whose value line reads
+// like a group code 0.
+std::string MakeLargeDXF(int count) {
+  std::string dxf = "  0\nSECTION\n  2\nHEADER\n  9\n$ACADVER\n  1\nAC1009\n"
+                    "  0\nENDSEC\n  0\nSECTION\n  2\nTABLES\n"
+                    "  0\nTABLE\n  2\nLAYER\n 70\n     2\n"
+                    "  0\nLAYER\n  2\n0\n 70\n     0\n 62\n     7\n"
+                    "  0\nLAYER\n  2\nGEOMETRY\n 70\n     0\n 62\n     1\n"
+                    "  0\nENDTAB\n  0\nENDSEC\n  0\nSECTION\n  2\nBLOCKS\n";
+  for (int i = 0; i < count / 100; i++) {
+    dxf += "  0\nBLOCK\n  8\n0\n  2\nPART" + std::to_string(i) + "\n";
+    for (int j = 0; j < 10; j++) {
+      dxf += "  0\nCIRCLE\n  5\nB" + std::to_string(i * 10 + j) +
+             "\n  8\n0\n 40\n0\n";
+    }
+    dxf += "  0\nENDBLK\n  8\n0\n";
+  }
+  dxf += "  0\nENDSEC\n  0\nSECTION\n  2\nENTITIES\n";
+  for (int i = 0; i < count; i++) {
+    dxf += "  0\nLINE\n  5\n" + std::to_string(i + 1) +
+           "\n  8\nGEOMETRY\n 10\n" + std::to_string(i * 0.5) +
+           "\n 20\n" + std::to_string(i * 0.25) + "\n";
+  }
+  dxf += "  0\nENDSEC\n  0\nSECTION\n  2\nOBJECTS\n";
+  for (int i = 0; i < count / 10; i++) {
+    dxf += "  0\nXRECORD\n  5\nA" + std::to_string(i) + "\n  1\nPART\n";
+  }
+  dxf += "  0\nENDSEC\n  0\nEOF\n";
+  return dxf;
+}
+
+// Re-encode an ASCII drawing as binary DXF (1-byte group codes if `r12`)
+std::string ToBinaryDXF(absl::string_view ascii, bool r12 = false) {
+  auto put = [](std::string* out, uint64_t value, int size) {
+    for (int i = 0; i < size; i++) out->push_back(char(value >> (8 * i)));
+  };
+
+  std::string binary(kBinaryDXFSentinel.data(), kBinaryDXFSentinel.size());
+  DXFTokenizer tokens(ascii);
+  for (auto pair_or = tokens.Next(); pair_or.ok(); pair_or = tokens.Next()) {
+    int code = pair_or->group_code;
+    if (r12 && code < 255) {
+      binary.push_back(char(code));
+    } else {
+      if (r12) binary.push_back(char(255));
+      put(&binary, code, 2);
+    }
+
+    double real = 0;
+    int64_t integer = 0;
+    absl::SimpleAtod(pair_or->value, &real);
+    absl::SimpleAtoi(pair_or->value, &integer);
+    switch (BinaryValueType(code)) {
+      case DXFBinaryValue::kString:
+        binary.append(pair_or->value.data(), pair_or->value.size());
+        binary.push_back('\0');
+        break;
+      case DXFBinaryValue::kDouble:
+        put(&binary, std::bit_cast<uint64_t>(real), 8);
+        break;
+      case DXFBinaryValue::kInt16:
+        put(&binary, integer, 2);
+        break;
+      case DXFBinaryValue::kInt32:
+        put(&binary, integer, 4);
+        break;
+      case DXFBinaryValue::kInt64:
+        put(&binary, integer, 8);
+        break;
+      case DXFBinaryValue::kBool:
+        put(&binary, integer, 1);
+        break;
+      case DXFBinaryValue::kBytes:
+        ADD_FAILURE() << "binary chunks not supported";
+        break;
+    }
+  }
+  return binary;
+}
+
+// gzip-compress `data` as a single member
+std::string Gzip(absl::string_view data) {
+  z_stream z{};
+  deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+               Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&z, data.size()), '\0');
+  z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  z.avail_in = data.size();
+  z.next_out = reinterpret_cast<Bytef*>(out.data());
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+std::string Zstd(absl::string_view data) {
+  std::string out(ZSTD_compressBound(data.size()), '\0');
+  out.resize(ZSTD_compress(out.data(), out.size(), data.data(), data.size(), 3));
+  return out;
+}
+
+// Expect two parses of the same drawing to agree value for value
+void ExpectSameEntities(const DXFDeque<DXFEntity>& actual,
+                        const DXFDeque<DXFEntity>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); i++) {
+    ASSERT_EQ(actual[i].type, expected[i].type);
+    ASSERT_EQ(actual[i].handle, expected[i].handle);
+    ASSERT_EQ(actual[i].layer, expected[i].layer);
+    ASSERT_EQ(actual[i].data.size(), expected[i].data.size());
+    for (size_t j = 0; j < actual[i].data.size(); j++) {
+      int code = actual[i].data[j].group_code;
+      ASSERT_EQ(code, expected[i].data[j].group_code);
+      if (BinaryValueType(code) == DXFBinaryValue::kString) {
+        ASSERT_EQ(actual[i].data[j].value, expected[i].data[j].value);
+      } else {
+        ASSERT_EQ(actual[i].GetDouble(code).value(),
+                  expected[i].GetDouble(code).value());
+      }
+    }
+  }
+}
+
+// Records what a streamed parse delivers
+class RecordingVisitor : public DXFVisitor {
+ public:
+  absl::Status OnVersion(absl::string_view version) override {
+    version_ = std::string(version);
+    return absl::OkStatus();
+  }
+
+  absl::Status OnBlockBegin(const DXFBlockView& block) override {
+    events_.push_back("begin " + std::string(block.name));
+    return absl::OkStatus();
+  }
+
+  absl::Status OnEntity(const DXFEntityView& entity) override {
+    handles_.push_back(FormatHandle(entity.handle));
+    pairs_ += entity.data.size();
+    return absl::OkStatus();
+  }
+
+  absl::Status OnBlockEnd(const DXFBlockView& block) override {
+    events_.push_back("end " + std::string(block.name));
+    return absl::OkStatus();
+  }
+
+  std::string version_;
+  std::vector<std::string> events_;
+  std::vector<std::string> handles_;
+  size_t pairs_ = 0;
+};
+
+class DXFTextParserTest : public ::testing::Test {
+ protected:
+  // Write contents to a temp file and return its path
+  std::string WriteTempFile(absl::string_view contents) {
+    std::string path = ::testing::TempDir() + "/dxf_text_parser_test.dxf";
+    std::ofstream out(path, std::ios::binary);
+    out << contents;
+    return path;
+  }
+
+  DXFTextParser parser_;
+};
+
+TEST_F(DXFTextParserTest, ParsesStream) {
+  std::istringstream input(kSmallDXF);
+  auto file_or = parser_.Parse(input);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+
+  const auto& file = *file_or;
+  EXPECT_EQ(file.version, "AC1009");
+  ASSERT_EQ(file.entities.size(), 2);
+  ASSERT_EQ(file.blocks.size(), 1);
+
+  const auto& line = file.entities[0];
+  EXPECT_EQ(line.type, "LINE");
+  EXPECT_EQ(line.handle, 0x1F);
+  EXPECT_EQ(line.layer, "WALLS");
+  EXPECT_EQ(line.data.size(), 6);
+
+  const auto& block = file.blocks[0];
+  EXPECT_EQ(block.name, "NUT");
+  ASSERT_EQ(block.entities.size(), 1);
+  EXPECT_EQ(block.entities[0].type, "CIRCLE");
+
+  EXPECT_EQ(file.entity_by_handle.size(), 3);
+  EXPECT_EQ(file.block_by_name.size(), 1);
+}
+
+TEST_F(DXFTextParserTest, AccessorsDecodeValues) {
+  std::istringstream input(kSmallDXF);
+  auto file_or = parser_.Parse(input);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+
+  const auto& insert = file_or->entities[1];
+  auto name_or = insert.GetString(2);
+  ASSERT_TRUE(name_or.ok());
+  EXPECT_EQ(*name_or, "NUT");
+
+  auto x_or = insert.GetDouble(10);
+  ASSERT_TRUE(x_or.ok());
+  EXPECT_DOUBLE_EQ(*x_or, 5.0);
+
+  auto attribs_follow_or = insert.GetInt(66);
+  ASSERT_TRUE(attribs_follow_or.ok());
+  EXPECT_EQ(*attribs_follow_or, 1);
+
+  EXPECT_TRUE(absl::IsNotFound(insert.GetString(40).status()));
+  EXPECT_TRUE(absl::IsInvalidArgument(insert.GetDouble(8).status()));
+}
+
+TEST_F(DXFTextParserTest, IndexFindsFirstOccurrenceAndPredecodes) {
+  auto file_or = parser_.Parse(DXFBuffer::FromString(
+      "  0\nSECTION\n  2\nENTITIES\n"
+      "  0\nLWPOLYLINE\n  8\nA\n 90\n2\n 10\n1.5\n 20\n2\n"
+      " 10\n3.5\n 20\n4\n 70\n+1\n"
+      "  0\nENDSEC\n  0\nEOF\n"));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  const auto& polyline = file_or->entities[0];
+
+  // One entry per distinct code, sorted
+  ASSERT_EQ(polyline.index.size(), 5);
+  EXPECT_EQ(polyline.index[0].group_code, 8);
+  EXPECT_EQ(polyline.index[4].group_code, 90);
+
+  const DXFGroupIndex& x = polyline.index[1];
+  EXPECT_EQ(x.group_code, 10);
+  EXPECT_EQ(x.position, 2);
+  EXPECT_TRUE(x.has_double);
+  EXPECT_DOUBLE_EQ(x.double_value, 1.5);
+  EXPECT_DOUBLE_EQ(polyline.GetDouble(10).value(), 1.5);
+  EXPECT_EQ(polyline.GetInt(90).value(), 2);
+
+  // from_chars rejects '+'; the accessor still decodes it
+  EXPECT_FALSE(polyline.index[3].has_int);
+  EXPECT_EQ(polyline.GetInt(70).value(), 1);
+
+  // Hand-built entities work without an index, and can be given one
+  DXFEntity entity;
+  entity.data = {{40, "0.25"}, {40, "0.5"}};
+  EXPECT_DOUBLE_EQ(entity.GetDouble(40).value(), 0.25);
+  entity.BuildIndex();
+  ASSERT_EQ(entity.index.size(), 1);
+  EXPECT_DOUBLE_EQ(entity.GetDouble(40).value(), 0.25);
+}
+
+TEST(DXFHandleTest, RoundTripsHexHandles) {
+  EXPECT_EQ(ParseHandle("1F"), 0x1F);
+  EXPECT_EQ(ParseHandle("2a"), 0x2A);
+  EXPECT_EQ(ParseHandle("FFFFFFFFFFFFFFFF"), ~DXFHandle{0});
+  EXPECT_EQ(ParseHandle(""), kNoHandle);
+  EXPECT_EQ(ParseHandle("1G"), kNoHandle);
+  EXPECT_EQ(ParseHandle("-1"), kNoHandle);
+  EXPECT_EQ(ParseHandle("10000000000000000"), kNoHandle);  // 65 bits
+
+  EXPECT_EQ(FormatHandle(0x2A), "2A");
+  EXPECT_EQ(FormatHandle(0xABCDEF0123456789), "ABCDEF0123456789");
+  EXPECT_EQ(FormatHandle(kNoHandle), "");
+}
+
+TEST_F(DXFTextParserTest, LookupsSurviveAppendsAndMoves) {
+  auto file_or = parser_.Parse(DXFBuffer::FromString(kSmallDXF));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  DXFFile file = *std::move(file_or);
+  const DXFEntity* line = file.entity_by_handle.at(0x1F);
+  const DXFBlock* block = file.block_by_name.at("NUT");
+
+  // Appending must not move what the maps point to
+  for (int i = 0; i < 10000; i++) {
+    DXFEntity& entity = file.entities.emplace_back(file.arenas.front().get());
+    entity.type = "POINT";
+    entity.data = {{10, "1.0"}, {20, "2.0"}};
+  }
+  EXPECT_EQ(line, &file.entities[0]);
+  EXPECT_EQ(line->GetDouble(10).value(), 1.5);
+  EXPECT_EQ(block->entities.size(), 1);
+
+  // Copies leave the arena; moves keep it alive
+  DXFEntity copy = *line;
+  EXPECT_EQ(copy.data.get_allocator().arena(), nullptr);
+  DXFFile moved;
+  moved = std::move(file);
+  EXPECT_EQ(moved.entity_by_handle.at(0x1F), line);
+  EXPECT_EQ(moved.entities.size(), 10002);
+  EXPECT_EQ(copy.GetDouble(11).value(), 3.0);
+}
+
+TEST_F(DXFTextParserTest, MovedFromFileOutlivesItsArenas) {
+  // The source is destroyed after the file that took its arenas, so
+  // nothing it still holds may live in them
+  auto source = std::make_unique<DXFFile>(
+      *parser_.Parse(DXFBuffer::FromString(kSmallDXF)));
+  auto moved = std::make_unique<DXFFile>(std::move(*source));
+  EXPECT_EQ(moved->entities.size(), 2);
+  moved.reset();
+
+  EXPECT_TRUE(source->entities.empty());
+  EXPECT_TRUE(source->blocks.empty());
+  source->entities.emplace_back().type = "POINT";
+  source.reset();
+
+  // Assigning over a parsed file releases what it held
+  auto target_or = parser_.Parse(DXFBuffer::FromString(kSmallDXF));
+  auto other_or = parser_.Parse(DXFBuffer::FromString(kSmallDXF));
+  ASSERT_TRUE(target_or.ok() && other_or.ok());
+  const DXFEntity* line = other_or->entity_by_handle.at(0x1F);
+  *target_or = *std::move(other_or);
+  EXPECT_EQ(target_or->entity_by_handle.at(0x1F), line);
+  EXPECT_TRUE(other_or->entities.empty());
+  other_or->entities.emplace_back().type = "POINT";
+}
+
+TEST_F(DXFTextParserTest, MappedFileIsZeroCopy) {
+  std::string path = WriteTempFile(kSmallDXF);
+
+  auto file_or = parser_.Parse(path);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+
+  const auto& file = *file_or;
+  ASSERT_NE(file.buffer, nullptr);
+  EXPECT_TRUE(file.buffer->is_mapped());
+
+  // Every value is a view into the mapped bytes
+  absl::string_view contents = file.buffer->contents();
+  for (const auto& entity : file.entities) {
+    for (const auto& pair : entity.data) {
+      EXPECT_GE(pair.value.data(), contents.data());
+      EXPECT_LE(pair.value.data() + pair.value.size(),
+                contents.data() + contents.size());
+    }
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_F(DXFTextParserTest, MappedAndReadModesAgree) {
+  std::string path = WriteTempFile(kSmallDXF);
+
+  DXFParseOptions options;
+  options.use_mmap = false;
+  DXFTextParser read_parser(options);
+  auto mapped_or = parser_.Parse(path);
+  auto read_or = read_parser.Parse(path);
+  ASSERT_TRUE(mapped_or.ok()) << mapped_or.status();
+  ASSERT_TRUE(read_or.ok()) << read_or.status();
+  EXPECT_FALSE(read_or->buffer->is_mapped());
+
+  ASSERT_EQ(mapped_or->entities.size(), read_or->entities.size());
+  for (size_t i = 0; i < mapped_or->entities.size(); i++) {
+    EXPECT_EQ(mapped_or->entities[i].handle, read_or->entities[i].handle);
+    EXPECT_EQ(mapped_or->entities[i].data.size(),
+              read_or->entities[i].data.size());
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_F(DXFTextParserTest, HandlesCRLFLineEndings) {
+  std::string crlf;
+  for (char c : absl::string_view(kSmallDXF)) {
+    if (c == '\n') crlf += '\r';
+    crlf += c;
+  }
+
+  std::istringstream input(crlf);
+  auto file_or = parser_.Parse(input);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  ASSERT_EQ(file_or->entities.size(), 2);
+  EXPECT_EQ(file_or->entities[0].handle, 0x1F);
+  EXPECT_EQ(file_or->version, "AC1009");
+}
+
+TEST_F(DXFTextParserTest, ParsesNonSeekableStream) {
+  NonSeekableBuf buf(kSmallDXF);
+  std::istream input(&buf);
+  ASSERT_EQ(input.tellg(), std::streampos(-1));
+
+  auto file_or = parser_.Parse(input);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  EXPECT_EQ(file_or->entities.size(), 2);
+  EXPECT_EQ(file_or->blocks.size(), 1);
+}
+
+TEST_F(DXFTextParserTest, StreamSpanningBlocksMatchesBuffer) {
+  // ~5 MB, so pairs straddle several 1 MiB stream blocks
+  std::string dxf = MakeLargeDXF(100000);
+
+  NonSeekableBuf buf(dxf);
+  std::istream input(&buf);
+  auto streamed_or = parser_.Parse(input);
+  auto buffered_or = parser_.Parse(DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(streamed_or.ok()) << streamed_or.status();
+  ASSERT_TRUE(buffered_or.ok()) << buffered_or.status();
+
+  const auto& streamed = streamed_or->entities;
+  const auto& buffered = buffered_or->entities;
+  ASSERT_EQ(streamed.size(), 100000);
+  ASSERT_EQ(streamed.size(), buffered.size());
+  for (size_t i = 0; i < streamed.size(); i++) {
+    ASSERT_EQ(streamed[i].handle, buffered[i].handle);
+    ASSERT_EQ(streamed[i].data.size(), buffered[i].data.size());
+    for (size_t j = 0; j < streamed[i].data.size(); j++) {
+      ASSERT_EQ(streamed[i].data[j].value, buffered[i].data[j].value);
+    }
+  }
+}
+
+TEST_F(DXFTextParserTest, ParallelParseMatchesSequential) {
+  auto buffer = DXFBuffer::FromString(MakeLargeDXF(100000));
+
+  DXFParseOptions options;
+  options.num_threads = 1;
+  DXFTextParser sequential(options);
+  options.num_threads = 8;
+  DXFTextParser parallel(options);
+  auto expected_or = sequential.Parse(buffer);
+  auto actual_or = parallel.Parse(buffer);
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+  ASSERT_TRUE(actual_or.ok()) << actual_or.status();
+
+  const auto& expected = *expected_or;
+  const auto& actual = *actual_or;
+  EXPECT_EQ(actual.version, "AC1009");
+  ASSERT_EQ(actual.entities.size(), expected.entities.size());
+  for (size_t i = 0; i < actual.entities.size(); i++) {
+    ASSERT_EQ(actual.entities[i].handle, expected.entities[i].handle);
+    ASSERT_EQ(actual.entities[i].data.size(), expected.entities[i].data.size());
+  }
+  ASSERT_EQ(actual.blocks.size(), 1000);
+  ASSERT_EQ(actual.blocks.size(), expected.blocks.size());
+  for (size_t i = 0; i < actual.blocks.size(); i++) {
+    ASSERT_EQ(actual.blocks[i].name, expected.blocks[i].name);
+    ASSERT_EQ(actual.blocks[i].entities.size(), 10);
+  }
+  EXPECT_EQ(actual.entity_by_handle.size(), expected.entity_by_handle.size());
+  ASSERT_EQ(actual.objects.size(), 10000);
+  ExpectSameEntities(actual.objects, expected.objects);
+  ASSERT_EQ(actual.tables.size(), 1);
+  EXPECT_EQ(actual.layer_by_name.at("GEOMETRY")->GetInt(62).value(), 1);
+}
+
+TEST_F(DXFTextParserTest, ParsesTablesAndObjects) {
+  constexpr char kDXF[] =
+      "  0\nSECTION\n  2\nTABLES\n"
+      "  0\nTABLE\n  2\nLTYPE\n  5\n5\n 70\n     1\n"
+      "  0\nLTYPE\n  5\n14\n  2\nCONTINUOUS\n 70\n     0\n"
+      "  0\nENDTAB\n"
+      "  0\nTABLE\n  2\nLAYER\n  5\n2\n 70\n     2\n"
+      "  0\nLAYER\n  5\n10\n  2\n0\n 70\n     0\n 62\n     7\n"
+      "  0\nLAYER\n  5\n11\n  2\nWALLS\n 70\n     4\n 62\n    -1\n"
+      "  6\nCONTINUOUS\n"
+      "  0\nENDTAB\n"
+      "  0\nENDSEC\n"
+      "  0\nSECTION\n  2\nENTITIES\n"
+      "  0\nLINE\n  5\n1F\n  8\nWALLS\n 10\n0\n"
+      "  0\nENDSEC\n"
+      "  0\nSECTION\n  2\nOBJECTS\n"
+      "  0\nDICTIONARY\n  5\nC\n  3\nACAD_GROUP\n350\nD\n"
+      "  0\nENDSEC\n"
+      "  0\nEOF\n";
+  auto file_or = parser_.Parse(DXFBuffer::FromString(kDXF));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  const auto& file = *file_or;
+
+  ASSERT_EQ(file.tables.size(), 2);
+  EXPECT_EQ(file.tables[0].name, "LTYPE");
+  EXPECT_EQ(file.tables[1].handle, 0x2);
+  EXPECT_EQ(file.table_by_name.at("LAYER"), &file.tables[1]);
+  ASSERT_EQ(file.tables[1].records.size(), 2);
+
+  const DXFEntity* walls = file.layer_by_name.at("WALLS");
+  EXPECT_EQ(walls->type, "LAYER");
+  EXPECT_EQ(walls->handle, 0x11);
+  EXPECT_EQ(walls->GetInt(62).value(), -1);
+  EXPECT_EQ(walls->GetString(6).value(), "CONTINUOUS");
+  EXPECT_EQ(file.entities[0].layer, "WALLS");
+
+  ASSERT_EQ(file.objects.size(), 1);
+  EXPECT_EQ(file.objects[0].type, "DICTIONARY");
+  EXPECT_EQ(file.objects[0].GetString(350).value(), "D");
+
+  // Section filters skip both
+  DXFParseOptions options;
+  options.sections = {"ENTITIES"};
+  auto filtered_or = DXFTextParser(options).Parse(DXFBuffer::FromString(kDXF));
+  ASSERT_TRUE(filtered_or.ok()) << filtered_or.status();
+  EXPECT_TRUE(filtered_or->tables.empty());
+  EXPECT_TRUE(filtered_or->objects.empty());
+  EXPECT_EQ(filtered_or->entities.size(), 1);
+}
+
+TEST_F(DXFTextParserTest, ReparseKeepsUnchangedRecords) {
+  std::string dxf = MakeLargeDXF(100000);
+  std::string edited = absl::StrReplaceAll(
+      dxf, {{"  5\n50001\n  8\nGEOMETRY\n", "  5\n50001\n  8\nEDITED\n"},
+            {"PART500\n", "PART500X\n"}});
+
+  // Sources tile each section the same way whether or not it is split
+  DXFParseOptions options;
+  options.track_changes = true;
+  options.num_threads = 1;
+  DXFTextParser sequential(options);
+  options.num_threads = 8;
+  DXFTextParser parallel(options);
+  auto previous_or = parallel.Parse(DXFBuffer::FromString(dxf));
+  auto expected_or = sequential.Parse(DXFBuffer::FromString(edited));
+  ASSERT_TRUE(previous_or.ok()) << previous_or.status();
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+  const DXFFile& previous = *previous_or;
+  EXPECT_EQ(previous.entities[0].source.data(),
+            previous.entities[0].type.data() - 4);
+  EXPECT_EQ(previous.blocks[1].source.data(),
+            previous.blocks[0].source.data() + previous.blocks[0].source.size());
+
+  DXFChanges changes;
+  auto file_or = sequential.Reparse(
+      previous, DXFBuffer::FromString(edited), &changes);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  const DXFFile& file = *file_or;
+  EXPECT_EQ(changes.entities.prefix, 50000);
+  EXPECT_EQ(changes.entities.suffix, 49999);
+  EXPECT_EQ(changes.blocks.prefix, 500);
+  EXPECT_EQ(changes.blocks.suffix, 499);
+  EXPECT_EQ(changes.objects.prefix + changes.objects.suffix, 10000);
+
+  const DXFFile& expected = *expected_or;
+  EXPECT_EQ(file.version, "AC1009");
+  EXPECT_EQ(file.tables.size(), 1);
+  ExpectSameEntities(file.entities, expected.entities);
+  ExpectSameEntities(file.objects, expected.objects);
+  ASSERT_EQ(file.blocks.size(), expected.blocks.size());
+  for (size_t i = 0; i < file.blocks.size(); i++) {
+    ASSERT_EQ(file.blocks[i].name, expected.blocks[i].name);
+    ASSERT_EQ(file.blocks[i].source, expected.blocks[i].source);
+    ExpectSameEntities(file.blocks[i].entities, expected.blocks[i].entities);
+  }
+  for (size_t i = 0; i < file.entities.size(); i++) {
+    ASSERT_EQ(file.entities[i].source, expected.entities[i].source);
+  }
+  EXPECT_EQ(file.entities[50000].layer, "EDITED");
+  EXPECT_EQ(file.block_by_name.at("PART500X"), &file.blocks[500]);
+
+  // Copied records point into the new input, like parsed ones
+  absl::string_view contents = file.buffer->contents();
+  for (const DXFEntity* entity : {&file.entities[0], &file.entities[99999]}) {
+    EXPECT_GE(entity->layer.data(), contents.data());
+    EXPECT_LT(entity->layer.data(), contents.data() + contents.size());
+  }
+
+  // Without sources nothing is kept
+  auto untracked_or = parser_.Parse(DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(untracked_or.ok()) << untracked_or.status();
+  file_or = sequential.Reparse(*untracked_or, DXFBuffer::FromString(edited),
+                               &changes);
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+  EXPECT_EQ(changes.entities.prefix + changes.entities.suffix, 0);
+  ExpectSameEntities(file_or->entities, expected.entities);
+}
+
+TEST_F(DXFTextParserTest, VisitorSeesEntitiesInFileOrder) {
+  RecordingVisitor visitor;
+  auto status = parser_.Parse(*DXFBuffer::FromString(kSmallDXF), visitor);
+  ASSERT_TRUE(status.ok()) << status;
+
+  EXPECT_EQ(visitor.version_, "AC1009");
+  EXPECT_EQ(visitor.events_,
+            (std::vector<std::string>{"begin NUT", "end NUT"}));
+  EXPECT_EQ(visitor.handles_, (std::vector<std::string>{"2A", "1F", "20"}));
+}
+
+TEST_F(DXFTextParserTest, VisitorStreamMatchesDXFFile) {
+  std::string dxf = MakeLargeDXF(100000);
+  auto file_or = parser_.Parse(DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+
+  NonSeekableBuf buf(dxf);
+  std::istream input(&buf);
+  RecordingVisitor visitor;
+  auto status = parser_.Parse(input, visitor);
+  ASSERT_TRUE(status.ok()) << status;
+
+  std::vector<std::string> expected;
+  size_t expected_pairs = 0;
+  for (const auto& block : file_or->blocks) {
+    for (const auto& entity : block.entities) {
+      expected.push_back(FormatHandle(entity.handle));
+      expected_pairs += entity.data.size();
+    }
+  }
+  for (const auto& entity : file_or->entities) {
+    expected.push_back(FormatHandle(entity.handle));
+    expected_pairs += entity.data.size();
+  }
+  EXPECT_EQ(visitor.handles_, expected);
+  EXPECT_EQ(visitor.pairs_, expected_pairs);
+  EXPECT_EQ(visitor.events_.size(), 2 * file_or->blocks.size());
+}
+
+TEST_F(DXFTextParserTest, VisitorErrorStopsParse) {
+  class StopAfterFirst : public DXFVisitor {
+   public:
+    absl::Status OnEntity(const DXFEntityView& entity) override {
+      seen_++;
+      return absl::CancelledError("enough");
+    }
+    int seen_ = 0;
+  } visitor;
+
+  auto status = parser_.Parse(*DXFBuffer::FromString(kSmallDXF), visitor);
+  EXPECT_TRUE(absl::IsCancelled(status));
+  EXPECT_EQ(visitor.seen_, 1);
+}
+
+TEST_F(DXFTextParserTest, FiltersSectionsTypesAndGroupCodes) {
+  DXFTextParser parser(DXFParseOptions{
+      .sections = {"BLOCKS", "ENTITIES"},
+      .entity_types = {"INSERT"},
+      .group_codes = {2},
+  });
+  auto file_or = parser.Parse(DXFBuffer::FromString(kSmallDXF));
+  ASSERT_TRUE(file_or.ok()) << file_or.status();
+
+  EXPECT_EQ(file_or->version, "");  // HEADER skipped
+  ASSERT_EQ(file_or->blocks.size(), 1);
+  EXPECT_EQ(file_or->blocks[0].name, "NUT");
+  EXPECT_TRUE(file_or->blocks[0].entities.empty());
+
+  ASSERT_EQ(file_or->entities.size(), 1);
+  const auto& insert = file_or->entities[0];
+  EXPECT_EQ(insert.type, "INSERT");
+  EXPECT_EQ(insert.handle, 0x20);
+  EXPECT_EQ(insert.layer, "PARTS");
+  ASSERT_EQ(insert.data.size(), 1);
+  EXPECT_EQ(insert.GetString(2).value(), "NUT");
+}
+
+TEST_F(DXFTextParserTest, FilteredParallelParseMatchesSequential) {
+  auto buffer = DXFBuffer::FromString(MakeLargeDXF(100000));
+  DXFParseOptions options;
+  options.entity_types = {"CIRCLE"};
+
+  options.num_threads = 1;
+  auto expected_or = DXFTextParser(options).Parse(buffer);
+  options.num_threads = 8;
+  auto actual_or = DXFTextParser(options).Parse(buffer);
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+  ASSERT_TRUE(actual_or.ok()) << actual_or.status();
+
+  EXPECT_TRUE(actual_or->entities.empty());
+  EXPECT_EQ(actual_or->entity_by_handle.size(), 10000);
+  EXPECT_EQ(expected_or->entity_by_handle.size(), 10000);
+}
+
+TEST_F(DXFTextParserTest, TokenizerPeeksWithoutConsuming) {
+  DXFTokenizer tokens("  0\nLINE\n  8\nWALLS\n");
+
+  auto peeked_or = tokens.Peek();
+  ASSERT_TRUE(peeked_or.ok());
+  EXPECT_EQ(peeked_or->group_code, 0);
+  EXPECT_EQ(peeked_or->value, "LINE");
+
+  auto next_or = tokens.Next();
+  ASSERT_TRUE(next_or.ok());
+  EXPECT_EQ(next_or->value, "LINE");
+
+  next_or = tokens.Next();
+  ASSERT_TRUE(next_or.ok());
+  EXPECT_EQ(next_or->group_code, 8);
+  EXPECT_EQ(tokens.line_number(), 4);
+
+  EXPECT_TRUE(absl::IsOutOfRange(tokens.Peek().status()));
+}
+
+TEST_F(DXFTextParserTest, ScanKernelsAgree) {
+  std::string dxf = MakeLargeDXF(5000) + " 1\r\n  padded value \r\n";
+
+  std::vector<DXFToken> expected;
+  size_t expected_consumed = ScanPairs(dxf, 1 << 20, &expected, ScanKernel::kScalar);
+  ASSERT_EQ(expected_consumed, dxf.size());
+  ASSERT_EQ(expected.back().group_code, 1);
+  EXPECT_EQ(absl::string_view(dxf).substr(expected.back().value_offset,
+                                          expected.back().value_length),
+            "padded value");
+
+  for (ScanKernel kernel : {ScanKernel::kSSE2, BestScanKernel()}) {
+    std::vector<DXFToken> tokens;
+    EXPECT_EQ(ScanPairs(dxf, 1 << 20, &tokens, kernel), expected_consumed);
+    ASSERT_EQ(tokens.size(), expected.size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+      ASSERT_EQ(tokens[i].group_code, expected[i].group_code);
+      ASSERT_EQ(tokens[i].value_offset, expected[i].value_offset);
+      ASSERT_EQ(tokens[i].value_length, expected[i].value_length);
+    }
+  }
+}
+
+TEST_F(DXFTextParserTest, ScannerStopsAtUnusualPairs) {
+  std::vector<DXFToken> tokens;
+
+  // Malformed group code: stops before it
+  EXPECT_EQ(ScanPairs("  0\nLINE\nabc\nx\n", 16, &tokens), 9);
+  EXPECT_EQ(tokens.size(), 1);
+
+  // Unterminated value line: not consumed
+  EXPECT_EQ(ScanPairs("  0\nLINE\n  8\nWALLS", 16, &tokens), 9);
+  EXPECT_EQ(tokens.size(), 1);
+
+  // Respects max_tokens
+  EXPECT_EQ(ScanPairs("  0\nA\n  0\nB\n", 1, &tokens), 6);
+  EXPECT_EQ(tokens.size(), 1);
+}
+
+TEST_F(DXFTextParserTest, ParsesBinaryDXF) {
+  auto expected_or = parser_.Parse(DXFBuffer::FromString(kSmallDXF));
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+
+  for (bool r12 : {false, true}) {
+    std::string path = WriteTempFile(ToBinaryDXF(kSmallDXF, r12));
+    auto file_or = parser_.Parse(absl::string_view(path));
+    ASSERT_TRUE(file_or.ok()) << file_or.status();
+
+    EXPECT_EQ(file_or->version, "AC1009");
+    EXPECT_NE(file_or->decoded_values, nullptr);
+    ASSERT_EQ(file_or->blocks.size(), 1);
+    EXPECT_EQ(file_or->blocks[0].name, "NUT");
+    ExpectSameEntities(file_or->blocks[0].entities,
+                       expected_or->blocks[0].entities);
+    ExpectSameEntities(file_or->entities, expected_or->entities);
+    EXPECT_EQ(file_or->entities[1].GetInt(66).value(), 1);
+    EXPECT_EQ(file_or->entities[0].GetString(10).value(), "1.5");
+  }
+}
+
+TEST_F(DXFTextParserTest, StreamsLargeBinaryDXF) {
+  std::string ascii = MakeLargeDXF(100000);
+  auto expected_or = parser_.Parse(DXFBuffer::FromString(ascii));
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+
+  // Binary input also skips the parallel path, whatever the thread count
+  std::string binary = ToBinaryDXF(ascii);
+  DXFParseOptions options;
+  options.num_threads = 8;
+  DXFTextParser parallel(options);
+  auto buffered_or = parallel.Parse(DXFBuffer::FromString(binary));
+  ASSERT_TRUE(buffered_or.ok()) << buffered_or.status();
+  ExpectSameEntities(buffered_or->entities, expected_or->entities);
+  EXPECT_EQ(buffered_or->blocks.size(), expected_or->blocks.size());
+
+  NonSeekableBuf buf(binary);
+  std::istream input(&buf);
+  auto streamed_or = parser_.Parse(input);
+  ASSERT_TRUE(streamed_or.ok()) << streamed_or.status();
+  ExpectSameEntities(streamed_or->entities, expected_or->entities);
+}
+
+TEST_F(DXFTextParserTest, RejectsTruncatedBinaryDXF) {
+  std::string binary = ToBinaryDXF(kSmallDXF);
+  binary.resize(binary.size() - 3);  // Inside the final "EOF\0"
+  auto file_or = parser_.Parse(DXFBuffer::FromString(binary));
+  EXPECT_TRUE(absl::IsDataLoss(file_or.status())) << file_or.status();
+}
+
+TEST_F(DXFTextParserTest, ParsesCompressedInput) {
+  std::string dxf = MakeLargeDXF(100000);
+  auto expected_or = parser_.Parse(DXFBuffer::FromString(dxf));
+  ASSERT_TRUE(expected_or.ok()) << expected_or.status();
+
+  // Two gzip members back to back decompress to their concatenation
+  size_t half = dxf.size() / 2;
+  std::string two_members =
+      Gzip(absl::string_view(dxf).substr(0, half)) +
+      Gzip(absl::string_view(dxf).substr(half));
+
+  for (const std::string& compressed : {Gzip(dxf), two_members, Zstd(dxf)}) {
+    ASSERT_LT(compressed.size(), dxf.size() / 4);
+
+    std::string path = WriteTempFile(compressed);
+    auto mapped_or = parser_.Parse(absl::string_view(path));
+    ASSERT_TRUE(mapped_or.ok()) << mapped_or.status();
+    ExpectSameEntities(mapped_or->entities, expected_or->entities);
+    EXPECT_EQ(mapped_or->blocks.size(), expected_or->blocks.size());
+
+    NonSeekableBuf buf(compressed);
+    std::istream input(&buf);
+    RecordingVisitor visitor;
+    auto status = parser_.Parse(input, visitor);
+    ASSERT_TRUE(status.ok()) << status;
+    EXPECT_EQ(visitor.handles_.size(), 110000);
+  }
+}
+
+TEST_F(DXFTextParserTest, RejectsCorruptCompressedInput) {
+  std::string gzip = Gzip(kSmallDXF);
+  gzip.resize(gzip.size() - 10);  // Drop the trailer
+  auto file_or = parser_.Parse(DXFBuffer::FromString(gzip));
+  EXPECT_TRUE(absl::IsDataLoss(file_or.status())) << file_or.status();
+
+  std::string zstd = Zstd(kSmallDXF);
+  zstd.resize(zstd.size() - 4);
+  std::istringstream input(zstd);
+  file_or = parser_.Parse(input);
+  EXPECT_TRUE(absl::IsDataLoss(file_or.status())) << file_or.status();
+}
+
+TEST_F(DXFTextParserTest, ProbeReadsHeaderAndCounts) {
+  std::string small = absl::StrReplaceAll(
+      kSmallDXF, {{"  1\nAC1009\n",
+                   "  1\nAC1009\n  9\n$EXTMIN\n 10\n-1.5\n 20\n0\n 30\n0\n"
+                   "  9\n$EXTMAX\n 10\n10\n 20\n20.5\n 30\n0\n"}});
+  auto probe_or = parser_.Probe(WriteTempFile(small));
+  ASSERT_TRUE(probe_or.ok()) << probe_or.status();
+  EXPECT_EQ(probe_or->version, "AC1009");
+  EXPECT_EQ(probe_or->file_bytes, small.size());
+  ASSERT_TRUE(probe_or->has_extents);
+  EXPECT_EQ(probe_or->extents_min[0], -1.5);
+  EXPECT_EQ(probe_or->extents_max[1], 20.5);
+  EXPECT_EQ(probe_or->sections,
+            (std::vector<std::string>{"HEADER", "BLOCKS", "ENTITIES"}));
+  EXPECT_EQ(probe_or->block_count, 1);
+  EXPECT_EQ(probe_or->entity_count, 2);
+  EXPECT_TRUE(probe_or->entity_count_exact);
+
+  // A large text drawing has its entities sampled; binary and compressed
+  // ones are counted
+  std::string large = MakeLargeDXF(100000);
+  probe_or = parser_.Probe(WriteTempFile(large));
+  ASSERT_TRUE(probe_or.ok()) << probe_or.status();
+  EXPECT_EQ(probe_or->layer_count, 2);
+  EXPECT_EQ(probe_or->block_count, 1000);
+  EXPECT_FALSE(probe_or->entity_count_exact);
+  EXPECT_NEAR(probe_or->entity_count, 100000, 2000);
+
+  for (const std::string& encoded : {ToBinaryDXF(large), Zstd(large)}) {
+    probe_or = parser_.Probe(WriteTempFile(encoded));
+    ASSERT_TRUE(probe_or.ok()) << probe_or.status();
+    EXPECT_EQ(probe_or->version, "AC1009");
+    EXPECT_EQ(probe_or->sections.size(), 5);
+    EXPECT_EQ(probe_or->layer_count, 2);
+    EXPECT_EQ(probe_or->block_count, 1000);
+    EXPECT_EQ(probe_or->entity_count, 100000);
+    EXPECT_TRUE(probe_or->entity_count_exact);
+  }
+}
+
+TEST_F(DXFTextParserTest, MissingFileIsNotFound) {
+  auto file_or = parser_.Parse(absl::string_view("/nonexistent/drawing.dxf"));
+  EXPECT_TRUE(absl::IsNotFound(file_or.status()));
+}
+
+TEST_F(DXFTextParserTest, RejectsInvalidGroupCode) {
+  std::istringstream input("  0\nSECTION\nxyz\nHEADER\n");
+  auto file_or = parser_.Parse(input);
+  EXPECT_TRUE(absl::IsInvalidArgument(file_or.status()));
+}
+
+}  // namespace
+}  // namespace finetoo::parser
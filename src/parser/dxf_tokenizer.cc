@@ -0,0 +1,371 @@
+// Copyright 2025 Finetoo
+// DXF Tokenizer Implementation
+
+#include "src/parser/dxf_tokenizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+#include "src/parser/dxf_binary.h"
+
+namespace finetoo::parser {
+
+namespace {
+
+// Bytes requested from a stream per read
+constexpr size_t kStreamBlockSize = 1 << 20;
+
+// Pairs decoded per scanner call (~100 KB of typical DXF, stays in cache)
+constexpr size_t kBatchSize = 8192;
+
+// Block size for decoded binary values
+constexpr size_t kDecodedBlockSize = 64 << 10;
+
+// Little-endian unsigned integer of `size` bytes (binary DXF byte order)
+uint64_t LoadLittleEndian(const char* data, int size) {
+  uint64_t value = 0;
+  for (int i = 0; i < size; i++) {
+    value |= uint64_t{static_cast<uint8_t>(data[i])} << (8 * i);
+  }
+  return value;
+}
+
+// Split the next line off the front of `input`. The returned line excludes
+// the '\n' terminator (a trailing '\r' is left for the caller to strip).
+// `complete` is false if the line ran into the end of `input`.
+bool ReadLine(absl::string_view& input, absl::string_view* line,
+              bool* complete) {
+  if (input.empty()) return false;
+
+  const void* newline = memchr(input.data(), '\n', input.size());
+  if (newline == nullptr) {
+    *line = input;
+    *complete = false;
+    input.remove_prefix(input.size());
+    return true;
+  }
+
+  size_t length = static_cast<const char*>(newline) - input.data();
+  *line = input.substr(0, length);
+  *complete = true;
+  input.remove_prefix(length + 1);
+  return true;
+}
+
+}  // namespace
+
+DXFTokenizer::DXFTokenizer(absl::string_view input)
+    : input_(input), remaining_(input) {}
+
+DXFTokenizer::DXFTokenizer(std::istream& input, DXFBuffer* storage)
+    : stream_(&input), storage_(storage) {}
+
+absl::StatusOr<DXFPair> DXFTokenizer::Peek() {
+  auto status = Fill();
+  if (!status.ok()) return status;
+  if (!lookahead_status_.ok()) return lookahead_status_;
+  return lookahead_;
+}
+
+absl::StatusOr<DXFPair> DXFTokenizer::Next() {
+  auto pair_or = Peek();
+  has_lookahead_ = false;
+  return pair_or;
+}
+
+void DXFTokenizer::Skip() {
+  if (Fill().ok()) {
+    has_lookahead_ = false;
+  }
+}
+
+void DXFTokenizer::SkipRecord() {
+  while (true) {
+    // Walk the scanned batch directly rather than pair by pair
+    if (!has_lookahead_) {
+      while (batch_pos_ < batch_.size() && batch_[batch_pos_].group_code != 0) {
+        batch_pos_++;
+        line_number_ += 2;
+      }
+    }
+
+    auto pair_or = Peek();
+    if (!pair_or.ok() || pair_or->group_code == 0) return;
+    Skip();
+  }
+}
+
+void DXFTokenizer::ReleaseConsumed() {
+  // Unread input (and the lookahead) always sits in the newest block
+  if (storage_ != nullptr) storage_->ReleaseOldBlocks();
+  if (decoded_ != nullptr) decoded_->ReleaseOldBlocks();
+}
+
+absl::Status DXFTokenizer::Fill() {
+  if (format_ == Format::kUnknown && !DetectFormat()) {
+    return absl::DataLossError("Failed to read input");
+  }
+
+  while (!has_lookahead_) {
+    if (is_binary()) {
+      if (ReadBinaryPair(&lookahead_, &lookahead_status_)) {
+        has_lookahead_ = true;
+        break;
+      }
+    } else {
+      if (batch_pos_ < batch_.size()) {
+        const DXFToken& token = batch_[batch_pos_++];
+        lookahead_ = DXFPair{
+            token.group_code,
+            absl::string_view(batch_base_ + token.value_offset,
+                              token.value_length)};
+        lookahead_status_ = absl::OkStatus();
+        line_number_ += 2;
+        has_lookahead_ = true;
+        break;
+      }
+
+      if (ScanBatch()) continue;
+
+      // Malformed pair, end of input, or a pair cut off by the end of the
+      // block
+      if (ReadPair(&lookahead_, &lookahead_status_)) {
+        has_lookahead_ = true;
+        break;
+      }
+    }
+
+    // Pair straddles the end of the block; pull in more of the stream
+    if (!Refill()) {
+      return absl::DataLossError(
+          absl::StrFormat("Failed to read input after line %d", line_number_));
+    }
+  }
+  return absl::OkStatus();
+}
+
+bool DXFTokenizer::DetectFormat() {
+  // Streams: read far enough to see the sentinel and the first group code
+  const size_t needed = kBinaryDXFSentinel.size() + 2;
+  while (stream_ != nullptr && remaining_.size() < needed) {
+    if (!Refill()) return false;
+  }
+
+  if (!IsBinaryDXF(remaining_)) {
+    format_ = Format::kText;
+    return true;
+  }
+
+  // The first pair is 0/SECTION: a second zero byte means 2-byte codes
+  remaining_.remove_prefix(kBinaryDXFSentinel.size());
+  format_ = (remaining_.size() >= 2 && remaining_[1] == '\0')
+                ? Format::kBinary
+                : Format::kBinaryR12;
+  return true;
+}
+
+bool DXFTokenizer::ReadBinaryPair(DXFPair* pair, absl::Status* status) {
+  // A value cut off by the end of the block is only final once the stream
+  // is exhausted
+  const bool more_input = stream_ != nullptr;
+  auto truncated = [&]() {
+    if (more_input) return false;
+    *status = absl::DataLossError(absl::StrFormat(
+        "Truncated binary DXF pair after line %d", line_number_));
+    remaining_ = {};
+    return true;
+  };
+
+  absl::string_view input = remaining_;
+  if (input.empty()) {
+    if (more_input) return false;
+    *status = absl::OutOfRangeError("End of file");
+    return true;
+  }
+
+  // Group code
+  int group_code;
+  if (format_ == Format::kBinaryR12 && static_cast<uint8_t>(input[0]) != 255) {
+    group_code = static_cast<uint8_t>(input[0]);
+    input.remove_prefix(1);
+  } else {
+    if (format_ == Format::kBinaryR12) input.remove_prefix(1);
+    if (input.size() < 2) return truncated();
+    group_code = static_cast<int16_t>(LoadLittleEndian(input.data(), 2));
+    input.remove_prefix(2);
+  }
+
+  // Value. Numbers are rendered the way std::to_chars does (shortest text
+  // that reads back to the same value); binary chunks as hex, as in ASCII
+  // DXF.
+  absl::string_view value;
+  char text[32];
+  auto save_number = [&](auto number) {
+    auto [end, ec] = std::to_chars(text, text + sizeof(text), number);
+    return SaveDecoded(absl::string_view(text, end - text));
+  };
+
+  switch (BinaryValueType(group_code)) {
+    case DXFBinaryValue::kString: {
+      const void* nul = memchr(input.data(), '\0', input.size());
+      if (nul == nullptr) return truncated();
+      size_t length = static_cast<const char*>(nul) - input.data();
+      value = input.substr(0, length);
+      input.remove_prefix(length + 1);
+      break;
+    }
+    case DXFBinaryValue::kDouble: {
+      if (input.size() < 8) return truncated();
+      double number = std::bit_cast<double>(LoadLittleEndian(input.data(), 8));
+      // Whole numbers (common in drawings) take the much cheaper integer
+      // formatting; -0.0 keeps its sign through the double path
+      bool whole = std::abs(number) < (1 << 30) &&
+                   number == static_cast<int32_t>(number) &&
+                   !(number == 0 && std::signbit(number));
+      value = whole ? save_number(static_cast<int32_t>(number))
+                    : save_number(number);
+      input.remove_prefix(8);
+      break;
+    }
+    case DXFBinaryValue::kInt16:
+      if (input.size() < 2) return truncated();
+      value = save_number(
+          static_cast<int16_t>(LoadLittleEndian(input.data(), 2)));
+      input.remove_prefix(2);
+      break;
+    case DXFBinaryValue::kInt32:
+      if (input.size() < 4) return truncated();
+      value = save_number(
+          static_cast<int32_t>(LoadLittleEndian(input.data(), 4)));
+      input.remove_prefix(4);
+      break;
+    case DXFBinaryValue::kInt64:
+      if (input.size() < 8) return truncated();
+      value = save_number(
+          static_cast<int64_t>(LoadLittleEndian(input.data(), 8)));
+      input.remove_prefix(8);
+      break;
+    case DXFBinaryValue::kBool:
+      if (input.empty()) return truncated();
+      value = save_number(static_cast<int>(static_cast<uint8_t>(input[0])));
+      input.remove_prefix(1);
+      break;
+    case DXFBinaryValue::kBytes: {
+      if (input.empty()) return truncated();
+      size_t length = static_cast<uint8_t>(input[0]);
+      if (input.size() < 1 + length) return truncated();
+      static constexpr char kHex[] = "0123456789ABCDEF";
+      std::string hex;
+      hex.reserve(2 * length);
+      for (size_t i = 1; i <= length; i++) {
+        uint8_t byte = static_cast<uint8_t>(input[i]);
+        hex.push_back(kHex[byte >> 4]);
+        hex.push_back(kHex[byte & 15]);
+      }
+      value = SaveDecoded(hex);
+      input.remove_prefix(1 + length);
+      break;
+    }
+  }
+
+  remaining_ = input;
+  line_number_ += 2;
+  *pair = DXFPair{group_code, value};
+  *status = absl::OkStatus();
+  return true;
+}
+
+absl::string_view DXFTokenizer::SaveDecoded(absl::string_view text) {
+  if (decoded_left_ < text.size()) {
+    if (decoded_ == nullptr) decoded_ = DXFBuffer::ForStreaming();
+    decoded_left_ = std::max(kDecodedBlockSize, text.size());
+    decoded_next_ = decoded_->AllocateBlock(decoded_left_);
+  }
+
+  char* saved = decoded_next_;
+  memcpy(saved, text.data(), text.size());
+  decoded_next_ += text.size();
+  decoded_left_ -= text.size();
+  return absl::string_view(saved, text.size());
+}
+
+bool DXFTokenizer::ScanBatch() {
+  batch_pos_ = 0;
+  batch_base_ = remaining_.data();
+  size_t consumed = ScanPairs(remaining_, kBatchSize, &batch_);
+  remaining_.remove_prefix(consumed);
+  return !batch_.empty();
+}
+
+bool DXFTokenizer::ReadPair(DXFPair* pair, absl::Status* status) {
+  // A line without a '\n' is only final once the stream is exhausted
+  const bool more_input = stream_ != nullptr;
+
+  absl::string_view input = remaining_;
+  absl::string_view group_code_str;
+  absl::string_view value;
+  bool complete = false;
+
+  // Read group code
+  if (!ReadLine(input, &group_code_str, &complete)) {
+    if (more_input) return false;
+    *status = absl::OutOfRangeError("End of file");
+    return true;
+  }
+  if (!complete && more_input) return false;
+
+  // Read value
+  if (!ReadLine(input, &value, &complete)) {
+    if (more_input) return false;
+    *status = absl::DataLossError(
+        absl::StrFormat("Failed to read value at line %d", line_number_ + 1));
+    return true;
+  }
+  if (!complete && more_input) return false;
+
+  remaining_ = input;
+  line_number_ += 2;
+
+  // Parse group code
+  int group_code;
+  absl::string_view trimmed = absl::StripAsciiWhitespace(group_code_str);
+  if (!absl::SimpleAtoi(trimmed, &group_code)) {
+    *status = absl::InvalidArgumentError(
+        absl::StrFormat("Invalid group code '%s' at line %d", trimmed,
+                        line_number_ - 1));
+    return true;
+  }
+
+  *pair = DXFPair{group_code, absl::StripAsciiWhitespace(value)};
+  *status = absl::OkStatus();
+  return true;
+}
+
+bool DXFTokenizer::Refill() {
+  // Unconsumed bytes (a partial pair) move to the front of the new block so
+  // that every value stays contiguous.
+  size_t carry = remaining_.size();
+  size_t size = std::max(kStreamBlockSize, carry * 2);
+  char* block = storage_->AllocateBlock(size);
+  if (carry > 0) memcpy(block, remaining_.data(), carry);
+
+  stream_->read(block + carry, size - carry);
+  size_t bytes_read = stream_->gcount();
+  bool failed = stream_->bad();
+  if (bytes_read < size - carry) {
+    stream_ = nullptr;  // End of input
+  }
+
+  remaining_ = absl::string_view(block, carry + bytes_read);
+  return !failed;
+}
+
+}  // namespace finetoo::parser
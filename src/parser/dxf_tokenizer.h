@@ -0,0 +1,148 @@
+// Copyright 2025 Finetoo
+// DXF Tokenizer - Pull-based group code / value pair reader
+//
+// Reads pairs front to back with one pair of lookahead, so the parser can
+// see the next "0/<TYPE>" record without consuming it. Never seeks: works on
+// pipes, stdin and other non-seekable streams. Pairs are decoded in batches
+// by the vectorized scanner (dxf_scanner.h). Binary DXF (dxf_binary.h) is
+// recognized by its sentinel and yields the same pairs, with numbers
+// rendered as text.
+
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "src/parser/dxf_buffer.h"
+#include "src/parser/dxf_scanner.h"
+
+namespace finetoo::parser {
+
+// DXF group code / value pair
+struct DXFPair {
+  int group_code;
+  absl::string_view value;  // Points into DXFFile::buffer
+};
+
+class DXFTokenizer {
+ public:
+  // Tokenize bytes already in memory (e.g. a mapped DXFBuffer)
+  explicit DXFTokenizer(absl::string_view input);
+
+  // Tokenize a stream incrementally. Each block read from `input` is kept
+  // in `storage`, so pairs stay valid after the tokenizer moves on.
+  DXFTokenizer(std::istream& input, DXFBuffer* storage);
+
+  // Non-copyable, movable
+  DXFTokenizer(const DXFTokenizer&) = delete;
+  DXFTokenizer& operator=(const DXFTokenizer&) = delete;
+  DXFTokenizer(DXFTokenizer&&) = default;
+  DXFTokenizer& operator=(DXFTokenizer&&) = default;
+
+  // Return the next pair without consuming it.
+  // OutOfRange at end of input.
+  absl::StatusOr<DXFPair> Peek();
+
+  // Consume and return the next pair.
+  // OutOfRange at end of input.
+  absl::StatusOr<DXFPair> Next();
+
+  // Consume the next pair without looking at it (typically one just
+  // returned by Peek())
+  void Skip();
+
+  // Consume pairs up to, but not including, the next group code 0 pair
+  // (skips the rest of a record without decoding it). Errors are left for
+  // the next Peek().
+  void SkipRecord();
+
+  // Streaming only: free stream blocks holding nothing but consumed input.
+  // Invalidates every pair returned so far except a pending Peek().
+  void ReleaseConsumed();
+
+  // Line number of the last line read (for error reporting). Binary input
+  // counts two lines per pair, as its ASCII equivalent would.
+  int line_number() const { return line_number_; }
+
+  // True if the input turned out to be binary DXF (known after the first
+  // Peek() or Next())
+  bool is_binary() const {
+    return format_ == Format::kBinary || format_ == Format::kBinaryR12;
+  }
+
+  // In-memory text input only (known after the first Peek() or Next()):
+  // the whole input, which every returned value points into. Empty for
+  // streams and binary input.
+  absl::string_view text() const {
+    return format_ == Format::kText && stream_ == nullptr ? input_
+                                                          : absl::string_view();
+  }
+
+  // Binary input only: storage holding the text of decoded numbers and
+  // binary chunks, which returned pairs point into. Null for ASCII input.
+  std::shared_ptr<const DXFBuffer> decoded_values() const { return decoded_; }
+
+ private:
+  enum class Format {
+    kUnknown,    // Nothing read yet
+    kText,
+    kBinary,     // 2-byte group codes (R13 and later)
+    kBinaryR12,  // 1-byte group codes, 255 escapes a 2-byte code
+  };
+
+  // Recognize binary input by its sentinel (and skip it). False if the
+  // stream could not be read.
+  bool DetectFormat();
+
+  // Binary counterpart of ReadPair()
+  bool ReadBinaryPair(DXFPair* pair, absl::Status* status);
+
+  // Copy decoded value text into decoded_
+  absl::string_view SaveDecoded(absl::string_view text);
+
+  // Read the next pair into lookahead_ if it is empty
+  absl::Status Fill();
+
+  // Scan the next batch of pairs off the front of remaining_. Returns false
+  // if the scanner could not decode a single pair there.
+  bool ScanBatch();
+
+  // Parse one pair off the front of remaining_ (slow path). Returns false if
+  // the pair is cut off by the end of the current block and more input may
+  // follow.
+  bool ReadPair(DXFPair* pair, absl::Status* status);
+
+  // Read the next block from stream_, carrying over unconsumed bytes
+  bool Refill();
+
+  absl::string_view input_;  // In-memory input, as given
+  absl::string_view remaining_;
+
+  // Pairs decoded by the scanner but not yet returned
+  std::vector<DXFToken> batch_;
+  size_t batch_pos_ = 0;
+  const char* batch_base_ = nullptr;
+
+  // Streaming input (null when tokenizing memory)
+  std::istream* stream_ = nullptr;
+  DXFBuffer* storage_ = nullptr;
+
+  bool has_lookahead_ = false;
+  DXFPair lookahead_{};
+  absl::Status lookahead_status_;
+
+  int line_number_ = 0;
+
+  Format format_ = Format::kUnknown;
+
+  // Text of values decoded from binary input
+  std::shared_ptr<DXFBuffer> decoded_;
+  char* decoded_next_ = nullptr;
+  size_t decoded_left_ = 0;
+};
+
+}  // namespace finetoo::parser
@@ -63,6 +63,8 @@ AVAILABLE OPERATIONS (discovered from schema metadata):
      "parameters": {"edge_type": "REFERENCES", "start_node_ids": "comma-separated-ids"}
    }
    Example: Follow REFERENCES edges from INSERT entities to find which Block each references
+   Add "direction": "IN" to follow edges backwards, e.g. BELONGS_TO from
+   "layer_<name>" to list the entities on a layer
 
 3. AGGREGATE - Count/sum/group nodes
    {
@@ -176,8 +178,7 @@ QueryService::ParseOperationPlan(const std::string& llm_response) {
 }
 
 std::string QueryService::FormatBOM(
-    const finetoo::operations::v1::OperationResult& result,
-    const finetoo::graph::v1::PropertyGraph& graph) {
+    const finetoo::operations::v1::OperationResult& result) {
   std::string output = "\nBill of Materials:\n";
   output += "════════════════════════════════════════════════════════════\n";
 
@@ -208,13 +209,28 @@ std::string QueryService::FormatBOM(
 absl::StatusOr<finetoo::operations::v1::QueryResponse>
 QueryService::ProcessQuery(const std::string& query,
                             const finetoo::graph::v1::PropertyGraph& graph) {
+  operations::OperationExecutor executor(
+      const_cast<finetoo::graph::v1::PropertyGraph*>(&graph));
+  return Answer(query, graph.schema(), &executor);
+}
+
+absl::StatusOr<finetoo::operations::v1::QueryResponse>
+QueryService::ProcessQuery(const std::string& query,
+                            const graph::GraphSet& graphs) {
+  operations::OperationExecutor executor(&graphs);
+  return Answer(query, graphs.Schema(), &executor);
+}
+
+absl::StatusOr<finetoo::operations::v1::QueryResponse> QueryService::Answer(
+    const std::string& query, const finetoo::graph::v1::Schema& schema,
+    operations::OperationExecutor* executor) {
   auto start_time = std::chrono::steady_clock::now();
 
   finetoo::operations::v1::QueryResponse response;
   response.set_success(false);
 
   // Step 1: Build prompt from schema
-  std::string prompt = BuildPrompt(query, graph.schema());
+  std::string prompt = BuildPrompt(query, schema);
 
   // Step 2: Send to Gemini
   auto llm_response_or = vertex_client_->GenerateContent(prompt);
@@ -236,13 +252,10 @@ QueryService::ProcessQuery(const std::string& query,
   *response.mutable_plan() = plan;
 
   // Step 4: Execute operations
-  operations::OperationExecutor executor(
-      const_cast<finetoo::graph::v1::PropertyGraph*>(&graph));
-
   finetoo::operations::v1::OperationResult final_result;
 
   for (const auto& operation : plan.operations()) {
-    auto result_or = executor.Execute(operation);
+    auto result_or = executor->Execute(operation);
     if (!result_or.ok()) {
       response.set_error_message(std::string(result_or.status().message()));
       return response;
@@ -254,7 +267,7 @@ QueryService::ProcessQuery(const std::string& query,
   *response.mutable_result() = final_result;
 
   // Step 5: Format BOM
-  std::string bom_output = FormatBOM(final_result, graph);
+  std::string bom_output = FormatBOM(final_result);
   response.set_answer(bom_output);
   response.set_success(true);
 
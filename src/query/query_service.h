@@ -10,6 +10,8 @@
 #include "proto/graph.pb.h"
 #include "proto/operations.pb.h"
 #include "src/cloud/vertex_ai_client.h"
+#include "src/graph/graph_set.h"
+#include "src/operations/operation_executor.h"
 
 namespace finetoo::query {
 
@@ -23,6 +25,10 @@ class QueryService {
   absl::StatusOr<finetoo::operations::v1::QueryResponse> ProcessQuery(
       const std::string& query, const finetoo::graph::v1::PropertyGraph& graph);
 
+  // Process natural language query across several drawings' graphs
+  absl::StatusOr<finetoo::operations::v1::QueryResponse> ProcessQuery(
+      const std::string& query, const graph::GraphSet& graphs);
+
  private:
   std::unique_ptr<cloud::VertexAIClient> vertex_client_;
 
@@ -34,9 +40,13 @@ class QueryService {
   absl::StatusOr<finetoo::operations::v1::OperationPlan> ParseOperationPlan(
       const std::string& llm_response);
 
+  // Prompt from `schema`, plan from the LLM, executed by `executor`
+  absl::StatusOr<finetoo::operations::v1::QueryResponse> Answer(
+      const std::string& query, const finetoo::graph::v1::Schema& schema,
+      operations::OperationExecutor* executor);
+
   // Format operation results as BOM
-  std::string FormatBOM(const finetoo::operations::v1::OperationResult& result,
-                        const finetoo::graph::v1::PropertyGraph& graph);
+  std::string FormatBOM(const finetoo::operations::v1::OperationResult& result);
 };
 
 }  // namespace finetoo::query
@@ -23,9 +23,11 @@ absl::StatusOr<Schema> SchemaAnalyzer::CreateDXFSchema(
   entity_type->set_name("Entity");
 
   // handle property: UNIQUE (enables match operations across document versions)
+  // Read from the node's uint64 `handle` field rather than a prop; operations
+  // take it in hex, as NodeId() prints it
   auto* handle_prop = entity_type->add_properties();
   handle_prop->set_name("handle");
-  handle_prop->set_type(PropertyMetadata::STRING);
+  handle_prop->set_type(PropertyMetadata::INT64);
   handle_prop->set_unique(true);      // KEY: Enables match operations!
   handle_prop->set_indexed(true);     // Also enables fast lookups
 
@@ -85,11 +87,13 @@ absl::StatusOr<Schema> SchemaAnalyzer::CreateDXFSchema(
   belongs_to_edge->set_source_type("Entity");
   belongs_to_edge->set_target_type("Layer");
 
-  // EdgeType: Block CONTAINS Entity (enables traversal)
+  // EdgeType: Block CONTAINS Block (enables nested block expansion). Block
+  // entities are not nodes: each INSERT in a block links it to the block
+  // the INSERT places.
   auto* contains_edge = schema.add_edge_types();
   contains_edge->set_name("CONTAINS");
   contains_edge->set_source_type("Block");
-  contains_edge->set_target_type("Entity");
+  contains_edge->set_target_type("Block");
 
   // EdgeType: Entity REFERENCES Block (enables traversal for INSERTs)
   auto* references_edge = schema.add_edge_types();
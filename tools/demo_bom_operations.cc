@@ -6,8 +6,10 @@
 
 #include <iostream>
 #include <string>
+#include <utility>
 
 #include "src/graph/graph_builder.h"
+#include "src/graph/graph_cache.h"
 #include "src/operations/operation_executor.h"
 #include "src/parser/dxf_text_parser.h"
 
@@ -23,22 +25,28 @@ int main(int argc, char** argv) {
 
   // Step 1: Parse DXF files and build property graphs
   std::cout << "Step 1: Parsing DXF files...\n";
-  std::vector<finetoo::graph::v1::PropertyGraph> graphs;
-
+  // Graphs are kept as columns: drawings seen by an earlier run are
+  // opened in place from mapped snapshots in the graph cache
+  std::vector<finetoo::graph::ColumnarGraph> graphs;
+  finetoo::graph::GraphCache cache(
+      finetoo::graph::GraphCache::DefaultDirectory());
+
+  // One builder for the batch: the graphs it builds share its SymbolTable,
+  // so strings common to the drawings are stored once
+  finetoo::graph::GraphBuilder builder;
   for (int i = 1; i < argc; i++) {
     std::string file_path = argv[i];
     std::cout << "  Parsing: " << file_path << "\n";
 
-    finetoo::graph::GraphBuilder builder;
-    auto graph_or = builder.BuildFromFile(file_path);
+    auto graph_or = cache.LoadColumnar(file_path, &builder);
 
     if (!graph_or.ok()) {
       std::cerr << "    Error: " << graph_or.status() << "\n";
       continue;
     }
 
-    graphs.push_back(*graph_or);
-    const auto& graph = graphs.back();
+    graphs.push_back(std::move(*graph_or));
+    const auto& graph = graphs.back().graph();
 
     std::cout << "    ✓ " << graph.stats().node_count() << " nodes, "
               << graph.stats().edge_count() << " edges\n";
@@ -55,7 +63,7 @@ int main(int argc, char** argv) {
   std::cout << "Step 2: Finding all INSERT entities (FILTER operation)...\n";
 
   for (size_t i = 0; i < graphs.size(); i++) {
-    auto& graph = graphs[i];
+    const auto& graph = graphs[i];
     finetoo::operations::OperationExecutor executor(&graph);
 
     // Create FILTER operation: FILTER(Entity, type == "INSERT")
@@ -84,7 +92,7 @@ int main(int argc, char** argv) {
   std::cout << "  Following REFERENCES edges from INSERT → Block\n";
 
   for (size_t i = 0; i < graphs.size(); i++) {
-    auto& graph = graphs[i];
+    const auto& graph = graphs[i];
     finetoo::operations::OperationExecutor executor(&graph);
 
     // Create TRAVERSE operation: TRAVERSE(REFERENCES edge type)
@@ -121,7 +129,7 @@ int main(int argc, char** argv) {
   std::cout << "  Aggregating with GROUP_BY block name\n\n";
 
   for (size_t i = 0; i < graphs.size(); i++) {
-    auto& graph = graphs[i];
+    const auto& graph = graphs[i];
     finetoo::operations::OperationExecutor executor(&graph);
 
     // Create AGGREGATE operation: AGGREGATE(COUNT, GROUP_BY name)
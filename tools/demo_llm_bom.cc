@@ -9,6 +9,7 @@
 
 #include "src/cloud/vertex_ai_client.h"
 #include "src/graph/graph_builder.h"
+#include "src/graph/graph_cache.h"
 #include "src/query/query_service.h"
 
 int main(int argc, char** argv) {
@@ -55,14 +56,16 @@ int main(int argc, char** argv) {
   std::cout << "  File: " << file_path << "\n";
 
   finetoo::graph::GraphBuilder builder;
-  auto graph_or = builder.BuildFromFile(file_path);
+  finetoo::graph::GraphCache cache(
+      finetoo::graph::GraphCache::DefaultDirectory());
+  auto graph_or = cache.Load(file_path, &builder);
 
   if (!graph_or.ok()) {
     std::cerr << "  Error: " << graph_or.status() << "\n";
     return 1;
   }
 
-  auto& graph = *graph_or;
+  auto& graph = **graph_or;
   std::cout << "  ✓ " << graph.stats().node_count() << " nodes, "
             << graph.stats().edge_count() << " edges\n\n";
 
@@ -88,7 +88,7 @@ int main(int argc, char** argv) {
   auto edge_types = analyzer.GetTraversableEdgeTypes(schema);
   PrintProperty("Available Edge Types (enable TRAVERSE operations)", edge_types);
   std::cout << "    → Operation: traverse(entity, BELONGS_TO, layer)\n";
-  std::cout << "    → Operation: traverse(block, CONTAINS, entity)\n";
+  std::cout << "    → Operation: traverse(block, CONTAINS, block)\n";
   std::cout << "    → Operation: traverse(entity, REFERENCES, block)\n";
 
   PrintSection("Key Insight: Zero-Shot Generalization");
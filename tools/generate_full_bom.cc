@@ -1,16 +1,20 @@
 // Copyright 2025 Finetoo
 // Full BOM Generation - All Drawings with Complete Metadata
 //
-// Parse all 7 C-loop drawings, build combined property graph, generate comprehensive BOM
+// Parse all 7 C-loop drawings into a graph set, generate comprehensive BOM
 
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/cloud/vertex_ai_client.h"
 #include "src/export/bom_exporter.h"
 #include "src/graph/graph_builder.h"
+#include "src/graph/graph_cache.h"
+#include "src/graph/graph_set.h"
+#include "src/parser/dxf_text_parser.h"
 #include "src/query/query_service.h"
 
 int main(int argc, char** argv) {
@@ -66,81 +70,62 @@ int main(int argc, char** argv) {
   }
 
   std::sort(dxf_files.begin(), dxf_files.end());
+  // Probing reads only headers and section markers, so listing is instant
   std::cout << "  Found " << dxf_files.size() << " DXF files:\n";
+  finetoo::parser::DXFTextParser probe_parser;
   for (const auto& file : dxf_files) {
     std::filesystem::path p(file);
-    std::cout << "    - " << p.filename().string() << "\n";
+    std::cout << "    - " << p.filename().string();
+    auto probe_or = probe_parser.Probe(file);
+    if (probe_or.ok()) {
+      std::cout << " (" << probe_or->version << ", "
+                << probe_or->file_bytes / 1024 << " KB, "
+                << (probe_or->entity_count_exact ? "" : "~")
+                << probe_or->entity_count << " entities, "
+                << probe_or->block_count << " blocks)";
+    }
+    std::cout << "\n";
   }
   std::cout << "\n";
 
-  // Step 2: Parse all files into one combined property graph
-  std::cout << "Step 2: Parsing all DXF files into combined property graph...\n";
-
-  finetoo::graph::v1::PropertyGraph combined_graph;
-  finetoo::graph::GraphBuilder builder;
+  // Step 2: Parse all files into a set of property graphs
+  std::cout << "Step 2: Parsing all DXF files into a graph set...\n";
 
-  // Parse first file to get schema
-  auto first_graph_or = builder.BuildFromFile(dxf_files[0]);
-  if (!first_graph_or.ok()) {
-    std::cerr << "  Error parsing first file: " << first_graph_or.status() << "\n";
-    return 1;
-  }
+  // Drawings parsed by an earlier run are read from the graph cache
+  finetoo::graph::GraphCache cache(
+      finetoo::graph::GraphCache::DefaultDirectory());
 
-  combined_graph = *first_graph_or;
-  std::filesystem::path first_path(dxf_files[0]);
-  std::cout << "  ✓ " << first_path.filename().string() << " - "
-            << combined_graph.stats().node_count() << " nodes, "
-            << combined_graph.stats().edge_count() << " edges\n";
-
-  // Parse remaining files and merge
-  for (size_t i = 1; i < dxf_files.size(); i++) {
-    finetoo::graph::GraphBuilder file_builder;
-    auto graph_or = file_builder.BuildFromFile(dxf_files[i]);
+  // Each drawing's graph joins the set as loaded, without being copied;
+  // operations run across them as one graph
+  finetoo::graph::GraphSet graphs;
+  for (const auto& file : dxf_files) {
+    finetoo::graph::GraphBuilder builder;
+    auto graph_or = cache.Load(file, &builder);
 
     if (!graph_or.ok()) {
-      std::cerr << "  Error parsing " << dxf_files[i] << ": "
+      std::cerr << "  Error parsing " << file << ": "
                 << graph_or.status() << "\n";
       continue;
     }
 
-    auto& graph = *graph_or;
-    std::filesystem::path p(dxf_files[i]);
+    std::filesystem::path p(file);
     std::cout << "  ✓ " << p.filename().string() << " - "
-              << graph.stats().node_count() << " nodes, "
-              << graph.stats().edge_count() << " edges\n";
-
-    // Merge nodes
-    for (const auto& [type, collection] : graph.nodes_by_type()) {
-      auto& target_collection = (*combined_graph.mutable_nodes_by_type())[type];
-      for (const auto& node : collection.nodes()) {
-        // Add drawing source to node
-        auto* new_node = target_collection.mutable_nodes()->Add();
-        *new_node = node;
-        (*new_node->mutable_string_props())["source_drawing"] = p.filename().string();
-      }
-      target_collection.set_count(target_collection.nodes_size());
-    }
-
-    // Merge edges
-    for (const auto& edge : graph.edges()) {
-      auto* new_edge = combined_graph.mutable_edges()->Add();
-      *new_edge = edge;
-    }
+              << (*graph_or)->stats().node_count() << " nodes, "
+              << (*graph_or)->stats().edge_count() << " edges\n";
+    graphs.Add(p.filename().string(), std::move(*graph_or));
   }
 
-  // Update combined stats
-  auto* stats = combined_graph.mutable_stats();
-  stats->set_node_count(0);
-  stats->set_edge_count(combined_graph.edges_size());
-
-  for (const auto& [type, collection] : combined_graph.nodes_by_type()) {
-    int64_t count = collection.nodes_size();
-    stats->set_node_count(stats->node_count() + count);
-    (*stats->mutable_nodes_per_type())[type] = count;
+  if (graphs.empty()) {
+    std::cerr << "  No DXF file could be parsed\n";
+    return 1;
   }
 
-  std::cout << "\n  Combined graph: " << stats->node_count() << " nodes, "
-            << stats->edge_count() << " edges\n\n";
+  const finetoo::graph::v1::GraphStats stats = graphs.Stats();
+  std::cout << "\n  Graph set: " << graphs.size() << " drawings, "
+            << stats.node_count() << " nodes, "
+            << stats.edge_count() << " edges\n";
+  std::cout << "  Graph cache: " << cache.hits() << " loaded, "
+            << cache.misses() << " parsed\n\n";
 
   // Step 3: Initialize Gemini and process query
   std::cout << "Step 3: Sending to Gemini for operation composition...\n";
@@ -155,7 +140,7 @@ int main(int argc, char** argv) {
       std::make_unique<finetoo::cloud::VertexAIClient>(vertex_config);
 
   finetoo::query::QueryService query_service(std::move(vertex_client));
-  auto response_or = query_service.ProcessQuery(query, combined_graph);
+  auto response_or = query_service.ProcessQuery(query, graphs);
 
   if (!response_or.ok()) {
     std::cerr << "  Error: " << response_or.status() << "\n";
@@ -221,8 +206,8 @@ int main(int argc, char** argv) {
   std::cout << " Summary:\n";
   std::cout << "════════════════════════════════════════════════════════════\n";
   std::cout << "  Drawings analyzed: " << dxf_files.size() << "\n";
-  std::cout << "  Total nodes: " << stats->node_count() << "\n";
-  std::cout << "  Total edges: " << stats->edge_count() << "\n";
+  std::cout << "  Total nodes: " << stats.node_count() << "\n";
+  std::cout << "  Total edges: " << stats.edge_count() << "\n";
   std::cout << "  Operations executed: " << response.plan().operations_size() << "\n";
   std::cout << "  Processing time: " << response.total_time_ms() << " ms\n";
   std::cout << "  Unique parts found: " << response.result().values_size() << "\n\n";
@@ -241,10 +226,10 @@ int main(int argc, char** argv) {
   finetoo::export_util::BOMExporter exporter;
 
   // Parse BOM entries from result
-  auto bom_entries = exporter.ParseBOMFromResult(response.result(), combined_graph);
+  auto bom_entries = exporter.ParseBOMFromResult(response.result(), graphs);
 
   // Extract all dimensions
-  auto dimensions = exporter.ExtractDimensions(combined_graph);
+  auto dimensions = exporter.ExtractDimensions(graphs);
 
   // Export to JSON
   std::string json_file = "finetoo_bom_full.json";
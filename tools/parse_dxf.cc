@@ -1,20 +1,55 @@
 // Copyright 2025 Finetoo
 // Simple DXF Parser Test Tool
 //
-// Usage: bazel run //tools:parse_dxf -- <path_to_dxf_file>
+// Usage: bazel run //tools:parse_dxf -- [--probe] <path_to_dxf_file>
+//
+// --probe prints header metadata and record counts without a full parse.
 
 #include <iostream>
+#include <map>
 #include <string>
 
 #include "src/parser/dxf_text_parser.h"
 
+namespace {
+
+int Probe(const std::string& file_path) {
+  finetoo::parser::DXFTextParser parser;
+  auto result = parser.Probe(file_path);
+  if (!result.ok()) {
+    std::cerr << "Error probing DXF: " << result.status() << "\n";
+    return 1;
+  }
+
+  const auto& probe = *result;
+  std::cout << "DXF Version: " << (probe.version.empty() ? "Unknown" : probe.version) << "\n";
+  std::cout << "File size: " << probe.file_bytes << " bytes\n";
+  if (probe.has_extents) {
+    std::cout << "Extents: (" << probe.extents_min[0] << ", " << probe.extents_min[1]
+              << ") - (" << probe.extents_max[0] << ", " << probe.extents_max[1] << ")\n";
+  }
+  std::cout << "Sections:";
+  for (const auto& section : probe.sections) std::cout << " " << section;
+  std::cout << "\n";
+  std::cout << "Layers: " << probe.layer_count << "\n";
+  std::cout << "Blocks: " << probe.block_count << "\n";
+  std::cout << "Entities: " << (probe.entity_count_exact ? "" : "~")
+            << probe.entity_count << "\n";
+  return 0;
+}
+
+}  // namespace
+
 int main(int argc, char** argv) {
-  if (argc != 2) {
-    std::cerr << "Usage: " << argv[0] << " <dxf_file>\n";
+  bool probe = argc == 3 && std::string(argv[1]) == "--probe";
+  if (argc != 2 && !probe) {
+    std::cerr << "Usage: " << argv[0] << " [--probe] <dxf_file>\n";
     return 1;
   }
 
-  std::string file_path = argv[1];
+  std::string file_path = argv[argc - 1];
+  if (probe) return Probe(file_path);
+
   std::cout << "Parsing: " << file_path << "\n\n";
 
   finetoo::parser::DXFTextParser parser;
@@ -37,7 +72,7 @@ int main(int argc, char** argv) {
   std::cout << "  Total entities: " << file.entities.size() << "\n";
 
   // Count entity types
-  std::map<std::string, int> entity_counts;
+  std::map<absl::string_view, int> entity_counts;
   for (const auto& entity : file.entities) {
     entity_counts[entity.type]++;
   }
@@ -56,7 +91,7 @@ int main(int argc, char** argv) {
     for (const auto& block : file.blocks) {
       if (shown++ >= 10) break;
       std::cout << "    - " << block.name
-                << " (handle: " << block.handle
+                << " (handle: " << finetoo::parser::FormatHandle(block.handle)
                 << ", entities: " << block.entities.size() << ")\n";
     }
   }